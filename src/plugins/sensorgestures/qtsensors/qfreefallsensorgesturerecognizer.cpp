@@ -15,6 +15,7 @@ QFreefallSensorGestureRecognizer::QFreefallSensorGestureRecognizer(QObject *pare
 
 QFreefallSensorGestureRecognizer::~QFreefallSensorGestureRecognizer()
 {
+    QtSensorGestureSensorHandler::instance()->removeAccelListener(this);
 }
 
 void QFreefallSensorGestureRecognizer::create()
@@ -30,8 +31,7 @@ bool QFreefallSensorGestureRecognizer::start()
 {
     if (QtSensorGestureSensorHandler::instance()->startSensor(QtSensorGestureSensorHandler::Accel)) {
         active = true;
-        connect(QtSensorGestureSensorHandler::instance(),SIGNAL(accelReadingChanged(QAccelerometerReading*)),
-                this,SLOT(accelChanged(QAccelerometerReading*)));
+        QtSensorGestureSensorHandler::instance()->addAccelListener(this);
     } else {
         active = false;
     }
@@ -42,8 +42,7 @@ bool QFreefallSensorGestureRecognizer::start()
 bool QFreefallSensorGestureRecognizer::stop()
 {
     QtSensorGestureSensorHandler::instance()->stopSensor(QtSensorGestureSensorHandler::Accel);
-    disconnect(QtSensorGestureSensorHandler::instance(),SIGNAL(accelReadingChanged(QAccelerometerReading*)),
-            this,SLOT(accelChanged(QAccelerometerReading*)));
+    QtSensorGestureSensorHandler::instance()->removeAccelListener(this);
     active = false;
 
     return active;
@@ -58,12 +57,9 @@ bool QFreefallSensorGestureRecognizer::isActive()
 #define LANDED_THRESHOLD 20.0
 #define FREEFALL_MAX 4
 
-void QFreefallSensorGestureRecognizer::accelChanged(QAccelerometerReading *reading)
+void QFreefallSensorGestureRecognizer::accelSample(const QtSensorGestureAccelSample &sample)
 {
-    const qreal x = reading->x();
-    const qreal y = reading->y();
-    const qreal z = reading->z();
-    qreal sum = qSqrt(x * x + y * y + z * z);
+    const qreal sum = sample.magnitude;
 
     if (qAbs(sum) < FREEFALL_THRESHOLD) {
         detecting = true;
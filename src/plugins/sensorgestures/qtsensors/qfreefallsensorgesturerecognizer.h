@@ -12,7 +12,7 @@
 
 QT_BEGIN_NAMESPACE
 
-class QFreefallSensorGestureRecognizer : public QSensorGestureRecognizer
+class QFreefallSensorGestureRecognizer : public QSensorGestureRecognizer, public QtSensorGestureAccelListener
 {
     Q_OBJECT
 public:
@@ -31,13 +31,13 @@ Q_SIGNALS:
     void landed();
 
 private slots:
-    void accelChanged(QAccelerometerReading *reading);
 
 private:
+    void accelSample(const QtSensorGestureAccelSample &sample) override;
 
     bool active;
     bool detecting;
-    QList <qreal> freefallList;
+    QSensorGestureWindow<qreal, 8> freefallList;
 
 };
 QT_END_NAMESPACE
@@ -11,11 +11,7 @@ QT_BEGIN_NAMESPACE
 
 QPickupSensorGestureRecognizer::QPickupSensorGestureRecognizer(QObject *parent)
     : QSensorGestureRecognizer(parent)
-    , accelReading(0)
     , active(0)
-    , pXaxis(0)
-    , pYaxis(0)
-    , pZaxis(0)
     , lastpitch(0)
     , detecting(0)
 {
@@ -23,6 +19,7 @@ QPickupSensorGestureRecognizer::QPickupSensorGestureRecognizer(QObject *parent)
 
 QPickupSensorGestureRecognizer::~QPickupSensorGestureRecognizer()
 {
+    QtSensorGestureSensorHandler::instance()->removeAccelListener(this);
 }
 
 void QPickupSensorGestureRecognizer::create()
@@ -38,8 +35,7 @@ bool QPickupSensorGestureRecognizer::start()
 {
     if (QtSensorGestureSensorHandler::instance()->startSensor(QtSensorGestureSensorHandler::Accel)) {
             active = true;
-            connect(QtSensorGestureSensorHandler::instance(),SIGNAL(accelReadingChanged(QAccelerometerReading*)),
-                    this,SLOT(accelChanged(QAccelerometerReading*)));
+            QtSensorGestureSensorHandler::instance()->addAccelListener(this);
         } else {
             QtSensorGestureSensorHandler::instance()->stopSensor(QtSensorGestureSensorHandler::Accel);
             active = false;
@@ -53,8 +49,7 @@ bool QPickupSensorGestureRecognizer::start()
 bool QPickupSensorGestureRecognizer::stop()
 {
     QtSensorGestureSensorHandler::instance()->stopSensor(QtSensorGestureSensorHandler::Accel);
-    disconnect(QtSensorGestureSensorHandler::instance(),SIGNAL(accelReadingChanged(QAccelerometerReading*)),
-            this,SLOT(accelChanged(QAccelerometerReading*)));
+    QtSensorGestureSensorHandler::instance()->removeAccelListener(this);
     active = false;
 
     return active;
@@ -70,33 +65,18 @@ bool QPickupSensorGestureRecognizer::isActive()
 #define PICKUP_ANGLE_THRESHOLD 25
 #define PICKUP_ROLL_THRESHOLD 13
 
-void QPickupSensorGestureRecognizer::accelChanged(QAccelerometerReading *reading)
+void QPickupSensorGestureRecognizer::accelSample(const QtSensorGestureAccelSample &sample)
 {
-    accelReading = reading;
-    const qreal x = reading->x();
-    const qreal y = reading->y();
-    const qreal z = reading->z();
-    const qreal xdiff =  pXaxis - x;
-    const qreal ydiff = pYaxis - y;
-    const qreal zdiff =  pZaxis - z;
-
-    qreal pitch = qRadiansToDegrees(qAtan(y / qSqrt(x * x + z * z)));
-    qreal roll  = qRadiansToDegrees(qAtan(x / qSqrt(y * y + z * z)));
-
-    if ((qAbs(xdiff) < 0.7 && qAbs(ydiff) < .7 && qAbs(zdiff) < .7)
-            || z < 0) {
+    const qreal pitch = sample.pitch;
+    const qreal roll = sample.roll;
+
+    if ((qAbs(sample.dx) < 0.7 && qAbs(sample.dy) < .7 && qAbs(sample.dz) < .7)
+            || sample.z < 0) {
         detecting = false;
     } else if (pitch > PICKUP_BOTTOM_THRESHOLD && pitch < PICKUP_TOP_THRESHOLD) {
         detecting = true;
      }
 
-    if ( pitchList.count() > 21) {
-        pitchList.removeFirst();
-    }
-    if ( rollList.count() > 21) {
-        rollList.removeFirst();
-    }
-
     if (pitch > 1) {
         pitchList.append(pitch);
     }
@@ -109,25 +89,16 @@ void QPickupSensorGestureRecognizer::accelChanged(QAccelerometerReading *reading
     }
 
     lastpitch = pitch;
-    pXaxis = x;
-    pYaxis = y;
-    pZaxis = z;
 }
 
 void QPickupSensorGestureRecognizer::timeout()
 {
-    qreal averageRoll = 0;
-    for (int r = 0; r < rollList.count(); r++) {
-        averageRoll += rollList.at(r);
-    }
-    averageRoll /= rollList.count();
-
-    if (averageRoll >  PICKUP_ROLL_THRESHOLD) {
+    if (!rollList.isEmpty() && rollList.mean() > PICKUP_ROLL_THRESHOLD) {
         clear();
         return;
     }
     if (pitchList.isEmpty()
-            || pitchList.at(0) > PICKUP_BOTTOM_THRESHOLD) {
+            || pitchList.first() > PICKUP_BOTTOM_THRESHOLD) {
         clear();
         return;
     }
@@ -136,9 +107,7 @@ void QPickupSensorGestureRecognizer::timeout()
     qreal startPitch = -1.0;
     int goodCount = 0;
 
-    qreal averagePitch = 0;
     for (int i = 0; i < pitchList.count(); i++) {
-        averagePitch += pitchList.at(i);
         if (previousPitch < pitchList.at(i)
                 && qAbs(pitchList.at(i)) - qAbs(previousPitch) < 20) {
             if (goodCount == 1 && previousPitch != 0) {
@@ -149,9 +118,8 @@ void QPickupSensorGestureRecognizer::timeout()
 
         previousPitch = pitchList.at(i);
     }
-    averagePitch /= pitchList.count();
 
-    if (averagePitch < 5) {
+    if (pitchList.mean() < 5) {
         clear();
         return;
     }
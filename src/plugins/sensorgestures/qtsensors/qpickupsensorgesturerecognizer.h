@@ -10,7 +10,7 @@
 
 QT_BEGIN_NAMESPACE
 
-class QPickupSensorGestureRecognizer : public QSensorGestureRecognizer
+class QPickupSensorGestureRecognizer : public QSensorGestureRecognizer, public QtSensorGestureAccelListener
 {
     Q_OBJECT
 public:
@@ -28,22 +28,18 @@ Q_SIGNALS:
     void pickup();
 
 private slots:
-    void accelChanged(QAccelerometerReading *reading);
 
     void timeout();
 private:
-    QAccelerometerReading *accelReading;
+    void accelSample(const QtSensorGestureAccelSample &sample) override;
 
     bool active;
-    qreal pXaxis;
-    qreal pYaxis;
-    qreal pZaxis;
 
     qreal lastpitch;
     bool detecting;
 
-    QList <qreal> pitchList;
-    QList <qreal> rollList;
+    QSensorGestureWindow<qreal, 22> pitchList;
+    QSensorGestureWindow<qreal, 22> rollList;
 
     void clear();
 };
@@ -24,6 +24,7 @@ QShake2SensorGestureRecognizer::QShake2SensorGestureRecognizer(QObject *parent)
 
 QShake2SensorGestureRecognizer::~QShake2SensorGestureRecognizer()
 {
+    QtSensorGestureSensorHandler::instance()->removeAccelListener(this);
 }
 
 void QShake2SensorGestureRecognizer::create()
@@ -34,8 +35,7 @@ bool QShake2SensorGestureRecognizer::start()
 {
     if (QtSensorGestureSensorHandler::instance()->startSensor(QtSensorGestureSensorHandler::Accel)) {
         active = true;
-        connect(QtSensorGestureSensorHandler::instance(),SIGNAL(accelReadingChanged(QAccelerometerReading*)),
-                this,SLOT(accelChanged(QAccelerometerReading*)));
+        QtSensorGestureSensorHandler::instance()->addAccelListener(this);
     } else {
         active = false;
     }
@@ -52,8 +52,7 @@ bool QShake2SensorGestureRecognizer::start()
 bool QShake2SensorGestureRecognizer::stop()
 {
     QtSensorGestureSensorHandler::instance()->stopSensor(QtSensorGestureSensorHandler::Accel);
-    disconnect(QtSensorGestureSensorHandler::instance(),SIGNAL(accelReadingChanged(QAccelerometerReading*)),
-            this,SLOT(accelChanged(QAccelerometerReading*)));
+    QtSensorGestureSensorHandler::instance()->removeAccelListener(this);
     active = false;
     return active;
 }
@@ -71,13 +70,13 @@ QString QShake2SensorGestureRecognizer::id() const
 #define NUMBER_SHAKES 3
 #define THRESHOLD 25
 
-void QShake2SensorGestureRecognizer::accelChanged(QAccelerometerReading *reading)
+void QShake2SensorGestureRecognizer::accelSample(const QtSensorGestureAccelSample &sample)
 {
-    const qreal x = reading->x();
-    const qreal y = reading->y();
-    const qreal z = reading->z();
+    const qreal x = sample.x;
+    const qreal y = sample.y;
+    const qreal z = sample.z;
 
-    const quint64 timestamp = reading->timestamp();
+    const quint64 timestamp = sample.timestamp;
 
     currentData.x = x;
     currentData.y = y;
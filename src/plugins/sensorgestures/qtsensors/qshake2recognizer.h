@@ -18,7 +18,7 @@ struct ShakeData {
    qreal z;
 };
 
-class QShake2SensorGestureRecognizer : public QSensorGestureRecognizer
+class QShake2SensorGestureRecognizer : public QSensorGestureRecognizer, public QtSensorGestureAccelListener
 {
     Q_OBJECT
 
@@ -52,11 +52,12 @@ Q_SIGNALS:
     void shakeDown();
 
 private slots:
-    void accelChanged(QAccelerometerReading *reading);
     void timeout();
 
 
 private:
+    void accelSample(const QtSensorGestureAccelSample &sample) override;
+
     QAccelerometerReading *accelReading;
 
     bool active;
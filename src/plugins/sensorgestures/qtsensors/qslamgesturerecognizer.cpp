@@ -30,6 +30,7 @@ QSlamSensorGestureRecognizer::QSlamSensorGestureRecognizer(QObject *parent) :
 
 QSlamSensorGestureRecognizer::~QSlamSensorGestureRecognizer()
 {
+    QtSensorGestureSensorHandler::instance()->removeAccelListener(this);
 }
 
 void QSlamSensorGestureRecognizer::create()
@@ -51,8 +52,7 @@ bool QSlamSensorGestureRecognizer::start()
             connect(QtSensorGestureSensorHandler::instance(),SIGNAL(orientationReadingChanged(QOrientationReading*)),
                     this,SLOT(orientationReadingChanged(QOrientationReading*)));
 
-            connect(QtSensorGestureSensorHandler::instance(),SIGNAL(accelReadingChanged(QAccelerometerReading*)),
-                    this,SLOT(accelChanged(QAccelerometerReading*)));
+            QtSensorGestureSensorHandler::instance()->addAccelListener(this);
         } else {
             QtSensorGestureSensorHandler::instance()->stopSensor(QtSensorGestureSensorHandler::Accel);
             active = false;
@@ -70,8 +70,7 @@ bool QSlamSensorGestureRecognizer::stop()
     disconnect(QtSensorGestureSensorHandler::instance(),SIGNAL(orientationReadingChanged(QOrientationReading*)),
             this,SLOT(orientationReadingChanged(QOrientationReading*)));
 
-    disconnect(QtSensorGestureSensorHandler::instance(),SIGNAL(accelReadingChanged(QAccelerometerReading*)),
-            this,SLOT(accelChanged(QAccelerometerReading*)));
+    QtSensorGestureSensorHandler::instance()->removeAccelListener(this);
     detecting = false;
     restingList.clear();
     active = false;
@@ -93,12 +92,12 @@ void QSlamSensorGestureRecognizer::orientationReadingChanged(QOrientationReading
 #define SLAM_RESTING_COUNT 5
 #define SLAM_ZERO_FACTOR .02
 
-void QSlamSensorGestureRecognizer::accelChanged(QAccelerometerReading *reading)
+void QSlamSensorGestureRecognizer::accelSample(const QtSensorGestureAccelSample &sample)
 {
-    const qreal x = reading->x();
-    const qreal y = reading->y();
-    const qreal z = reading->z();
-    quint64 timestamp = reading->timestamp();
+    const qreal x = sample.x;
+    const qreal y = sample.y;
+    const qreal z = sample.z;
+    quint64 timestamp = sample.timestamp;
 
     if (qAbs(lastX - x) < SLAM_RESTING_FACTOR
             && qAbs(lastY - y) < SLAM_RESTING_FACTOR
@@ -108,9 +107,7 @@ void QSlamSensorGestureRecognizer::accelChanged(QAccelerometerReading *reading)
         resting = false;
     }
 
-    if (restingList.count() > SLAM_RESTING_COUNT)
-        restingList.removeLast();
-    restingList.insert(0, resting);
+    restingList.append(resting);
 
 
     if (timerActive && lastTimestamp > 0)
@@ -155,7 +152,8 @@ void QSlamSensorGestureRecognizer::accelChanged(QAccelerometerReading *reading)
 
 bool QSlamSensorGestureRecognizer::hasBeenResting()
 {
-    for (int i = 0; i < restingList.count() - 1; i++) {
+    // all but the oldest
+    for (int i = 1; i < restingList.count(); i++) {
         if (!restingList.at(i)) {
             return false;
         }
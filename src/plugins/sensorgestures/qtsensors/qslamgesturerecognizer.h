@@ -10,9 +10,12 @@
 #include <QtSensors/QAccelerometer>
 #include <QtSensors/QAccelerometerReading>
 #include <QtSensors/QOrientationReading>
+
+#include "qtsensorgesturesensorhandler.h"
+
 QT_BEGIN_NAMESPACE
 
-class QSlamSensorGestureRecognizer : public QSensorGestureRecognizer
+class QSlamSensorGestureRecognizer : public QSensorGestureRecognizer, public QtSensorGestureAccelListener
 {
     Q_OBJECT
 public:
@@ -30,11 +33,11 @@ Q_SIGNALS:
     void slam();
 
 private slots:
-    void accelChanged(QAccelerometerReading *reading);
     void orientationReadingChanged(QOrientationReading *reading);
     void doSlam();
 
 private:
+    void accelSample(const QtSensorGestureAccelSample &sample) override;
 
     QAccelerometer *accel;
     QOrientationReading *orientationReading;
@@ -51,7 +54,7 @@ private:
 
     qreal accelX;
     qreal roll;
-    QList<qreal> restingList;
+    QSensorGestureWindow<bool, 6> restingList; // SLAM_RESTING_COUNT + 1
     bool resting;
 
     bool hasBeenResting();
@@ -2,12 +2,14 @@
 // SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
 
 #include <QDebug>
+#include <QtCore/qmath.h>
 
 #include "qtsensorgesturesensorhandler.h"
 
 QtSensorGestureSensorHandler::QtSensorGestureSensorHandler(QObject *parent) :
     QObject(parent),
-    accel(0), orientation(0), proximity(0), irProx(0),tapSensor(0)
+    accel(0), orientation(0), proximity(0), irProx(0),tapSensor(0),
+    lastAccelSample(), accelBlockDelivered(false)
 {
 }
 
@@ -20,9 +22,68 @@ QtSensorGestureSensorHandler* QtSensorGestureSensorHandler::instance()
     return instance;
 }
 
+void QtSensorGestureSensorHandler::addAccelListener(QtSensorGestureAccelListener *listener)
+{
+    if (!accelListeners.contains(listener))
+        accelListeners.append(listener);
+}
+
+void QtSensorGestureSensorHandler::removeAccelListener(QtSensorGestureAccelListener *listener)
+{
+    accelListeners.removeOne(listener);
+}
+
 void QtSensorGestureSensorHandler::accelChanged()
 {
-    Q_EMIT accelReadingChanged(accel->reading());
+    // readingChanged() follows readingsAvailable() with the newest reading
+    // of the block, which has been dispatched already
+    if (accelBlockDelivered) {
+        accelBlockDelivered = false;
+        return;
+    }
+    QtSensorGestureAccelSample sample;
+    updateAccelSample(accel->reading(), &sample);
+    dispatchAccelSamples(&sample, 1);
+}
+
+void QtSensorGestureSensorHandler::accelReadingsAvailable(const QList<QSensorReading *> &readings)
+{
+    accelSamples.resize(readings.size());
+    for (int i = 0; i < readings.size(); ++i)
+        updateAccelSample(static_cast<QAccelerometerReading *>(readings.at(i)), &accelSamples[i]);
+    accelBlockDelivered = true;
+    dispatchAccelSamples(accelSamples.constData(), int(accelSamples.size()));
+}
+
+void QtSensorGestureSensorHandler::updateAccelSample(QAccelerometerReading *reading,
+                                                     QtSensorGestureAccelSample *sample)
+{
+    const qreal x = reading->x();
+    const qreal y = reading->y();
+    const qreal z = reading->z();
+
+    sample->timestamp = reading->timestamp();
+    sample->x = x;
+    sample->y = y;
+    sample->z = z;
+    sample->dx = x - lastAccelSample.x;
+    sample->dy = y - lastAccelSample.y;
+    sample->dz = z - lastAccelSample.z;
+    sample->magnitude = qSqrt(x * x + y * y + z * z);
+    sample->pitch = qRadiansToDegrees(qAtan(y / qSqrt(x * x + z * z)));
+    sample->roll = qRadiansToDegrees(qAtan(x / qSqrt(y * y + z * z)));
+    lastAccelSample = *sample;
+}
+
+void QtSensorGestureSensorHandler::dispatchAccelSamples(const QtSensorGestureAccelSample *samples,
+                                                        int count)
+{
+    // A listener may stop itself or another recognizer when a gesture is detected
+    const QList<QtSensorGestureAccelListener *> listeners = accelListeners;
+    for (QtSensorGestureAccelListener *listener : listeners) {
+        for (int i = 0; i < count && accelListeners.contains(listener); ++i)
+            listener->accelSample(samples[i]);
+    }
 }
 
 void QtSensorGestureSensorHandler::orientationChanged()
@@ -62,9 +123,14 @@ bool QtSensorGestureSensorHandler::startSensor(SensorGestureSensors sensor)
             else
                 accelRange = 39; //this should never happen
             connect(accel,SIGNAL(readingChanged()),this,SLOT(accelChanged()));
+            connect(accel,SIGNAL(readingsAvailable(QList<QSensorReading*>)),
+                    this,SLOT(accelReadingsAvailable(QList<QSensorReading*>)));
         }
-        if (ok && !accel->isActive())
+        if (ok && !accel->isActive()) {
+            lastAccelSample = QtSensorGestureAccelSample();
+            accelBlockDelivered = false;
             accel->start();
+        }
         break;
     case Orientation:
         //orientation
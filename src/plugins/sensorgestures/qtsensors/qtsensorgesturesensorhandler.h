@@ -13,6 +13,32 @@
 #include <QtSensors/QProximitySensor>
 #include <QtSensors/QIRProximitySensor>
 #include <QtSensors/QTapSensor>
+#include <QtSensors/private/qsensorgesturewindow_p.h>
+#include <QtCore/QList>
+#include <QtCore/QVarLengthArray>
+
+// One accelerometer sample with the quantities the recognizers derive from
+// it. They are computed once per sample and shared by all recognizers.
+struct QtSensorGestureAccelSample
+{
+    quint64 timestamp;
+    qreal x;
+    qreal y;
+    qreal z;
+    qreal dx; // change since the previous sample
+    qreal dy;
+    qreal dz;
+    qreal magnitude;
+    qreal pitch; // degrees, rotation about the x axis
+    qreal roll;  // degrees, rotation about the y axis
+};
+
+class QtSensorGestureAccelListener
+{
+public:
+    virtual ~QtSensorGestureAccelListener() {}
+    virtual void accelSample(const QtSensorGestureAccelSample &sample) = 0;
+};
 
 class QtSensorGestureSensorHandler : public QObject
 {
@@ -31,8 +57,14 @@ public:
     static QtSensorGestureSensorHandler *instance();
     qreal accelRange;
 
+    // Listeners are called directly, in the order they were added, with
+    // every accelerometer sample while the accelerometer is started
+    void addAccelListener(QtSensorGestureAccelListener *listener);
+    void removeAccelListener(QtSensorGestureAccelListener *listener);
+
 public slots:
     void accelChanged();
+    void accelReadingsAvailable(const QList<QSensorReading *> &readings);
     void orientationChanged();
     void proximityChanged();
     void irProximityChanged();
@@ -42,7 +74,6 @@ public slots:
     void stopSensor(SensorGestureSensors sensor);
 
 Q_SIGNALS:
-    void accelReadingChanged(QAccelerometerReading *reading);
     void orientationReadingChanged(QOrientationReading *reading);
     void proximityReadingChanged(QProximityReading *reading);
     void irProximityReadingChanged(QIRProximityReading *reading);
@@ -55,6 +86,14 @@ private:
     QIRProximitySensor *irProx;
     QTapSensor *tapSensor;
 
+    void updateAccelSample(QAccelerometerReading *reading, QtSensorGestureAccelSample *sample);
+    void dispatchAccelSamples(const QtSensorGestureAccelSample *samples, int count);
+
+    QList<QtSensorGestureAccelListener *> accelListeners;
+    QVarLengthArray<QtSensorGestureAccelSample, 32> accelSamples;
+    QtSensorGestureAccelSample lastAccelSample;
+    bool accelBlockDelivered;
+
     QMap<SensorGestureSensors, int> usedSensorsMap;
 
 };
@@ -24,6 +24,7 @@ QTwistSensorGestureRecognizer::QTwistSensorGestureRecognizer(QObject *parent)
 
 QTwistSensorGestureRecognizer::~QTwistSensorGestureRecognizer()
 {
+    QtSensorGestureSensorHandler::instance()->removeAccelListener(this);
 }
 
 void QTwistSensorGestureRecognizer::create()
@@ -43,8 +44,7 @@ bool QTwistSensorGestureRecognizer::start()
             connect(QtSensorGestureSensorHandler::instance(),SIGNAL(orientationReadingChanged(QOrientationReading*)),
                     this,SLOT(orientationReadingChanged(QOrientationReading*)));
 
-            connect(QtSensorGestureSensorHandler::instance(),SIGNAL(accelReadingChanged(QAccelerometerReading*)),
-                    this,SLOT(accelChanged(QAccelerometerReading*)));
+            QtSensorGestureSensorHandler::instance()->addAccelListener(this);
         } else {
             QtSensorGestureSensorHandler::instance()->stopSensor(QtSensorGestureSensorHandler::Accel);
             active = false;
@@ -64,8 +64,7 @@ bool QTwistSensorGestureRecognizer::stop()
     disconnect(QtSensorGestureSensorHandler::instance(),SIGNAL(orientationReadingChanged(QOrientationReading*)),
             this,SLOT(orientationReadingChanged(QOrientationReading*)));
 
-    disconnect(QtSensorGestureSensorHandler::instance(),SIGNAL(accelReadingChanged(QAccelerometerReading*)),
-            this,SLOT(accelChanged(QAccelerometerReading*)));
+    QtSensorGestureSensorHandler::instance()->removeAccelListener(this);
 
     reset();
     orientationList.clear();
@@ -81,9 +80,6 @@ bool QTwistSensorGestureRecognizer::isActive()
 void QTwistSensorGestureRecognizer::orientationReadingChanged(QOrientationReading *reading)
 {
     orientationReading = reading;
-    if (orientationList.count() == 3)
-        orientationList.removeFirst();
-
     orientationList.append(reading->orientation());
 
     if (orientationList.count() == 3
@@ -106,19 +102,19 @@ bool QTwistSensorGestureRecognizer::checkOrientation()
     return true;
 }
 
-void QTwistSensorGestureRecognizer::accelChanged(QAccelerometerReading *reading)
+void QTwistSensorGestureRecognizer::accelSample(const QtSensorGestureAccelSample &sample)
 {
     if (orientationReading == 0)
         return;
 
-    const qreal x = reading->x();
-    const qreal y = reading->y();
-    const qreal z = reading->z();
+    const qreal x = sample.x;
+    const qreal y = sample.y;
+    const qreal z = sample.z;
 
     if (!detecting && !checking&& dataList.count() > 21)
         dataList.removeFirst();
 
-    qreal angle = qRadiansToDegrees(qAtan(x / qSqrt(y * y + z * z)));
+    const qreal angle = sample.roll;
 
     if (qAbs(angle) > 2) {
         if (detecting) {
@@ -140,7 +136,7 @@ void QTwistSensorGestureRecognizer::accelChanged(QAccelerometerReading *reading)
         if (!detecting && increaseCount > 3 && qAbs(angle) > 30) {
             decreaseCount = 0;
             detecting = true;
-            detectedAngle = qRadiansToDegrees(qAtan(y / qSqrt(x * x + z * z)));
+            detectedAngle = sample.pitch;
         }
     } else {
         increaseCount = 0;
@@ -18,7 +18,7 @@ struct twistAccelData {
     qreal z;
 };
 
-class QTwistSensorGestureRecognizer : public QSensorGestureRecognizer
+class QTwistSensorGestureRecognizer : public QSensorGestureRecognizer, public QtSensorGestureAccelListener
 {
     Q_OBJECT
 public:
@@ -37,23 +37,23 @@ Q_SIGNALS:
     void twistRight();
 
 private slots:
-    void accelChanged(QAccelerometerReading *reading);
     void orientationReadingChanged(QOrientationReading *reading);
     void checkTwist();
 
 private:
+    void accelSample(const QtSensorGestureAccelSample &sample) override;
 
     QOrientationReading *orientationReading;
     bool active;
     bool detecting;
-    QList <twistAccelData> dataList;
+    QSensorGestureWindow<twistAccelData, 128> dataList;
     bool checking;
     void reset();
     bool checkOrientation();
     int increaseCount;
     int decreaseCount;
     qreal lastAngle;
-    QList <QOrientationReading::Orientation> orientationList;
+    QSensorGestureWindow<QOrientationReading::Orientation, 3> orientationList;
     qreal detectedAngle;
 };
 QT_END_NAMESPACE
@@ -29,6 +29,7 @@ QWhipSensorGestureRecognizer::QWhipSensorGestureRecognizer(QObject *parent)
 
 QWhipSensorGestureRecognizer::~QWhipSensorGestureRecognizer()
 {
+    QtSensorGestureSensorHandler::instance()->removeAccelListener(this);
 }
 
 void QWhipSensorGestureRecognizer::create()
@@ -49,8 +50,7 @@ bool QWhipSensorGestureRecognizer::start()
             connect(QtSensorGestureSensorHandler::instance(),SIGNAL(orientationReadingChanged(QOrientationReading*)),
                     this,SLOT(orientationReadingChanged(QOrientationReading*)));
 
-            connect(QtSensorGestureSensorHandler::instance(),SIGNAL(accelReadingChanged(QAccelerometerReading*)),
-                    this,SLOT(accelChanged(QAccelerometerReading*)));
+            QtSensorGestureSensorHandler::instance()->addAccelListener(this);
         } else {
             QtSensorGestureSensorHandler::instance()->stopSensor(QtSensorGestureSensorHandler::Accel);
             active = false;
@@ -71,8 +71,7 @@ bool QWhipSensorGestureRecognizer::stop()
     disconnect(QtSensorGestureSensorHandler::instance(),SIGNAL(orientationReadingChanged(QOrientationReading*)),
             this,SLOT(orientationReadingChanged(QOrientationReading*)));
 
-    disconnect(QtSensorGestureSensorHandler::instance(),SIGNAL(accelReadingChanged(QAccelerometerReading*)),
-            this,SLOT(accelChanged(QAccelerometerReading*)));
+    QtSensorGestureSensorHandler::instance()->removeAccelListener(this);
     active = false;
     return active;
 }
@@ -90,24 +89,15 @@ void QWhipSensorGestureRecognizer::orientationReadingChanged(QOrientationReading
 #define WHIP_FACTOR -11.0
 #define WHIP_WIGGLE_FACTOR 0.35
 
-void QWhipSensorGestureRecognizer::accelChanged(QAccelerometerReading *reading)
+void QWhipSensorGestureRecognizer::accelSample(const QtSensorGestureAccelSample &sample)
 {
-    const qreal x = reading->x();
-    const qreal y = reading->y();
-    qreal z = reading->z();
+    const qreal x = sample.x;
+    const qreal y = sample.y;
+    qreal z = sample.z;
 
-    quint64 timestamp = reading->timestamp();
+    quint64 timestamp = sample.timestamp;
 
-    if (zList.count() > 4)
-        zList.removeLast();
-
-    qreal averageZ = 0;
-    for (const qreal& az : qAsConst<QList<qreal>>(zList))
-        averageZ += az;
-
-    averageZ /= zList.count();
-
-    zList.insert(0,z);
+    zList.append(z);
 
     if (orientationReading == 0)
         return;
@@ -119,27 +109,21 @@ void QWhipSensorGestureRecognizer::accelChanged(QAccelerometerReading *reading)
     const qreal diffX = lastX - x;
     const qreal diffY = lastY - y;
 
-    if (detecting && whipMap.count() > 5 && whipMap.at(5) == true) {
+    if (detecting && whipMap.isFull() && whipMap.first() == true) {
         checkForWhip();
     }
 
-    if (whipMap.count() > 5)
-        whipMap.removeLast();
-
-    if (negativeList.count() > 5)
-        negativeList.removeLast();
-
     if (z < WHIP_FACTOR
             && qAbs(diffX) > -(accelRange * .1285)//-5.0115
             && qAbs(lastX) < 7
             && qAbs(x) < 7) {
-        whipMap.insert(0,true);
+        whipMap.append(true);
         if (!detecting && !timerActive) {
             timerActive = true;
             detecting = true;
         }
     } else {
-        whipMap.insert(0,false);
+        whipMap.append(false);
     }
 
     // check if shaking
@@ -147,9 +131,9 @@ void QWhipSensorGestureRecognizer::accelChanged(QAccelerometerReading *reading)
          && qAbs(diffX) > (accelRange   * 0.7)) //27.3
             || (((y < 0 && lastY > 0) || (y > 0 && lastY < 0))
             && qAbs(diffY) > (accelRange * 0.7))) {
-        negativeList.insert(0,true);
+        negativeList.append(true);
     } else {
-        negativeList.insert(0,false);
+        negativeList.append(false);
     }
 
     lastX = x;
@@ -175,8 +159,8 @@ void QWhipSensorGestureRecognizer::checkForWhip()
     whipOk = false;
 
     int check = 0;
-    for (const qreal& az : qAsConst<QList<qreal>>(zList)) {
-        if (az < -10)
+    for (int i = 0; i < zList.count(); i++) {
+        if (zList.at(i) < -10)
             check++;
     }
     if (check >= 4)
@@ -186,7 +170,8 @@ void QWhipSensorGestureRecognizer::checkForWhip()
 
     if (whipOk) {
         bool ok = true;
-        for (int i = 0; i < negativeList.count() - 1; i++) {
+        // all but the oldest
+        for (int i = 1; i < negativeList.count(); i++) {
             if (negativeList.at(i)) {
                 ok = false;
             }
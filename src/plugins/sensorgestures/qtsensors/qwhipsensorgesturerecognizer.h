@@ -11,7 +11,7 @@
 
 QT_BEGIN_NAMESPACE
 
-class QWhipSensorGestureRecognizer : public QSensorGestureRecognizer
+class QWhipSensorGestureRecognizer : public QSensorGestureRecognizer, public QtSensorGestureAccelListener
 {
     Q_OBJECT
 public:
@@ -29,11 +29,12 @@ Q_SIGNALS:
     void whip();
 
 private slots:
-    void accelChanged(QAccelerometerReading *reading);
     void orientationReadingChanged(QOrientationReading *reading);
     void timeout();
 
 private:
+    void accelSample(const QtSensorGestureAccelSample &sample) override;
+
     QOrientationReading *orientationReading;
     qreal accelRange;
     bool active;
@@ -45,13 +46,13 @@ private:
     bool detecting;
     bool whipOk;
 
-    QList<bool> whipMap;
+    QSensorGestureWindow<bool, 6> whipMap;
 
     void checkForWhip();
 
-    QList <bool> negativeList;
+    QSensorGestureWindow<bool, 6> negativeList;
 
-    QList<qreal> zList;
+    QSensorGestureWindow<qreal, 5> zList;
 
     quint64 lastTimestamp;
 
@@ -4,12 +4,11 @@
 #ifndef ANDROIDCOMPASS_H
 #define ANDROIDCOMPASS_H
 
-#include <QMutex>
 #include <qcompass.h>
 
 #include "sensoreventqueue.h"
 
-class AndroidCompass : public ThreadSafeSensorBackend
+class AndroidCompass : public QThreadSafeSensorBackend<ASensorEvent>
 {
     Q_OBJECT
 
@@ -19,18 +18,22 @@ public:
 
     void start() override;
     void stop() override;
+
+protected:
+    void processSample(const ASensorEvent &sensorEvent) override;
+    void samplesProcessed() override;
+
 private:
-    void readAllEvents();
     static int looperCallback(int /*fd*/, int /*events*/, void* data);
 
 private:
+    QSharedPointer<SensorManager> m_sensorManager;
     QCompassReading m_reading;
     const ASensor *m_accelerometer = nullptr;
     const ASensor *m_magnetometer = nullptr;
     ASensorEventQueue* m_sensorEventQueue = nullptr;
     ASensorVector m_accelerometerEvent;
     ASensorVector m_magneticEvent;
-    QMutex m_sensorsMutex;
 };
 
 #endif // ANDROIDCOMPASS_H
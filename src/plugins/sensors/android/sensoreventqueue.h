@@ -6,62 +6,15 @@
 
 #include "sensormanager.h"
 
-#include <functional>
-
-#include <QCoreApplication>
-#include <QEvent>
-#include <QSensorBackend>
-
-class FunctionEvent : public QEvent
-{
-public:
-    using Function = std::function<void()>;
-    enum {
-        FunctionEventType = User + 1
-    };
-    explicit FunctionEvent(const Function &function)
-        : QEvent(Type(FunctionEventType))
-        , m_function(function)
-    {}
-
-    void callFunction() const
-    {
-        m_function();
-    }
-private:
-    Function m_function;
-};
-
-class ThreadSafeSensorBackend : public QSensorBackend
-{
-public:
-    ThreadSafeSensorBackend(QSensor *sensor, QObject *parent = nullptr)
-        : QSensorBackend(sensor, parent)
-        , m_sensorManager(SensorManager::instance())
-    {}
-
-    // QObject interface
-    bool event(QEvent *event) override
-    {
-        if (event->type() == FunctionEvent::FunctionEventType) {
-            static_cast<FunctionEvent*>(event)->callFunction();
-            event->accept();
-            return true;
-        }
-        return QSensorBackend::event(event);
-    }
-protected:
-    QSharedPointer<SensorManager> m_sensorManager;
-};
-
-
+#include <QtSensors/private/qthreadsafesensorbackend_p.h>
 
 template <typename T>
-class SensorEventQueue : public ThreadSafeSensorBackend
+class SensorEventQueue : public QThreadSafeSensorBackend<ASensorEvent>
 {
 public:
     explicit SensorEventQueue(int androidSensorType, QSensor *sensor, QObject *parent = nullptr)
-        : ThreadSafeSensorBackend(sensor, parent)
+        : QThreadSafeSensorBackend<ASensorEvent>(sensor, parent)
+        , m_sensorManager(SensorManager::instance())
     {
         setReading<T>(&m_reader);
         m_sensorEventQueue = ASensorManager_createEventQueue(m_sensorManager->manager(), m_sensorManager->looper(), -1, &looperCallback, this);
@@ -111,17 +64,23 @@ public:
 
 protected:
     virtual void dataReceived(const ASensorEvent &event) = 0;
+    void processSample(const ASensorEvent &event) override
+    {
+        dataReceived(event);
+    }
     static int looperCallback(int /*fd*/, int /*events*/, void* data)
     {
         ASensorEvent sensorEvent;
         auto self = reinterpret_cast<SensorEventQueue*>(data);
+        // Queued without allocating; the backend's thread is woken up once
         while (ASensorEventQueue_getEvents(self->m_sensorEventQueue, &sensorEvent, 1))
-            QCoreApplication::postEvent(self, new FunctionEvent{[=]{self->dataReceived(sensorEvent);}});
+            self->pushSample(sensorEvent);
 
         return 1; // 1 means keep receiving events
     }
 
 protected:
+    QSharedPointer<SensorManager> m_sensorManager;
     T m_reader;
     const ASensor *m_sensor = nullptr;
     ASensorEventQueue* m_sensorEventQueue = nullptr;
@@ -0,0 +1,256 @@
+// Copyright (C) 2022 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "genericaccelerationkernels.h"
+#include <qmath.h>
+
+#include <cmath>
+
+// The vector code works on two doubles per register
+#if !defined(QT_COORD_TYPE) && defined(__SSE2__)
+#  include <emmintrin.h>
+#  define GENERIC_KERNELS_SSE2
+#elif !defined(QT_COORD_TYPE) && defined(__ARM_NEON) && defined(__aarch64__)
+#  include <arm_neon.h>
+#  define GENERIC_KERNELS_NEON
+#endif
+
+QT_BEGIN_NAMESPACE
+
+/*
+  atan() is computed as its Taylor series up to t^21 after reducing t to
+  [0, tan(pi/8)], which is accurate to about 1e-10 rad. The scalar and the
+  vector code do the same operations in the same order, so a reading gives
+  the same angles whichever of them computes it. Like qAtan2(), the quadrant
+  follows the sign bits, so -0 is handled like a negative number.
+*/
+static const double tanPi8 = 0.41421356237309504880;
+static const double atanCoefficients[] = {
+    1.0 / 21, -1.0 / 19, 1.0 / 17, -1.0 / 15, 1.0 / 13, -1.0 / 11,
+    1.0 / 9, -1.0 / 7, 1.0 / 5, -1.0 / 3, 1.0
+};
+
+static inline double atanSeries(double t)
+{
+    const double t2 = t * t;
+    double p = atanCoefficients[0];
+    for (size_t i = 1; i < sizeof(atanCoefficients) / sizeof(double); ++i)
+        p = p * t2 + atanCoefficients[i];
+    return t * p;
+}
+
+static inline double atan2Scalar(double y, double x)
+{
+    const double ax = qAbs(x);
+    const double ay = qAbs(y);
+    const double mx = qMax(ax, ay);
+    const double mn = qMin(ax, ay);
+    const double t = mx > 0 ? mn / mx : 0;
+    const bool reduce = t > tanPi8;
+    double r = atanSeries(reduce ? (t - 1) / (t + 1) : t);
+    if (reduce)
+        r += M_PI_4;
+    if (ay > ax)
+        r = M_PI_2 - r;
+    if (std::signbit(x))
+        r = M_PI - r;
+    return std::copysign(r, y);
+}
+
+static inline void rotationAngles(double x, double y, double z, qreal *pitch, qreal *roll)
+{
+    // Note that the formula used come from this document:
+    // http://www.freescale.com/files/sensors/doc/app_note/AN3461.pdf
+    // Roll is a left-handed rotation but we need right-handed rotation
+    const double p = qRadiansToDegrees(atan2Scalar(y, qSqrt(x * x + z * z)));
+    double r = -qRadiansToDegrees(atan2Scalar(x, qSqrt(y * y + z * z)));
+    // Fix up roll to the (-180,180] range when the face of the device
+    // points downward
+    if (z < 0 && x * x + y * y > 0)
+        r = (r > 0 ? 180.0 : -180.0) - r;
+    *pitch = p;
+    *roll = r;
+}
+
+static inline void tiltAngles(double x, double y, double z, qreal *pitch, qreal *roll)
+{
+    *pitch = atan2Scalar(-x, qSqrt(y * y + z * z));
+    *roll = atan2Scalar(y, z);
+}
+
+void genericRotationAnglesScalar(const qreal *x, const qreal *y, const qreal *z, qsizetype count,
+                                 qreal *pitch, qreal *roll)
+{
+    for (qsizetype i = 0; i < count; ++i)
+        rotationAngles(x[i], y[i], z[i], pitch + i, roll + i);
+}
+
+void genericTiltAnglesScalar(const qreal *x, const qreal *y, const qreal *z, qsizetype count,
+                             qreal *pitch, qreal *roll)
+{
+    for (qsizetype i = 0; i < count; ++i)
+        tiltAngles(x[i], y[i], z[i], pitch + i, roll + i);
+}
+
+#if defined(GENERIC_KERNELS_SSE2) || defined(GENERIC_KERNELS_NEON)
+
+#if defined(GENERIC_KERNELS_SSE2)
+typedef __m128d Vec;
+typedef __m128d Mask;
+
+static inline Vec vload(const double *p) { return _mm_loadu_pd(p); }
+static inline void vstore(double *p, Vec v) { _mm_storeu_pd(p, v); }
+static inline Vec vsplat(double d) { return _mm_set1_pd(d); }
+static inline Vec vadd(Vec a, Vec b) { return _mm_add_pd(a, b); }
+static inline Vec vsub(Vec a, Vec b) { return _mm_sub_pd(a, b); }
+static inline Vec vmul(Vec a, Vec b) { return _mm_mul_pd(a, b); }
+static inline Vec vdiv(Vec a, Vec b) { return _mm_div_pd(a, b); }
+static inline Vec vsqrt(Vec a) { return _mm_sqrt_pd(a); }
+static inline Vec vabs(Vec a) { return _mm_andnot_pd(_mm_set1_pd(-0.0), a); }
+static inline Vec vneg(Vec a) { return _mm_xor_pd(_mm_set1_pd(-0.0), a); }
+static inline Vec vmax(Vec a, Vec b) { return _mm_max_pd(a, b); }
+static inline Vec vmin(Vec a, Vec b) { return _mm_min_pd(a, b); }
+static inline Mask vgreater(Vec a, Vec b) { return _mm_cmpgt_pd(a, b); }
+static inline Mask vless(Vec a, Vec b) { return _mm_cmplt_pd(a, b); }
+static inline Mask vand(Mask a, Mask b) { return _mm_and_pd(a, b); }
+static inline Vec vselect(Mask m, Vec a, Vec b) { return _mm_or_pd(_mm_and_pd(m, a), _mm_andnot_pd(m, b)); }
+static inline Mask vsignbit(Vec a)
+{
+    // Spreads the sign bit of each double over the whole lane
+    const __m128i high = _mm_srai_epi32(_mm_castpd_si128(a), 31);
+    return _mm_castsi128_pd(_mm_shuffle_epi32(high, _MM_SHUFFLE(3, 3, 1, 1)));
+}
+static inline Vec vcopysign(Vec magnitude, Vec sign)
+{
+    const Vec signMask = _mm_set1_pd(-0.0);
+    return _mm_or_pd(_mm_andnot_pd(signMask, magnitude), _mm_and_pd(signMask, sign));
+}
+#else
+typedef float64x2_t Vec;
+typedef uint64x2_t Mask;
+
+static inline Vec vload(const double *p) { return vld1q_f64(p); }
+static inline void vstore(double *p, Vec v) { vst1q_f64(p, v); }
+static inline Vec vsplat(double d) { return vdupq_n_f64(d); }
+static inline Vec vadd(Vec a, Vec b) { return vaddq_f64(a, b); }
+static inline Vec vsub(Vec a, Vec b) { return vsubq_f64(a, b); }
+static inline Vec vmul(Vec a, Vec b) { return vmulq_f64(a, b); }
+static inline Vec vdiv(Vec a, Vec b) { return vdivq_f64(a, b); }
+static inline Vec vsqrt(Vec a) { return vsqrtq_f64(a); }
+static inline Vec vabs(Vec a) { return vabsq_f64(a); }
+static inline Vec vneg(Vec a) { return vnegq_f64(a); }
+static inline Vec vmax(Vec a, Vec b) { return vmaxq_f64(a, b); }
+static inline Vec vmin(Vec a, Vec b) { return vminq_f64(a, b); }
+static inline Mask vgreater(Vec a, Vec b) { return vcgtq_f64(a, b); }
+static inline Mask vless(Vec a, Vec b) { return vcltq_f64(a, b); }
+static inline Mask vand(Mask a, Mask b) { return vandq_u64(a, b); }
+static inline Vec vselect(Mask m, Vec a, Vec b) { return vbslq_f64(m, a, b); }
+static inline Mask vsignbit(Vec a) { return vreinterpretq_u64_s64(vshrq_n_s64(vreinterpretq_s64_f64(a), 63)); }
+static inline Vec vcopysign(Vec magnitude, Vec sign)
+{
+    return vbslq_f64(vdupq_n_u64(0x8000000000000000ULL), sign, magnitude);
+}
+#endif
+
+static const int Lanes = 2;
+
+static inline Vec atanSeries(Vec t)
+{
+    const Vec t2 = vmul(t, t);
+    Vec p = vsplat(atanCoefficients[0]);
+    for (size_t i = 1; i < sizeof(atanCoefficients) / sizeof(double); ++i)
+        p = vadd(vmul(p, t2), vsplat(atanCoefficients[i]));
+    return vmul(t, p);
+}
+
+static inline Vec atan2Vector(Vec y, Vec x)
+{
+    const Vec zero = vsplat(0);
+    const Vec one = vsplat(1);
+    const Vec ax = vabs(x);
+    const Vec ay = vabs(y);
+    const Vec mx = vmax(ax, ay);
+    const Vec mn = vmin(ax, ay);
+    // Both 0 gives 0/0, which the select turns into 0
+    const Vec t = vselect(vgreater(mx, zero), vdiv(mn, mx), zero);
+    const Mask reduce = vgreater(t, vsplat(tanPi8));
+    Vec r = atanSeries(vselect(reduce, vdiv(vsub(t, one), vadd(t, one)), t));
+    r = vadd(r, vselect(reduce, vsplat(M_PI_4), zero));
+    r = vselect(vgreater(ay, ax), vsub(vsplat(M_PI_2), r), r);
+    r = vselect(vsignbit(x), vsub(vsplat(M_PI), r), r);
+    return vcopysign(r, y);
+}
+
+void genericRotationAngles(const qreal *x, const qreal *y, const qreal *z, qsizetype count,
+                           qreal *pitch, qreal *roll)
+{
+    const Vec zero = vsplat(0);
+    const Vec toDegrees = vsplat(180 / M_PI);
+    qsizetype i = 0;
+    for (; i + Lanes <= count; i += Lanes) {
+        const Vec vx = vload(x + i);
+        const Vec vy = vload(y + i);
+        const Vec vz = vload(z + i);
+        const Vec xx = vmul(vx, vx);
+        const Vec yy = vmul(vy, vy);
+        const Vec zz = vmul(vz, vz);
+        const Vec p = vmul(atan2Vector(vy, vsqrt(vadd(xx, zz))), toDegrees);
+        Vec r = vneg(vmul(atan2Vector(vx, vsqrt(vadd(yy, zz))), toDegrees));
+        const Mask flip = vand(vless(vz, zero), vgreater(vadd(xx, yy), zero));
+        const Vec offset = vselect(vgreater(r, zero), vsplat(180), vsplat(-180));
+        r = vselect(flip, vsub(offset, r), r);
+        vstore(pitch + i, p);
+        vstore(roll + i, r);
+    }
+    genericRotationAnglesScalar(x + i, y + i, z + i, count - i, pitch + i, roll + i);
+}
+
+void genericTiltAngles(const qreal *x, const qreal *y, const qreal *z, qsizetype count,
+                       qreal *pitch, qreal *roll)
+{
+    qsizetype i = 0;
+    for (; i + Lanes <= count; i += Lanes) {
+        const Vec vx = vload(x + i);
+        const Vec vy = vload(y + i);
+        const Vec vz = vload(z + i);
+        vstore(pitch + i, atan2Vector(vneg(vx), vsqrt(vadd(vmul(vy, vy), vmul(vz, vz)))));
+        vstore(roll + i, atan2Vector(vy, vz));
+    }
+    genericTiltAnglesScalar(x + i, y + i, z + i, count - i, pitch + i, roll + i);
+}
+
+#else
+
+void genericRotationAngles(const qreal *x, const qreal *y, const qreal *z, qsizetype count,
+                           qreal *pitch, qreal *roll)
+{
+    genericRotationAnglesScalar(x, y, z, count, pitch, roll);
+}
+
+void genericTiltAngles(const qreal *x, const qreal *y, const qreal *z, qsizetype count,
+                       qreal *pitch, qreal *roll)
+{
+    genericTiltAnglesScalar(x, y, z, count, pitch, roll);
+}
+
+#endif
+
+void genericOrientations(const qreal *x, const qreal *y, const qreal *z, qsizetype count,
+                         QOrientationReading::Orientation *orientation)
+{
+    // Without branches, so the compiler can vectorize the loop. The axes are
+    // checked in order of precedence, the first one over the threshold wins.
+    const qreal threshold = 7.35;
+    for (qsizetype i = 0; i < count; ++i) {
+        int o = QOrientationReading::Undefined;
+        o = (z[i] < -threshold) ? int(QOrientationReading::FaceDown) : o;
+        o = (z[i] > threshold) ? int(QOrientationReading::FaceUp) : o;
+        o = (x[i] < -threshold) ? int(QOrientationReading::LeftUp) : o;
+        o = (x[i] > threshold) ? int(QOrientationReading::RightUp) : o;
+        o = (y[i] < -threshold) ? int(QOrientationReading::TopDown) : o;
+        o = (y[i] > threshold) ? int(QOrientationReading::TopUp) : o;
+        orientation[i] = QOrientationReading::Orientation(o);
+    }
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,103 @@
+// Copyright (C) 2022 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef GENERICACCELERATIONKERNELS_H
+#define GENERICACCELERATIONKERNELS_H
+
+#include <QtSensors/qsensor.h>
+#include <QtSensors/qaccelerometer.h>
+#include <QtSensors/qorientationsensor.h>
+#include <QtCore/qvarlengtharray.h>
+
+#include <functional>
+
+QT_BEGIN_NAMESPACE
+
+/*
+  The angles the generic backends derive from accelerometer readings,
+  computed for whole blocks of readings. The values of each axis are passed
+  as one array so that several readings are computed at once in SIMD lanes
+  where SSE2 or NEON is available. The scalar versions give the same results
+  and compute the rest of a block that does not fill all lanes.
+*/
+
+// Pitch and roll of the rotation sensor, in degrees
+void genericRotationAngles(const qreal *x, const qreal *y, const qreal *z, qsizetype count,
+                           qreal *pitch, qreal *roll);
+void genericRotationAnglesScalar(const qreal *x, const qreal *y, const qreal *z, qsizetype count,
+                                 qreal *pitch, qreal *roll);
+
+// Angle between ground and X (pitch) and ground and Y (roll), in radians
+void genericTiltAngles(const qreal *x, const qreal *y, const qreal *z, qsizetype count,
+                       qreal *pitch, qreal *roll);
+void genericTiltAnglesScalar(const qreal *x, const qreal *y, const qreal *z, qsizetype count,
+                             qreal *pitch, qreal *roll);
+
+// The orientation each reading indicates, Undefined where it does not
+// indicate one and the previous orientation is kept
+void genericOrientations(const qreal *x, const qreal *y, const qreal *z, qsizetype count,
+                         QOrientationReading::Orientation *orientation);
+
+// A block of accelerometer readings, one array per axis
+class GenericAccelerationBlock
+{
+public:
+    void clear()
+    {
+        m_x.clear();
+        m_y.clear();
+        m_z.clear();
+        m_timestamps.clear();
+    }
+
+    void append(const QAccelerometerReading *reading)
+    {
+        m_x.append(reading->x());
+        m_y.append(reading->y());
+        m_z.append(reading->z());
+        m_timestamps.append(reading->timestamp());
+    }
+
+    void set(const QList<QSensorReading *> &readings)
+    {
+        clear();
+        for (const QSensorReading *reading : readings)
+            append(static_cast<const QAccelerometerReading *>(reading));
+    }
+
+    qsizetype count() const { return m_timestamps.size(); }
+    const qreal *x() const { return m_x.constData(); }
+    const qreal *y() const { return m_y.constData(); }
+    const qreal *z() const { return m_z.constData(); }
+    quint64 timestamp(qsizetype i) const { return m_timestamps.at(i); }
+
+private:
+    QVarLengthArray<qreal, 64> m_x;
+    QVarLengthArray<qreal, 64> m_y;
+    QVarLengthArray<qreal, 64> m_z;
+    QVarLengthArray<quint64, 64> m_timestamps;
+};
+
+// Hands the batches of the accelerometer a generic backend reads to the
+// backend, which delivers its own readings for them
+class GenericAccelerationBatchFilter : public QSensorBatchFilter
+{
+public:
+    explicit GenericAccelerationBatchFilter(std::function<void(const QList<QSensorReading *> &)> process)
+        : m_process(std::move(process))
+    {
+    }
+
+    bool filter(QList<QSensorReading *> &readings) override
+    {
+        m_process(readings);
+        return false;
+    }
+
+private:
+    std::function<void(const QList<QSensorReading *> &)> m_process;
+};
+
+QT_END_NAMESPACE
+
+#endif
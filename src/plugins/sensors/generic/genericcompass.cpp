@@ -0,0 +1,101 @@
+// Copyright (C) 2022 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "genericcompass.h"
+#include <QDebug>
+#include <qmath.h>
+
+char const * const GenericCompass::id("generic.compass");
+
+GenericCompass::GenericCompass(QSensor *sensor)
+    : QSensorBackend(sensor)
+{
+    accelerometer = new QAccelerometer(this);
+    accelerometer->addFilter(&gravity);
+    accelerometer->connectToBackend();
+
+    magnetometer = new QMagnetometer(this);
+    // Geomagnetic values have local interference removed
+    magnetometer->setReturnGeoValues(true);
+    magnetometer->addFilter(this);
+    magnetometer->connectToBackend();
+
+    setReading<QCompassReading>(&m_reading);
+    // Every magnetometer reading gives an azimuth
+    setDataRates(magnetometer);
+}
+
+void GenericCompass::start()
+{
+    gravity.valid = false;
+    magnetometer->setDataRate(sensor()->dataRate());
+    magnetometer->setAlwaysOn(sensor()->isAlwaysOn());
+    accelerometer->setDataRate(sensor()->dataRate());
+    accelerometer->setAlwaysOn(sensor()->isAlwaysOn());
+    accelerometer->start();
+    magnetometer->start();
+    if (!magnetometer->isActive() || !accelerometer->isActive())
+        sensorStopped();
+    if (magnetometer->isBusy() || accelerometer->isBusy())
+        sensorBusy();
+}
+
+void GenericCompass::stop()
+{
+    magnetometer->stop();
+    accelerometer->stop();
+}
+
+static inline bool normalize(qreal *v)
+{
+    const qreal norm = qSqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+    if (norm == 0)
+        return false;
+    v[0] /= norm;
+    v[1] /= norm;
+    v[2] /= norm;
+    return true;
+}
+
+bool GenericCompass::filter(QMagnetometerReading *reading)
+{
+    // Up is needed to tell the horizontal part of the magnetic field
+    if (!gravity.valid)
+        return false;
+
+    // East and north in device coordinates. The magnetic field points north
+    // and, away from the equator, down, so its cross product with up points
+    // east whatever the tilt of the device.
+    qreal up[3] = { gravity.x, gravity.y, gravity.z };
+    const qreal field[3] = { reading->x(), reading->y(), reading->z() };
+    qreal east[3] = {
+        field[1] * up[2] - field[2] * up[1],
+        field[2] * up[0] - field[0] * up[2],
+        field[0] * up[1] - field[1] * up[0]
+    };
+    if (!normalize(up) || !normalize(east))
+        return false;
+    const qreal north[3] = {
+        up[1] * east[2] - up[2] * east[1],
+        up[2] * east[0] - up[0] * east[2],
+        up[0] * east[1] - up[1] * east[0]
+    };
+
+    // The direction the top of the device points to, or the back of the
+    // device when the top points straight up or down
+    qreal e = east[1];
+    qreal n = north[1];
+    if (e * e + n * n < qreal(0.01)) {
+        e = -east[2];
+        n = -north[2];
+    }
+    qreal azimuth = qRadiansToDegrees(qAtan2(e, n));
+    if (azimuth < 0)
+        azimuth += 360;
+
+    m_reading.setTimestamp(reading->timestamp());
+    m_reading.setAzimuth(azimuth);
+    m_reading.setCalibrationLevel(reading->calibrationLevel());
+    newReadingAvailable();
+    return false;
+}
@@ -0,0 +1,54 @@
+// Copyright (C) 2022 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef GENERICCOMPASS_H
+#define GENERICCOMPASS_H
+
+#include <QtSensors/qsensorbackend.h>
+#include <QtSensors/qcompass.h>
+#include <QtSensors/qaccelerometer.h>
+#include <QtSensors/qmagnetometer.h>
+
+QT_BEGIN_NAMESPACE
+
+// Keeps the latest accelerometer reading for the next magnetometer reading
+class GenericCompassGravity : public QAccelerometerFilter
+{
+public:
+    bool filter(QAccelerometerReading *reading) override
+    {
+        x = reading->x();
+        y = reading->y();
+        z = reading->z();
+        valid = true;
+        return false;
+    }
+
+    qreal x = 0;
+    qreal y = 0;
+    qreal z = 0;
+    bool valid = false;
+};
+
+class GenericCompass : public QSensorBackend, public QMagnetometerFilter
+{
+public:
+    static char const * const id;
+
+    GenericCompass(QSensor *sensor);
+
+    void start() override;
+    void stop() override;
+
+    bool filter(QMagnetometerReading *reading) override;
+
+private:
+    QCompassReading m_reading;
+    QMagnetometer *magnetometer;
+    QAccelerometer *accelerometer;
+    GenericCompassGravity gravity;
+};
+
+QT_END_NAMESPACE
+
+#endif
@@ -0,0 +1,338 @@
+// Copyright (C) 2022 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "genericfusionrotationsensor.h"
+#include <QDebug>
+#include <qmath.h>
+
+char const * const GenericFusionRotationSensor::id("generic.rotation.fusion");
+
+// Readings further apart than this restart the filter from the
+// accelerometer and magnetometer instead of integrating the gap
+static const quint64 MaxGap = 500000; // microseconds
+
+static inline bool normalize(qreal *v)
+{
+    const qreal norm = qSqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+    if (norm == 0)
+        return false;
+    v[0] /= norm;
+    v[1] /= norm;
+    v[2] /= norm;
+    return true;
+}
+
+static inline void cross(const qreal *a, const qreal *b, qreal *result)
+{
+    result[0] = a[1] * b[2] - a[2] * b[1];
+    result[1] = a[2] * b[0] - a[0] * b[2];
+    result[2] = a[0] * b[1] - a[1] * b[0];
+}
+
+void GenericFusionFilter::reset(const qreal *acceleration, const qreal *magneticField)
+{
+    // The axes of the earth frame in device coordinates are the rows of the
+    // rotation from the device to the earth frame
+    qreal up[3] = { acceleration[0], acceleration[1], acceleration[2] };
+    if (!normalize(up))
+        return;
+    // North is the horizontal part of the magnetic field
+    qreal north[3] = { 0, 1, 0 };
+    if (magneticField)
+        memcpy(north, magneticField, sizeof(north));
+    qreal d = north[0] * up[0] + north[1] * up[1] + north[2] * up[2];
+    for (int i = 0; i < 3; ++i)
+        north[i] -= d * up[i];
+    if (!normalize(north)) {
+        // Pointing straight up or down, take the top of the device
+        north[0] = 0;
+        north[1] = 0;
+        north[2] = 1;
+        d = up[2];
+        for (int i = 0; i < 3; ++i)
+            north[i] -= d * up[i];
+        normalize(north);
+    }
+    qreal west[3];
+    cross(up, north, west);
+
+    const qreal r00 = north[0], r01 = north[1], r02 = north[2];
+    const qreal r10 = west[0], r11 = west[1], r12 = west[2];
+    const qreal r20 = up[0], r21 = up[1], r22 = up[2];
+    const qreal trace = r00 + r11 + r22;
+    if (trace > 0) {
+        const qreal s = qSqrt(trace + 1) * 2;
+        q0 = s / 4;
+        q1 = (r21 - r12) / s;
+        q2 = (r02 - r20) / s;
+        q3 = (r10 - r01) / s;
+    } else if (r00 > r11 && r00 > r22) {
+        const qreal s = qSqrt(1 + r00 - r11 - r22) * 2;
+        q0 = (r21 - r12) / s;
+        q1 = s / 4;
+        q2 = (r01 + r10) / s;
+        q3 = (r02 + r20) / s;
+    } else if (r11 > r22) {
+        const qreal s = qSqrt(1 + r11 - r00 - r22) * 2;
+        q0 = (r02 - r20) / s;
+        q1 = (r01 + r10) / s;
+        q2 = s / 4;
+        q3 = (r12 + r21) / s;
+    } else {
+        const qreal s = qSqrt(1 + r22 - r00 - r11) * 2;
+        q0 = (r10 - r01) / s;
+        q1 = (r02 + r20) / s;
+        q2 = (r12 + r21) / s;
+        q3 = s / 4;
+    }
+}
+
+/*
+  One step of the filter described in S. Madgwick, "An efficient
+  orientation filter for inertial and inertial/magnetic sensor arrays",
+  2010. The rate of change of the orientation is the one the gyroscope
+  measures, minus beta times the normalized gradient of the error between
+  the measured and the expected directions of gravity and of the magnetic
+  field.
+*/
+void GenericFusionFilter::update(const qreal *rotationRate, const qreal *acceleration,
+                                 const qreal *magneticField, qreal dt)
+{
+    const qreal gx = rotationRate[0];
+    const qreal gy = rotationRate[1];
+    const qreal gz = rotationRate[2];
+
+    qreal qDot0 = qreal(0.5) * (-q1 * gx - q2 * gy - q3 * gz);
+    qreal qDot1 = qreal(0.5) * (q0 * gx + q2 * gz - q3 * gy);
+    qreal qDot2 = qreal(0.5) * (q0 * gy - q1 * gz + q3 * gx);
+    qreal qDot3 = qreal(0.5) * (q0 * gz + q1 * gy - q2 * gx);
+
+    qreal a[3] = { acceleration[0], acceleration[1], acceleration[2] };
+    qreal m[3] = { 0, 0, 0 };
+    bool hasMagneticField = false;
+    if (magneticField) {
+        memcpy(m, magneticField, sizeof(m));
+        hasMagneticField = normalize(m);
+    }
+    if (normalize(a)) {
+        const qreal ax = a[0], ay = a[1], az = a[2];
+        const qreal q0q0 = q0 * q0, q1q1 = q1 * q1, q2q2 = q2 * q2, q3q3 = q3 * q3;
+        const qreal _2q0 = 2 * q0, _2q1 = 2 * q1, _2q2 = 2 * q2, _2q3 = 2 * q3;
+        qreal s0, s1, s2, s3;
+        if (hasMagneticField) {
+            const qreal mx = m[0], my = m[1], mz = m[2];
+            const qreal q0q1 = q0 * q1, q0q2 = q0 * q2, q0q3 = q0 * q3;
+            const qreal q1q2 = q1 * q2, q1q3 = q1 * q3, q2q3 = q2 * q3;
+            const qreal _2q0mx = _2q0 * mx, _2q0my = _2q0 * my, _2q0mz = _2q0 * mz;
+            const qreal _2q1mx = _2q1 * mx;
+            const qreal _2q0q2 = 2 * q0q2, _2q2q3 = 2 * q2q3;
+
+            // The magnetic field in the earth frame, rotated into the plane
+            // of north and up
+            const qreal hx = mx * q0q0 - _2q0my * q3 + _2q0mz * q2 + mx * q1q1 + _2q1 * my * q2
+                    + _2q1 * mz * q3 - mx * q2q2 - mx * q3q3;
+            const qreal hy = _2q0mx * q3 + my * q0q0 - _2q0mz * q1 + _2q1mx * q2 - my * q1q1
+                    + my * q2q2 + _2q2 * mz * q3 - my * q3q3;
+            const qreal _2bx = qSqrt(hx * hx + hy * hy);
+            const qreal _2bz = -_2q0mx * q2 + _2q0my * q1 + mz * q0q0 + _2q1mx * q3 - mz * q1q1
+                    + _2q2 * my * q3 - mz * q2q2 + mz * q3q3;
+            const qreal _4bx = 2 * _2bx;
+            const qreal _4bz = 2 * _2bz;
+
+            // Errors of the expected gravity and magnetic field directions
+            const qreal fax = 2 * q1q3 - _2q0q2 - ax;
+            const qreal fay = 2 * q0q1 + _2q2q3 - ay;
+            const qreal faz = 1 - 2 * q1q1 - 2 * q2q2 - az;
+            const qreal fmx = _2bx * (qreal(0.5) - q2q2 - q3q3) + _2bz * (q1q3 - q0q2) - mx;
+            const qreal fmy = _2bx * (q1q2 - q0q3) + _2bz * (q0q1 + q2q3) - my;
+            const qreal fmz = _2bx * (q0q2 + q1q3) + _2bz * (qreal(0.5) - q1q1 - q2q2) - mz;
+
+            s0 = -_2q2 * fax + _2q1 * fay - _2bz * q2 * fmx + (-_2bx * q3 + _2bz * q1) * fmy
+                    + _2bx * q2 * fmz;
+            s1 = _2q3 * fax + _2q0 * fay - 4 * q1 * faz + _2bz * q3 * fmx
+                    + (_2bx * q2 + _2bz * q0) * fmy + (_2bx * q3 - _4bz * q1) * fmz;
+            s2 = -_2q0 * fax + _2q3 * fay - 4 * q2 * faz + (-_4bx * q2 - _2bz * q0) * fmx
+                    + (_2bx * q1 + _2bz * q3) * fmy + (_2bx * q0 - _4bz * q2) * fmz;
+            s3 = _2q1 * fax + _2q2 * fay + (-_4bx * q3 + _2bz * q1) * fmx
+                    + (-_2bx * q0 + _2bz * q2) * fmy + _2bx * q1 * fmz;
+        } else {
+            const qreal _4q0 = 4 * q0, _4q1 = 4 * q1, _4q2 = 4 * q2;
+            const qreal _8q1 = 8 * q1, _8q2 = 8 * q2;
+
+            s0 = _4q0 * q2q2 + _2q2 * ax + _4q0 * q1q1 - _2q1 * ay;
+            s1 = _4q1 * q3q3 - _2q3 * ax + 4 * q0q0 * q1 - _2q0 * ay - _4q1 + _8q1 * q1q1
+                    + _8q1 * q2q2 + _4q1 * az;
+            s2 = 4 * q0q0 * q2 + _2q0 * ax + _4q2 * q3q3 - _2q3 * ay - _4q2 + _8q2 * q1q1
+                    + _8q2 * q2q2 + _4q2 * az;
+            s3 = 4 * q1q1 * q3 - _2q1 * ax + 4 * q2q2 * q3 - _2q2 * ay;
+        }
+
+        const qreal norm = qSqrt(s0 * s0 + s1 * s1 + s2 * s2 + s3 * s3);
+        if (norm > 0) {
+            qDot0 -= beta * s0 / norm;
+            qDot1 -= beta * s1 / norm;
+            qDot2 -= beta * s2 / norm;
+            qDot3 -= beta * s3 / norm;
+        }
+    }
+
+    q0 += qDot0 * dt;
+    q1 += qDot1 * dt;
+    q2 += qDot2 * dt;
+    q3 += qDot3 * dt;
+    const qreal norm = qSqrt(q0 * q0 + q1 * q1 + q2 * q2 + q3 * q3);
+    q0 /= norm;
+    q1 /= norm;
+    q2 /= norm;
+    q3 /= norm;
+}
+
+void GenericFusionFilter::eulerAngles(qreal *x, qreal *y, qreal *z) const
+{
+    // QRotationReading applies z, then x, then y. Written as a rotation
+    // matrix from the device to the earth frame, sin(x) is r21,
+    // -cos(x) sin(y) and cos(x) cos(y) are r20 and r22, and -sin(z) cos(x)
+    // and cos(z) cos(x) are r01 and r11.
+    const qreal r00 = 1 - 2 * (q2 * q2 + q3 * q3);
+    const qreal r01 = 2 * (q1 * q2 - q0 * q3);
+    const qreal r10 = 2 * (q1 * q2 + q0 * q3);
+    const qreal r11 = 1 - 2 * (q1 * q1 + q3 * q3);
+    const qreal r20 = 2 * (q1 * q3 - q0 * q2);
+    const qreal r21 = 2 * (q2 * q3 + q0 * q1);
+    const qreal r22 = 1 - 2 * (q1 * q1 + q2 * q2);
+
+    qreal yaw;
+    *x = qRadiansToDegrees(qAsin(qBound(qreal(-1), r21, qreal(1))));
+    if (qAbs(r21) > qreal(0.99999)) {
+        // z and y rotate around the same axis, y is 0 then
+        *y = 0;
+        yaw = qAtan2(r10, r00);
+    } else {
+        *y = qRadiansToDegrees(qAtan2(-r20, r22));
+        yaw = qAtan2(-r01, r11);
+    }
+    // The earth frame has X to the north, QRotationReading has Y
+    *z = qRadiansToDegrees(yaw) + 90;
+    if (*z > 180)
+        *z -= 360;
+}
+
+bool GenericFusionInput::filter(QSensorReading *reading)
+{
+    (m_backend->*m_handler)(reading);
+    return false;
+}
+
+GenericFusionRotationSensor::GenericFusionRotationSensor(QSensor *sensor)
+    : QSensorBackend(sensor)
+    , m_gyroscopeInput(this, &GenericFusionRotationSensor::gyroscopeReading)
+    , m_accelerometerInput(this, &GenericFusionRotationSensor::accelerometerReading)
+    , m_magnetometerInput(this, &GenericFusionRotationSensor::magnetometerReading)
+    , m_hasAcceleration(false)
+    , m_hasMagneticField(false)
+    , m_initialized(false)
+    , m_timestamp(0)
+{
+    m_gyroscope = new QGyroscope(this);
+    m_gyroscope->addFilter(&m_gyroscopeInput);
+    m_gyroscope->connectToBackend();
+
+    m_accelerometer = new QAccelerometer(this);
+    m_accelerometer->addFilter(&m_accelerometerInput);
+    m_accelerometer->connectToBackend();
+
+    // Without a magnetometer there is no fixed reference for z
+    m_magnetometer = new QMagnetometer(this);
+    m_magnetometer->addFilter(&m_magnetometerInput);
+    if (!m_magnetometer->connectToBackend()) {
+        delete m_magnetometer;
+        m_magnetometer = nullptr;
+    }
+
+    setReading<QRotationReading>(&m_reading);
+    // The gyroscope drives the readings
+    setDataRates(m_gyroscope);
+
+    QRotationSensor * const rotationSensor = qobject_cast<QRotationSensor *>(sensor);
+    if (rotationSensor)
+        rotationSensor->setHasZ(m_magnetometer != nullptr);
+}
+
+void GenericFusionRotationSensor::start()
+{
+    m_hasAcceleration = false;
+    m_hasMagneticField = false;
+    m_initialized = false;
+
+    m_gyroscope->setDataRate(sensor()->dataRate());
+    m_gyroscope->setAlwaysOn(sensor()->isAlwaysOn());
+    m_accelerometer->setDataRate(sensor()->dataRate());
+    m_accelerometer->setAlwaysOn(sensor()->isAlwaysOn());
+    m_accelerometer->start();
+    m_gyroscope->start();
+    if (m_magnetometer) {
+        m_magnetometer->setAlwaysOn(sensor()->isAlwaysOn());
+        m_magnetometer->start();
+    }
+    if (!m_gyroscope->isActive() || !m_accelerometer->isActive())
+        sensorStopped();
+    if (m_gyroscope->isBusy() || m_accelerometer->isBusy())
+        sensorBusy();
+}
+
+void GenericFusionRotationSensor::stop()
+{
+    m_gyroscope->stop();
+    m_accelerometer->stop();
+    if (m_magnetometer)
+        m_magnetometer->stop();
+}
+
+void GenericFusionRotationSensor::accelerometerReading(QSensorReading *reading)
+{
+    const QAccelerometerReading *ar = static_cast<QAccelerometerReading *>(reading);
+    m_acceleration[0] = ar->x();
+    m_acceleration[1] = ar->y();
+    m_acceleration[2] = ar->z();
+    m_hasAcceleration = true;
+}
+
+void GenericFusionRotationSensor::magnetometerReading(QSensorReading *reading)
+{
+    const QMagnetometerReading *mr = static_cast<QMagnetometerReading *>(reading);
+    m_magneticField[0] = mr->x();
+    m_magneticField[1] = mr->y();
+    m_magneticField[2] = mr->z();
+    m_hasMagneticField = true;
+}
+
+void GenericFusionRotationSensor::gyroscopeReading(QSensorReading *reading)
+{
+    // The filter needs to know where down is before it can start
+    if (!m_hasAcceleration)
+        return;
+
+    const QGyroscopeReading *gr = static_cast<QGyroscopeReading *>(reading);
+    const quint64 timestamp = gr->timestamp();
+    const qreal *magneticField = m_hasMagneticField ? m_magneticField : nullptr;
+    if (!m_initialized || timestamp <= m_timestamp || timestamp - m_timestamp > MaxGap) {
+        m_filter.reset(m_acceleration, magneticField);
+        m_initialized = true;
+    } else {
+        // QGyroscopeReading is in degrees per second
+        const qreal rotationRate[3] = {
+            qDegreesToRadians(gr->x()),
+            qDegreesToRadians(gr->y()),
+            qDegreesToRadians(gr->z())
+        };
+        m_filter.update(rotationRate, m_acceleration, magneticField,
+                        qreal(timestamp - m_timestamp) / 1000000);
+    }
+    m_timestamp = timestamp;
+
+    qreal x, y, z;
+    m_filter.eulerAngles(&x, &y, &z);
+    m_reading.setTimestamp(timestamp);
+    m_reading.setFromEuler(x, y, m_magnetometer ? z : 0);
+    newReadingAvailable();
+}
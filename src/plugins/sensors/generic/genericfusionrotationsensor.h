@@ -0,0 +1,98 @@
+// Copyright (C) 2022 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef GENERICFUSIONROTATIONSENSOR_H
+#define GENERICFUSIONROTATIONSENSOR_H
+
+#include <QtSensors/qsensorbackend.h>
+#include <QtSensors/qrotationsensor.h>
+#include <QtSensors/qaccelerometer.h>
+#include <QtSensors/qgyroscope.h>
+#include <QtSensors/qmagnetometer.h>
+
+QT_BEGIN_NAMESPACE
+
+// Orientation of the device as a unit quaternion, fused from gyroscope,
+// accelerometer and optionally magnetometer readings with Madgwick's
+// gradient descent filter. The earth frame has X to magnetic north and
+// Z up. Every update takes constant time.
+class GenericFusionFilter
+{
+public:
+    // Starts from the orientation the gravity and magnetic field vectors
+    // indicate. Without a magnetic field the Y axis of the device is taken
+    // as north.
+    void reset(const qreal *acceleration, const qreal *magneticField);
+    // Integrates the rotation rates in rad/s over dt seconds and corrects
+    // the result towards the gravity and magnetic field vectors
+    void update(const qreal *rotationRate, const qreal *acceleration, const qreal *magneticField,
+                qreal dt);
+    // The rotation in degrees as QRotationReading defines it
+    void eulerAngles(qreal *x, qreal *y, qreal *z) const;
+
+    qreal beta = 0.1;
+
+private:
+    qreal q0 = 1;
+    qreal q1 = 0;
+    qreal q2 = 0;
+    qreal q3 = 0;
+};
+
+class GenericFusionRotationSensor;
+
+// Hands the readings of one of the fused sensors to the backend
+class GenericFusionInput : public QSensorFilter
+{
+public:
+    typedef void (GenericFusionRotationSensor::*Handler)(QSensorReading *reading);
+
+    GenericFusionInput(GenericFusionRotationSensor *backend, Handler handler)
+        : m_backend(backend)
+        , m_handler(handler)
+    {
+    }
+
+    bool filter(QSensorReading *reading) override;
+
+private:
+    GenericFusionRotationSensor *m_backend;
+    Handler m_handler;
+};
+
+class GenericFusionRotationSensor : public QSensorBackend
+{
+public:
+    static char const * const id;
+
+    GenericFusionRotationSensor(QSensor *sensor);
+
+    void start() override;
+    void stop() override;
+
+private:
+    friend class GenericFusionInput;
+
+    void gyroscopeReading(QSensorReading *reading);
+    void accelerometerReading(QSensorReading *reading);
+    void magnetometerReading(QSensorReading *reading);
+
+    QRotationReading m_reading;
+    QGyroscope *m_gyroscope;
+    QAccelerometer *m_accelerometer;
+    QMagnetometer *m_magnetometer;
+    GenericFusionInput m_gyroscopeInput;
+    GenericFusionInput m_accelerometerInput;
+    GenericFusionInput m_magnetometerInput;
+    GenericFusionFilter m_filter;
+    qreal m_acceleration[3];
+    qreal m_magneticField[3];
+    bool m_hasAcceleration;
+    bool m_hasMagneticField;
+    bool m_initialized;
+    quint64 m_timestamp;
+};
+
+QT_END_NAMESPACE
+
+#endif
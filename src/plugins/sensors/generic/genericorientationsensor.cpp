@@ -8,9 +8,16 @@ char const * const genericorientationsensor::id("generic.orientation");
 
 genericorientationsensor::genericorientationsensor(QSensor *sensor)
     : QSensorBackend(sensor)
+    , m_batchFilter([this](const QList<QSensorReading *> &readings) {
+        m_block.set(readings);
+        processBlock();
+    })
+    , m_batching(false)
 {
     accelerometer = new QAccelerometer(this);
+    accelerometer->setSharedBackend(true);
     accelerometer->addFilter(this);
+    accelerometer->addBatchFilter(&m_batchFilter);
     accelerometer->connectToBackend();
 
     setReading<QOrientationReading>(&m_reading);
@@ -21,6 +28,9 @@ void genericorientationsensor::start()
 {
     accelerometer->setDataRate(sensor()->dataRate());
     accelerometer->setAlwaysOn(sensor()->isAlwaysOn());
+    // Readings are computed a block at a time when they are batched
+    accelerometer->setBufferSize(sensor()->bufferSize());
+    m_batching = accelerometer->bufferSize() > 1;
     accelerometer->start();
     if (!accelerometer->isActive())
         sensorStopped();
@@ -35,27 +45,40 @@ void genericorientationsensor::stop()
 
 bool genericorientationsensor::filter(QAccelerometerReading *reading)
 {
-    QOrientationReading::Orientation o = m_reading.orientation();
-
-    if (reading->y() > 7.35)
-        o = QOrientationReading::TopUp;
-    else if (reading->y() < -7.35)
-        o = QOrientationReading::TopDown;
-    else if (reading->x() > 7.35)
-        o = QOrientationReading::RightUp;
-    else if (reading->x() < -7.35)
-        o = QOrientationReading::LeftUp;
-    else if (reading->z() > 7.35)
-        o = QOrientationReading::FaceUp;
-    else if (reading->z() < -7.35)
-        o = QOrientationReading::FaceDown;
-
-    if (o != m_reading.orientation() || m_reading.timestamp() == 0) {
-        m_reading.setTimestamp(reading->timestamp());
-        m_reading.setOrientation(o);
-        newReadingAvailable();
-    }
+    // Batched readings are left for the batch filter
+    if (m_batching)
+        return true;
 
+    m_block.clear();
+    m_block.append(reading);
+    processBlock();
     return false;
 }
 
+bool genericorientationsensor::isFeatureSupported(QSensor::Feature feature) const
+{
+    return (feature == QSensor::Feature::Buffering);
+}
+
+void genericorientationsensor::processBlock()
+{
+    const qsizetype count = m_block.count();
+    m_orientations.resize(count);
+    genericOrientations(m_block.x(), m_block.y(), m_block.z(), count, m_orientations.data());
+
+    if (m_batching)
+        beginReadingBatch();
+    for (qsizetype i = 0; i < count; ++i) {
+        QOrientationReading::Orientation o = m_orientations.at(i);
+        if (o == QOrientationReading::Undefined)
+            o = m_reading.orientation();
+
+        if (o != m_reading.orientation() || m_reading.timestamp() == 0) {
+            m_reading.setTimestamp(m_block.timestamp(i));
+            m_reading.setOrientation(o);
+            newReadingAvailable();
+        }
+    }
+    if (m_batching)
+        endReadingBatch();
+}
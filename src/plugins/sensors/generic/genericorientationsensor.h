@@ -7,6 +7,7 @@
 #include <QtSensors/qsensorbackend.h>
 #include <QtSensors/qorientationsensor.h>
 #include <QtSensors/qaccelerometer.h>
+#include "genericaccelerationkernels.h"
 
 class genericorientationsensor : public QSensorBackend, public QAccelerometerFilter
 {
@@ -20,9 +21,17 @@ public:
 
     bool filter(QAccelerometerReading *reading) override;
 
+    bool isFeatureSupported(QSensor::Feature feature) const override;
+
 private:
+    void processBlock();
+
     QOrientationReading m_reading;
     QAccelerometer *accelerometer;
+    GenericAccelerationBatchFilter m_batchFilter;
+    GenericAccelerationBlock m_block;
+    QVarLengthArray<QOrientationReading::Orientation, 64> m_orientations;
+    bool m_batching;
 };
 
 #endif
@@ -3,15 +3,22 @@
 
 #include "genericrotationsensor.h"
 #include <QDebug>
-#include <qmath.h>
 
 char const * const genericrotationsensor::id("generic.rotation");
 
 genericrotationsensor::genericrotationsensor(QSensor *sensor)
     : QSensorBackend(sensor)
+    , m_batchFilter([this](const QList<QSensorReading *> &readings) {
+        m_block.set(readings);
+        processBlock();
+    })
+    , m_batching(false)
 {
     accelerometer = new QAccelerometer(this);
+    // Tilt and orientation sensors of the application can use the same one
+    accelerometer->setSharedBackend(true);
     accelerometer->addFilter(this);
+    accelerometer->addBatchFilter(&m_batchFilter);
     accelerometer->connectToBackend();
 
     setReading<QRotationReading>(&m_reading);
@@ -26,6 +33,9 @@ void genericrotationsensor::start()
 {
     accelerometer->setDataRate(sensor()->dataRate());
     accelerometer->setAlwaysOn(sensor()->isAlwaysOn());
+    // Readings are computed a block at a time when they are batched
+    accelerometer->setBufferSize(sensor()->bufferSize());
+    m_batching = accelerometer->bufferSize() > 1;
     accelerometer->start();
     if (!accelerometer->isActive())
         sensorStopped();
@@ -40,37 +50,35 @@ void genericrotationsensor::stop()
 
 bool genericrotationsensor::filter(QSensorReading *reading)
 {
-    QAccelerometerReading *ar = qobject_cast<QAccelerometerReading*>(reading);
-    qreal pitch = 0;
-    qreal roll = 0;
+    // Batched readings are left for the batch filter
+    if (m_batching)
+        return true;
 
-    qreal x = ar->x();
-    qreal y = ar->y();
-    qreal z = ar->z();
+    m_block.clear();
+    m_block.append(qobject_cast<QAccelerometerReading*>(reading));
+    processBlock();
+    return false;
+}
 
-    // Note that the formula used come from this document:
-    // http://www.freescale.com/files/sensors/doc/app_note/AN3461.pdf
-    pitch = qRadiansToDegrees(qAtan(y / qSqrt(x * x + z * z)));
-    roll  = qRadiansToDegrees(qAtan(x / qSqrt(y * y + z * z)));
-    // Roll is a left-handed rotation but we need right-handed rotation
-    roll = -roll;
+bool genericrotationsensor::isFeatureSupported(QSensor::Feature feature) const
+{
+    return (feature == QSensor::Feature::Buffering);
+}
 
-    // We need to fix up roll to the (-180,180] range required.
-    // Check for negative theta values and apply an offset as required.
-    // Note that theta is defined as the angle of the Z axis relative
-    // to gravity (see referenced document). It's negative when the
-    // face of the device points downward.
-    qreal theta = qRadiansToDegrees(qAtan(qSqrt(x * x + y * y) / z));
-    if (theta < 0) {
-        if (roll > 0)
-            roll = 180 - roll;
-        else
-            roll = -180 - roll;
-    }
+void genericrotationsensor::processBlock()
+{
+    const qsizetype count = m_block.count();
+    m_pitch.resize(count);
+    m_roll.resize(count);
+    genericRotationAngles(m_block.x(), m_block.y(), m_block.z(), count, m_pitch.data(), m_roll.data());
 
-    m_reading.setTimestamp(ar->timestamp());
-    m_reading.setFromEuler(pitch, roll, 0);
-    newReadingAvailable();
-    return false;
+    if (m_batching)
+        beginReadingBatch();
+    for (qsizetype i = 0; i < count; ++i) {
+        m_reading.setTimestamp(m_block.timestamp(i));
+        m_reading.setFromEuler(m_pitch.at(i), m_roll.at(i), 0);
+        newReadingAvailable();
+    }
+    if (m_batching)
+        endReadingBatch();
 }
-
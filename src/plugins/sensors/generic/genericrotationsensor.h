@@ -8,6 +8,7 @@
 #include <QtSensors/qrotationsensor.h>
 #include <QtSensors/qaccelerometer.h>
 #include <QtSensors/qmagnetometer.h>
+#include "genericaccelerationkernels.h"
 
 class genericrotationsensor : public QSensorBackend, public QSensorFilter
 {
@@ -21,9 +22,18 @@ public:
 
     bool filter(QSensorReading *reading) override;
 
+    bool isFeatureSupported(QSensor::Feature feature) const override;
+
 private:
+    void processBlock();
+
     QRotationReading m_reading;
     QAccelerometer *accelerometer;
+    GenericAccelerationBatchFilter m_batchFilter;
+    GenericAccelerationBlock m_block;
+    QVarLengthArray<qreal, 64> m_pitch;
+    QVarLengthArray<qreal, 64> m_roll;
+    bool m_batching;
 };
 
 #endif
@@ -9,6 +9,11 @@ char const * const GenericTiltSensor::id("generic.tilt");
 
 GenericTiltSensor::GenericTiltSensor(QSensor *sensor)
     : QSensorBackend(sensor)
+    , m_batchFilter([this](const QList<QSensorReading *> &readings) {
+        m_block.set(readings);
+        processBlock();
+    })
+    , m_batching(false)
     , radAccuracy(qDegreesToRadians(qreal(1)))
     , pitch(0)
     , roll(0)
@@ -18,7 +23,9 @@ GenericTiltSensor::GenericTiltSensor(QSensor *sensor)
     , yRotation(0)
 {
     accelerometer = new QAccelerometer(this);
+    accelerometer->setSharedBackend(true);
     accelerometer->addFilter(this);
+    accelerometer->addBatchFilter(&m_batchFilter);
     accelerometer->connectToBackend();
 
     setReading<QTiltReading>(&m_reading);
@@ -29,6 +36,9 @@ void GenericTiltSensor::start()
 {
     accelerometer->setDataRate(sensor()->dataRate());
     accelerometer->setAlwaysOn(sensor()->isAlwaysOn());
+    // Readings are computed a block at a time when they are batched
+    accelerometer->setBufferSize(sensor()->bufferSize());
+    m_batching = accelerometer->bufferSize() > 1;
     accelerometer->start();
     if (!accelerometer->isActive())
         sensorStopped();
@@ -42,19 +52,16 @@ void GenericTiltSensor::stop()
 }
 
 /*
-  Angle between Ground and X
+  Same as qAtan2(qSin(angle), qCos(angle)) for angles in [-2 pi, 2 pi],
+  i.e. the angle between 0 and 180 or 0 and -180
 */
-static inline qreal calcPitch(double Ax, double Ay, double Az)
+static inline qreal wrapAngle(qreal angle)
 {
-    return qAtan2(-Ax, qSqrt(Ay * Ay + Az * Az));
-}
-
-/*
-  Angle between Ground and Y
-*/
-static inline qreal calcRoll(double /*Ax*/, double Ay, double Az)
-{
-    return qAtan2(Ay, Az);
+    if (angle > M_PI)
+        return angle - 2 * M_PI;
+    if (angle < -M_PI)
+        return angle + 2 * M_PI;
+    return angle;
 }
 
 void GenericTiltSensor::calibrate()
@@ -64,6 +71,18 @@ void GenericTiltSensor::calibrate()
 }
 
 bool GenericTiltSensor::filter(QAccelerometerReading *reading)
+{
+    // Batched readings are left for the batch filter
+    if (m_batching)
+        return true;
+
+    m_block.clear();
+    m_block.append(reading);
+    processBlock();
+    return false;
+}
+
+void GenericTiltSensor::processBlock()
 {
     /*
       z  y
@@ -71,59 +90,62 @@ bool GenericTiltSensor::filter(QAccelerometerReading *reading)
       |/___ x
     */
 
-    qreal ax = reading->x();
-    qreal ay = reading->y();
-    qreal az = reading->z();
+    const qsizetype count = m_block.count();
+    m_pitch.resize(count);
+    m_roll.resize(count);
+    genericTiltAngles(m_block.x(), m_block.y(), m_block.z(), count, m_pitch.data(), m_roll.data());
+
+    if (m_batching)
+        beginReadingBatch();
+    for (qsizetype i = 0; i < count; ++i) {
 #ifdef LOGCALIBRATION
-    qDebug() << "------------ new value -----------";
-    qDebug() << "old _pitch: " << pitch;
-    qDebug() << "old _roll: " << roll;
-    qDebug() << "_calibratedPitch: " << calibratedPitch;
-    qDebug() << "_calibratedRoll: " << calibratedRoll;
+        qDebug() << "------------ new value -----------";
+        qDebug() << "old _pitch: " << pitch;
+        qDebug() << "old _roll: " << roll;
+        qDebug() << "_calibratedPitch: " << calibratedPitch;
+        qDebug() << "_calibratedRoll: " << calibratedRoll;
 #endif
-    pitch = calcPitch(ax, ay, az);
-    roll  = calcRoll (ax, ay, az);
+        pitch = m_pitch.at(i);
+        roll = m_roll.at(i);
 #ifdef LOGCALIBRATION
-    qDebug() << "_pitch: " << pitch;
-    qDebug() << "_roll: " << roll;
+        qDebug() << "_pitch: " << pitch;
+        qDebug() << "_roll: " << roll;
 #endif
-    qreal xrot = roll - calibratedRoll;
-    qreal yrot = pitch - calibratedPitch;
-    //get angle between 0 and 180 or 0 -180
-    xrot = qAtan2(qSin(xrot), qCos(xrot));
-    yrot = qAtan2(qSin(yrot), qCos(yrot));
+        const qreal xrot = wrapAngle(roll - calibratedRoll);
+        const qreal yrot = wrapAngle(pitch - calibratedPitch);
 
 #ifdef LOGCALIBRATION
-    qDebug() << "new xrot: " << xrot;
-    qDebug() << "new yrot: " << yrot;
-    qDebug() << "----------------------------------";
+        qDebug() << "new xrot: " << xrot;
+        qDebug() << "new yrot: " << yrot;
+        qDebug() << "----------------------------------";
 #endif
-    qreal dxrot = qRadiansToDegrees(xrot) - xRotation;
-    qreal dyrot = qRadiansToDegrees(yrot) - yRotation;
-    if (dxrot < 0) dxrot = -dxrot;
-    if (dyrot < 0) dyrot = -dyrot;
-
-    bool setNewReading = false;
-    if (dxrot >= qRadiansToDegrees(radAccuracy) || !sensor()->skipDuplicates()) {
-        xRotation = qRadiansToDegrees(xrot);
-        setNewReading = true;
-    }
-    if (dyrot >= qRadiansToDegrees(radAccuracy) || !sensor()->skipDuplicates()) {
-        yRotation = qRadiansToDegrees(yrot);
-        setNewReading = true;
+        qreal dxrot = qRadiansToDegrees(xrot) - xRotation;
+        qreal dyrot = qRadiansToDegrees(yrot) - yRotation;
+        if (dxrot < 0) dxrot = -dxrot;
+        if (dyrot < 0) dyrot = -dyrot;
+
+        bool setNewReading = false;
+        if (dxrot >= qRadiansToDegrees(radAccuracy) || !sensor()->skipDuplicates()) {
+            xRotation = qRadiansToDegrees(xrot);
+            setNewReading = true;
+        }
+        if (dyrot >= qRadiansToDegrees(radAccuracy) || !sensor()->skipDuplicates()) {
+            yRotation = qRadiansToDegrees(yrot);
+            setNewReading = true;
+        }
+
+        if (setNewReading || m_reading.timestamp() == 0) {
+            m_reading.setTimestamp(m_block.timestamp(i));
+            m_reading.setXRotation(xRotation);
+            m_reading.setYRotation(yRotation);
+            newReadingAvailable();
+        }
     }
-
-    if (setNewReading || m_reading.timestamp() == 0) {
-        m_reading.setTimestamp(reading->timestamp());
-        m_reading.setXRotation(xRotation);
-        m_reading.setYRotation(yRotation);
-        newReadingAvailable();
-    }
-
-    return false;
+    if (m_batching)
+        endReadingBatch();
 }
 
 bool GenericTiltSensor::isFeatureSupported(QSensor::Feature feature) const
 {
-    return (feature == QSensor::Feature::SkipDuplicates);
+    return (feature == QSensor::Feature::SkipDuplicates || feature == QSensor::Feature::Buffering);
 }
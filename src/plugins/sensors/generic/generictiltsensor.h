@@ -7,6 +7,7 @@
 #include <QtSensors/qsensorbackend.h>
 #include <QtSensors/qtiltsensor.h>
 #include <QtSensors/qaccelerometer.h>
+#include "genericaccelerationkernels.h"
 
 QT_BEGIN_NAMESPACE
 
@@ -29,8 +30,15 @@ public:
     bool isFeatureSupported(QSensor::Feature feature) const override;
 
 private:
+    void processBlock();
+
     QTiltReading m_reading;
     QAccelerometer *accelerometer;
+    GenericAccelerationBatchFilter m_batchFilter;
+    GenericAccelerationBlock m_block;
+    QVarLengthArray<qreal, 64> m_pitch;
+    QVarLengthArray<qreal, 64> m_roll;
+    bool m_batching;
     qreal radAccuracy;
     qreal pitch;
     qreal roll;
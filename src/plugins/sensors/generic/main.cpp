@@ -7,12 +7,18 @@
 #ifdef QTSENSORS_GENERICROTATIONSENSOR
 #include "genericrotationsensor.h"
 #endif
+#ifdef QTSENSORS_GENERICFUSIONROTATIONSENSOR
+#include "genericfusionrotationsensor.h"
+#endif
 #ifdef QTSENSORS_GENERICALSSENSOR
 #include "genericalssensor.h"
 #endif
 #ifdef QTSENSORS_GENERICTILTSENSOR
 #include "generictiltsensor.h"
 #endif
+#ifdef QTSENSORS_GENERICCOMPASS
+#include "genericcompass.h"
+#endif
 #include <QtSensors/qsensorplugin.h>
 #include <QtSensors/qsensorbackend.h>
 #include <QtSensors/qsensormanager.h>
@@ -42,6 +48,17 @@ public:
             if (!QSensorManager::isBackendRegistered(QRotationSensor::sensorType, genericrotationsensor::id))
                 QSensorManager::registerBackend(QRotationSensor::sensorType, genericrotationsensor::id, this);
 #endif
+#ifdef QTSENSORS_GENERICFUSIONROTATIONSENSOR
+            // Registered after generic.rotation so that it replaces it as the
+            // default rotation backend when there is a gyroscope
+            if (!QSensor::defaultSensorForType(QGyroscope::sensorType).isEmpty()) {
+                if (!QSensorManager::isBackendRegistered(QRotationSensor::sensorType, GenericFusionRotationSensor::id))
+                    QSensorManager::registerBackend(QRotationSensor::sensorType, GenericFusionRotationSensor::id, this);
+            } else {
+                if (QSensorManager::isBackendRegistered(QRotationSensor::sensorType, GenericFusionRotationSensor::id))
+                    QSensorManager::unregisterBackend(QRotationSensor::sensorType, GenericFusionRotationSensor::id);
+            }
+#endif
 #ifdef QTSENSORS_GENERICTILTSENSOR
             if (!QSensorManager::isBackendRegistered(QTiltSensor::sensorType, GenericTiltSensor::id))
                 QSensorManager::registerBackend(QTiltSensor::sensorType, GenericTiltSensor::id, this);
@@ -55,12 +72,27 @@ public:
             if (QSensorManager::isBackendRegistered(QRotationSensor::sensorType, genericrotationsensor::id))
                 QSensorManager::unregisterBackend(QRotationSensor::sensorType, genericrotationsensor::id);
 #endif
+#ifdef QTSENSORS_GENERICFUSIONROTATIONSENSOR
+            if (QSensorManager::isBackendRegistered(QRotationSensor::sensorType, GenericFusionRotationSensor::id))
+                QSensorManager::unregisterBackend(QRotationSensor::sensorType, GenericFusionRotationSensor::id);
+#endif
 #ifdef QTSENSORS_GENERICTILTSENSOR
             if (QSensorManager::isBackendRegistered(QTiltSensor::sensorType, GenericTiltSensor::id))
                 QSensorManager::unregisterBackend(QTiltSensor::sensorType, GenericTiltSensor::id);
 #endif
         }
 
+#ifdef QTSENSORS_GENERICCOMPASS
+        if (!QSensor::defaultSensorForType(QAccelerometer::sensorType).isEmpty()
+                && !QSensor::defaultSensorForType(QMagnetometer::sensorType).isEmpty()) {
+            if (!QSensorManager::isBackendRegistered(QCompass::sensorType, GenericCompass::id))
+                QSensorManager::registerBackend(QCompass::sensorType, GenericCompass::id, this);
+        } else {
+            if (QSensorManager::isBackendRegistered(QCompass::sensorType, GenericCompass::id))
+                QSensorManager::unregisterBackend(QCompass::sensorType, GenericCompass::id);
+        }
+#endif
+
         if (!QSensor::defaultSensorForType(QLightSensor::sensorType).isEmpty()) {
 #ifdef QTSENSORS_GENERICALSSENSOR
             if (!QSensorManager::isBackendRegistered(QAmbientLightSensor::sensorType, genericalssensor::id))
@@ -84,6 +116,10 @@ public:
         if (sensor->identifier() == genericrotationsensor::id)
             return new genericrotationsensor(sensor);
 #endif
+#ifdef QTSENSORS_GENERICFUSIONROTATIONSENSOR
+        if (sensor->identifier() == GenericFusionRotationSensor::id)
+            return new GenericFusionRotationSensor(sensor);
+#endif
 #ifdef QTSENSORS_GENERICALSSENSOR
         if (sensor->identifier() == genericalssensor::id)
             return new genericalssensor(sensor);
@@ -92,6 +128,10 @@ public:
         if (sensor->identifier() == GenericTiltSensor::id)
             return new GenericTiltSensor(sensor);
 #endif
+#ifdef QTSENSORS_GENERICCOMPASS
+        if (sensor->identifier() == GenericCompass::id)
+            return new GenericCompass(sensor);
+#endif
 
         return 0;
     }
@@ -0,0 +1,91 @@
+// Copyright (C) 2022 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "replaysensor.h"
+#include <QtSensors/qsensorplugin.h>
+#include <QtSensors/qsensorbackend.h>
+#include <QtSensors/qsensormanager.h>
+#include <QFile>
+#include <QDebug>
+
+/*
+    Replays a recording written by QSensorRecorder. Every recorded stream
+    becomes a backend called "replay.<stream number>" of the matching
+    sensor type.
+
+    QT_SENSORS_REPLAY_FILE   the recording, nothing is registered without it
+    QT_SENSORS_REPLAY_SPEED  1 (default) replays in real time, 2 twice as
+                             fast and so on, 0 as fast as possible
+    QT_SENSORS_REPLAY_LOOP   1 starts over at the end of the recording
+*/
+class replaySensorPlugin : public QObject, public QSensorPluginInterface, public QSensorBackendFactory
+{
+    Q_OBJECT
+    Q_PLUGIN_METADATA(IID "com.qt-project.Qt.QSensorPluginInterface/1.0" FILE "plugin.json")
+    Q_INTERFACES(QSensorPluginInterface)
+public:
+    void registerSensors() override
+    {
+        const QString fileName = qEnvironmentVariable("QT_SENSORS_REPLAY_FILE");
+        if (fileName.isEmpty())
+            return;
+
+        m_file.setFileName(fileName);
+        if (!m_file.open(QIODevice::ReadOnly)) {
+            qWarning() << "replay: cannot open" << fileName << m_file.errorString();
+            return;
+        }
+        m_size = m_file.size();
+        m_data = reinterpret_cast<const char *>(m_file.map(0, m_size));
+        if (!m_data) {
+            // Not every file system supports mapping
+            m_contents = m_file.readAll();
+            m_data = m_contents.constData();
+            m_size = m_contents.size();
+        }
+
+        QSensorRecordingReader reader(m_data, m_size);
+        if (!reader.isValid()) {
+            qWarning() << "replay:" << fileName << "is not a sensor recording";
+            return;
+        }
+
+        bool ok = false;
+        m_speed = qEnvironmentVariable("QT_SENSORS_REPLAY_SPEED").toDouble(&ok);
+        if (!ok || m_speed < 0)
+            m_speed = 1;
+        m_loop = qEnvironmentVariableIntValue("QT_SENSORS_REPLAY_LOOP") != 0;
+
+        for (int i = 0; i < reader.streams().size(); ++i) {
+            const QSensorRecordingStream &stream = reader.streams().at(i);
+            const char *type = ReplaySensor::sensorTypeForReading(stream.readingType);
+            if (!type || !stream.layout) {
+                qWarning() << "replay: cannot replay readings of type" << stream.readingType;
+                continue;
+            }
+            QSensorManager::registerBackend(type, ReplaySensor::idPrefix + QByteArray::number(i), this);
+        }
+    }
+
+    QSensorBackend *createBackend(QSensor *sensor) override
+    {
+        const QByteArray id = sensor->identifier();
+        if (!id.startsWith(ReplaySensor::idPrefix))
+            return 0;
+        bool ok = false;
+        const int stream = id.mid(qstrlen(ReplaySensor::idPrefix)).toInt(&ok);
+        if (!ok)
+            return 0;
+        return new ReplaySensor(sensor, m_data, m_size, stream, m_speed, m_loop);
+    }
+
+private:
+    QFile m_file;
+    QByteArray m_contents;
+    const char *m_data = nullptr;
+    qsizetype m_size = 0;
+    qreal m_speed = 1;
+    bool m_loop = false;
+};
+
+#include "main.moc"
@@ -0,0 +1,185 @@
+// Copyright (C) 2022 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "replaysensor.h"
+
+#include <QtSensors/qaccelerometer.h>
+#include <QtSensors/qambientlightsensor.h>
+#include <QtSensors/qambienttemperaturesensor.h>
+#include <QtSensors/qcompass.h>
+#include <QtSensors/qgyroscope.h>
+#include <QtSensors/qhumiditysensor.h>
+#include <QtSensors/qirproximitysensor.h>
+#include <QtSensors/qlidsensor.h>
+#include <QtSensors/qlightsensor.h>
+#include <QtSensors/qmagnetometer.h>
+#include <QtSensors/qorientationsensor.h>
+#include <QtSensors/qpressuresensor.h>
+#include <QtSensors/qproximitysensor.h>
+#include <QtSensors/qrotationsensor.h>
+#include <QtSensors/qtapsensor.h>
+#include <QtSensors/qtiltsensor.h>
+#include <QtCore/QTimerEvent>
+
+#include <limits>
+
+char const * const ReplaySensor::idPrefix("replay.");
+
+// Readings handed out per event loop pass when replaying as fast as possible
+static const int burstSize = 256;
+
+namespace {
+struct ReplayType
+{
+    const char *readingType;
+    const char *sensorType;
+    void (*setup)(QSensorBackend *backend);
+};
+
+template <typename T>
+void setupReading(QSensorBackend *backend)
+{
+    backend->setReading<T>(nullptr);
+}
+
+const ReplayType *replayType(const QByteArray &readingType)
+{
+    static const ReplayType types[] = {
+        { "QAccelerometerReading", QAccelerometer::sensorType, &setupReading<QAccelerometerReading> },
+        { "QAmbientLightReading", QAmbientLightSensor::sensorType, &setupReading<QAmbientLightReading> },
+        { "QAmbientTemperatureReading", QAmbientTemperatureSensor::sensorType, &setupReading<QAmbientTemperatureReading> },
+        { "QCompassReading", QCompass::sensorType, &setupReading<QCompassReading> },
+        { "QGyroscopeReading", QGyroscope::sensorType, &setupReading<QGyroscopeReading> },
+        { "QHumidityReading", QHumiditySensor::sensorType, &setupReading<QHumidityReading> },
+        { "QIRProximityReading", QIRProximitySensor::sensorType, &setupReading<QIRProximityReading> },
+        { "QLidReading", QLidSensor::sensorType, &setupReading<QLidReading> },
+        { "QLightReading", QLightSensor::sensorType, &setupReading<QLightReading> },
+        { "QMagnetometerReading", QMagnetometer::sensorType, &setupReading<QMagnetometerReading> },
+        { "QOrientationReading", QOrientationSensor::sensorType, &setupReading<QOrientationReading> },
+        { "QPressureReading", QPressureSensor::sensorType, &setupReading<QPressureReading> },
+        { "QProximityReading", QProximitySensor::sensorType, &setupReading<QProximityReading> },
+        { "QRotationReading", QRotationSensor::sensorType, &setupReading<QRotationReading> },
+        { "QTapReading", QTapSensor::sensorType, &setupReading<QTapReading> },
+        { "QTiltReading", QTiltSensor::sensorType, &setupReading<QTiltReading> },
+    };
+    for (const ReplayType &type : types) {
+        if (readingType == type.readingType)
+            return &type;
+    }
+    return nullptr;
+}
+}
+
+const char *ReplaySensor::sensorTypeForReading(const QByteArray &readingType)
+{
+    const ReplayType *type = replayType(readingType);
+    return type ? type->sensorType : nullptr;
+}
+
+ReplaySensor::ReplaySensor(QSensor *sensor, const char *data, qsizetype size, int stream,
+                           qreal speed, bool loop)
+    : QSensorBackend(sensor)
+    , m_reader(data, size)
+    , m_stream(stream)
+    , m_speed(speed)
+    , m_loop(loop)
+    , m_havePending(false)
+    , m_firstTimestamp(0)
+{
+    const QSensorRecordingStream &recorded = m_reader.streams().at(stream);
+    replayType(recorded.readingType)->setup(this);
+    setDescription(QLatin1String("Replay of ") + QString::fromUtf8(recorded.identifier.isEmpty()
+                                                                  ? recorded.readingType
+                                                                  : recorded.identifier));
+}
+
+void ReplaySensor::start()
+{
+    m_timer.stop();
+    m_reader.rewind();
+    m_havePending = nextRecord();
+    if (!m_havePending)
+        return;
+
+    m_firstTimestamp = m_reader.timestamp();
+    m_clock.start();
+    if (m_speed > 0)
+        deliverDue();
+    else
+        m_timer.start(0, this);
+}
+
+void ReplaySensor::stop()
+{
+    m_timer.stop();
+    m_havePending = false;
+}
+
+void ReplaySensor::timerEvent(QTimerEvent *event)
+{
+    if (event->timerId() != m_timer.timerId())
+        return;
+    if (m_speed > 0)
+        deliverDue();
+    else
+        deliverBurst();
+}
+
+// Moves to the next record of this stream, starting over at the end if looping
+bool ReplaySensor::nextRecord()
+{
+    bool rewound = false;
+    for (;;) {
+        while (m_reader.next()) {
+            if (m_reader.stream() == m_stream) {
+                if (rewound) {
+                    // The recorded timeline starts over as well
+                    m_firstTimestamp = m_reader.timestamp();
+                    m_clock.restart();
+                }
+                return true;
+            }
+        }
+        if (!m_loop || rewound)
+            return false;
+        m_reader.rewind();
+        rewound = true;
+    }
+}
+
+void ReplaySensor::deliverDue()
+{
+    // Readings whose recorded time has come are delivered as one block
+    beginReadingBatch();
+    while (m_havePending) {
+        const qint64 due = qint64(qint64(m_reader.timestamp() - m_firstTimestamp) / m_speed);
+        if (due > m_clock.nsecsElapsed() / 1000)
+            break;
+        m_reader.readReading(reading());
+        newReadingAvailable();
+        m_havePending = nextRecord();
+    }
+    endReadingBatch();
+
+    if (!m_havePending) {
+        m_timer.stop();
+        return;
+    }
+    const qint64 due = qint64(qint64(m_reader.timestamp() - m_firstTimestamp) / m_speed);
+    // Rounded up, a timer that fires early would only find nothing due yet
+    const qint64 wait = (due - m_clock.nsecsElapsed() / 1000 + 999) / 1000;
+    m_timer.start(int(qBound<qint64>(0, wait, std::numeric_limits<int>::max())), Qt::PreciseTimer, this);
+}
+
+void ReplaySensor::deliverBurst()
+{
+    beginReadingBatch();
+    for (int i = 0; i < burstSize && m_havePending; ++i) {
+        m_reader.readReading(reading());
+        newReadingAvailable();
+        m_havePending = nextRecord();
+    }
+    endReadingBatch();
+    if (!m_havePending)
+        m_timer.stop();
+}
@@ -0,0 +1,44 @@
+// Copyright (C) 2022 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef REPLAYSENSOR_H
+#define REPLAYSENSOR_H
+
+#include <QtSensors/qsensorbackend.h>
+#include <QtSensors/private/qsensorrecorder_p.h>
+#include <QtCore/QBasicTimer>
+#include <QtCore/QElapsedTimer>
+
+class ReplaySensor : public QSensorBackend
+{
+public:
+    static char const * const idPrefix;
+
+    // The sensor type that serves readings of the recorded class, or nullptr
+    static const char *sensorTypeForReading(const QByteArray &readingType);
+
+    ReplaySensor(QSensor *sensor, const char *data, qsizetype size, int stream,
+                 qreal speed, bool loop);
+
+    void start() override;
+    void stop() override;
+
+protected:
+    void timerEvent(QTimerEvent *event) override;
+
+private:
+    bool nextRecord();
+    void deliverDue();
+    void deliverBurst();
+
+    QSensorRecordingReader m_reader;
+    int m_stream;
+    qreal m_speed; // 0 means as fast as possible
+    bool m_loop;
+    bool m_havePending;
+    quint64 m_firstTimestamp;
+    QElapsedTimer m_clock;
+    QBasicTimer m_timer;
+};
+
+#endif
@@ -29,9 +29,11 @@ void sensorfwaccelerometer::slotDataAvailable(const XYZ& data)
 
 void sensorfwaccelerometer::slotFrameAvailable(const QList<XYZ> &frame)
 {
+    beginReadingBatch();
     for (int i=0, l=frame.size(); i<l; i++) {
         slotDataAvailable(frame.at(i));
     }
+    endReadingBatch();
 }
 
 bool sensorfwaccelerometer::doConnect()
@@ -30,9 +30,11 @@ void SensorfwGyroscope::slotDataAvailable(const XYZ& data)
 
 void SensorfwGyroscope::slotFrameAvailable(const QList<XYZ> &frame)
 {
+    beginReadingBatch();
     for (int i=0, l=frame.size(); i<l; i++) {
         slotDataAvailable(frame.at(i));
     }
+    endReadingBatch();
 }
 
 bool SensorfwGyroscope::doConnect()
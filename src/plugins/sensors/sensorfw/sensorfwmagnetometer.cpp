@@ -42,9 +42,11 @@ void SensorfwMagnetometer::slotDataAvailable(const MagneticField& data)
 
 void SensorfwMagnetometer::slotFrameAvailable(const QList<MagneticField> &frame)
 {
+    beginReadingBatch();
     for (int i=0, l=frame.size(); i<l; i++) {
         slotDataAvailable(frame.at(i));
     }
+    endReadingBatch();
 }
 
 bool SensorfwMagnetometer::doConnect()
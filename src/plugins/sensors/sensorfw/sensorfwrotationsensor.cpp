@@ -26,9 +26,11 @@ void SensorfwRotationSensor::slotDataAvailable(const XYZ& data)
 
 void SensorfwRotationSensor::slotFrameAvailable(const QList<XYZ> &frame)
 {
+    beginReadingBatch();
     for (int i=0, l=frame.size(); i<l; i++) {
         slotDataAvailable(frame.at(i));
     }
+    endReadingBatch();
 }
 
 bool SensorfwRotationSensor::doConnect()
@@ -0,0 +1,147 @@
+// Copyright (C) 2022 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef QSENSORGESTUREWINDOW_P_H
+#define QSENSORGESTUREWINDOW_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists for the convenience
+// of other Qt classes.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtCore/qglobal.h>
+
+#include <type_traits>
+
+QT_BEGIN_NAMESPACE
+
+// Sliding window over the last Capacity values of a recognizer. Appending to
+// a full window drops the oldest value. Nothing is allocated and appending or
+// removing the oldest value is O(1); for arithmetic types the window also
+// keeps its sum and the candidates for min() and max() up to date, so those
+// are O(1) as well. Index 0 is the oldest value.
+template <typename T, int Capacity>
+class QSensorGestureWindow
+{
+    static_assert(Capacity > 0, "QSensorGestureWindow needs a positive capacity");
+    static constexpr bool HasStatistics = std::is_arithmetic_v<T>;
+
+public:
+    int count() const { return m_count; }
+    int capacity() const { return Capacity; }
+    bool isEmpty() const { return m_count == 0; }
+    bool isFull() const { return m_count == Capacity; }
+
+    const T &at(int i) const
+    {
+        Q_ASSERT(i >= 0 && i < m_count);
+        return m_values[(m_first + size_t(i)) % Capacity];
+    }
+    const T &first() const { return at(0); }
+    const T &last() const { return at(m_count - 1); }
+
+    void clear()
+    {
+        m_first += m_count;
+        m_count = 0;
+        m_sum = 0;
+        m_min.clear();
+        m_max.clear();
+    }
+
+    void append(const T &value)
+    {
+        if (m_count == Capacity)
+            removeFirst();
+        const size_t seq = m_first + m_count;
+        m_values[seq % Capacity] = value;
+        ++m_count;
+        if constexpr (HasStatistics) {
+            m_sum += qreal(value);
+            // Values that are no longer the minimum or maximum of any later
+            // window are dropped, the rest stay ordered by age and value
+            while (!m_min.isEmpty() && !(valueAt(m_min.last()) < value))
+                m_min.removeLast();
+            m_min.append(seq);
+            while (!m_max.isEmpty() && !(value < valueAt(m_max.last())))
+                m_max.removeLast();
+            m_max.append(seq);
+        }
+    }
+
+    void removeFirst()
+    {
+        Q_ASSERT(m_count > 0);
+        if constexpr (HasStatistics) {
+            if (m_min.first() == m_first)
+                m_min.removeFirst();
+            if (m_max.first() == m_first)
+                m_max.removeFirst();
+            m_sum -= qreal(valueAt(m_first));
+        }
+        ++m_first;
+        if (--m_count == 0)
+            m_sum = 0; // do not let rounding errors accumulate
+    }
+
+    // Statistics, only for arithmetic types. The window must not be empty.
+    qreal sum() const
+    {
+        static_assert(HasStatistics, "Statistics need an arithmetic type");
+        return m_sum;
+    }
+    qreal mean() const
+    {
+        static_assert(HasStatistics, "Statistics need an arithmetic type");
+        Q_ASSERT(m_count > 0);
+        return m_sum / m_count;
+    }
+    T min() const
+    {
+        static_assert(HasStatistics, "Statistics need an arithmetic type");
+        return valueAt(m_min.first());
+    }
+    T max() const
+    {
+        static_assert(HasStatistics, "Statistics need an arithmetic type");
+        return valueAt(m_max.first());
+    }
+
+private:
+    // Sequence numbers of the values that can still become min() or max()
+    class SeqQueue
+    {
+    public:
+        bool isEmpty() const { return m_count == 0; }
+        size_t first() const { return m_seqs[m_first]; }
+        size_t last() const { return m_seqs[(m_first + m_count - 1) % Capacity]; }
+        void append(size_t seq) { m_seqs[(m_first + m_count++) % Capacity] = seq; }
+        void removeFirst() { m_first = (m_first + 1) % Capacity; --m_count; }
+        void removeLast() { --m_count; }
+        void clear() { m_first = 0; m_count = 0; }
+
+    private:
+        size_t m_seqs[Capacity];
+        int m_first = 0;
+        int m_count = 0;
+    };
+
+    const T &valueAt(size_t seq) const { return m_values[seq % Capacity]; }
+
+    T m_values[Capacity] = {};
+    size_t m_first = 0; // sequence number of the oldest value
+    int m_count = 0;
+    qreal m_sum = 0;
+    SeqQueue m_min;
+    SeqQueue m_max;
+};
+
+QT_END_NAMESPACE
+
+#endif
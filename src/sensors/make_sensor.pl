@@ -260,9 +260,10 @@ public:
     }
 
     /*
-     * Note that this class is copied so you may need to implement
-     * a copy constructor if you have complex types or pointers
-     * as values.
+     * Note that this class is copied with memcpy semantics (see
+     * QSensorReadingLayout) so it must only hold plain values.
+     * Add the fields to QSensorReadingLayoutRegistry in
+     * qsensorreadinglayout.cpp in the same order as the properties.
      */
 
     qreal myprop;
@@ -453,6 +454,8 @@ QT_END_NAMESPACE
     close OUT;
 }
 
+print "Remember to register the reading layout in qsensorreadinglayout.cpp\n";
+
 exit 0;
 
 
@@ -4,8 +4,18 @@
 #include "qaccelerometer.h"
 #include "qaccelerometer_p.h"
 
+#include <QtCore/qmath.h>
+
 QT_BEGIN_NAMESPACE
 
+// How long, in seconds, the gravity estimate takes to follow a change of
+// the accelerometer readings. Turns of the device are followed right away
+// with a gyroscope, so the estimate can average out more of the movements.
+static const qreal GravityTimeConstant = qreal(0.2);
+static const qreal FusedGravityTimeConstant = qreal(1.0);
+// Gyroscope readings further apart than this are not integrated
+static const quint64 MaxRotationGap = 500000; // microseconds
+
 IMPLEMENT_READING(QAccelerometerReading)
 
 /*!
@@ -197,8 +207,9 @@ QAccelerometer::~QAccelerometer()
     The QAccelerometer::Combined mode is the most accurate one, as it does not involve approximating
     the gravity.
 
-    Not all backends and devices might support setting the acceleration mode. For those cases, the
-    default mode QAccelerometer::Combined is used, changing it has no effect.
+    Not all backends and devices might support setting the acceleration mode. Since Qt 6.5,
+    QtSensors estimates gravity itself for those, by low-pass filtering the readings and, if the
+    device has a gyroscope, turning the estimate along with the device.
 */
 QAccelerometer::AccelerationMode QAccelerometer::accelerationMode() const
 {
@@ -215,6 +226,12 @@ void QAccelerometer::setAccelerationMode(QAccelerometer::AccelerationMode accele
     Q_D(QAccelerometer);
     if (d->accelerationMode != accelerationMode) {
         d->accelerationMode = accelerationMode;
+        if (isActive()) {
+            d->updatePreprocessing();
+            if (d->preprocessing)
+                d->makeCacheCurrent();
+            d->updateGyroscope();
+        }
         emit accelerationModeChanged(d->accelerationMode);
     }
 }
@@ -240,6 +257,142 @@ QAccelerometerReading *QAccelerometer::reading() const
     \since 5.1
 */
 
+/*!
+    \class QGravityEstimator
+    \internal
+
+    Estimates the acceleration caused by gravity from the combined
+    acceleration the accelerometer measures, in constant time and without
+    allocating.
+*/
+void QGravityEstimator::reset()
+{
+    m_hasGravity = false;
+    m_hasRotation = false;
+}
+
+void QGravityEstimator::rotate(qreal x, qreal y, qreal z, quint64 timestamp)
+{
+    const quint64 previous = m_rotationTimestamp;
+    const bool hadRotation = m_hasRotation;
+    m_rotationTimestamp = timestamp;
+    m_hasRotation = true;
+    if (!hadRotation || !m_hasGravity || timestamp <= previous || timestamp - previous > MaxRotationGap)
+        return;
+
+    // Gravity is fixed in the world, so in device coordinates it turns
+    // against the rotation of the device: dg/dt = g x w
+    const qreal dt = qreal(timestamp - previous) / 1000000;
+    const qreal wx = qDegreesToRadians(x) * dt;
+    const qreal wy = qDegreesToRadians(y) * dt;
+    const qreal wz = qDegreesToRadians(z) * dt;
+    const qreal gx = gravity[0];
+    const qreal gy = gravity[1];
+    const qreal gz = gravity[2];
+    gravity[0] += gy * wz - gz * wy;
+    gravity[1] += gz * wx - gx * wz;
+    gravity[2] += gx * wy - gy * wx;
+}
+
+void QGravityEstimator::update(qreal x, qreal y, qreal z, quint64 timestamp)
+{
+    const quint64 previous = m_gravityTimestamp;
+    m_gravityTimestamp = timestamp;
+    if (!m_hasGravity) {
+        gravity[0] = x;
+        gravity[1] = y;
+        gravity[2] = z;
+        m_hasGravity = true;
+        return;
+    }
+    if (timestamp <= previous)
+        return;
+
+    const qreal dt = qreal(timestamp - previous) / 1000000;
+    const qreal timeConstant = m_hasRotation ? FusedGravityTimeConstant : GravityTimeConstant;
+    const qreal alpha = dt / (timeConstant + dt);
+    gravity[0] += alpha * (x - gravity[0]);
+    gravity[1] += alpha * (y - gravity[1]);
+    gravity[2] += alpha * (z - gravity[2]);
+}
+
+bool QAccelerometerPrivate::emulatesFeature(QSensor::Feature feature) const
+{
+    return feature == QSensor::AccelerationMode || QSensorPrivate::emulatesFeature(feature);
+}
+
+void QAccelerometerPrivate::starting()
+{
+    // The backend may deliver readings while it starts
+    gravityEstimator.reset();
+    updatePreprocessing();
+}
+
+void QAccelerometerPrivate::started()
+{
+    updateGyroscope();
+}
+
+void QAccelerometerPrivate::stopped()
+{
+    preprocessing = false;
+    if (gyroscope)
+        gyroscope->stop();
+}
+
+// Separates gravity in the core when the mode needs it and the backend
+// cannot do it itself
+void QAccelerometerPrivate::updatePreprocessing()
+{
+    preprocessing = accelerationMode != QAccelerometer::Combined
+            && !backend->isFeatureSupported(QSensor::AccelerationMode);
+}
+
+// Runs the hidden gyroscope while the accelerometer is active and preprocessing
+void QAccelerometerPrivate::updateGyroscope()
+{
+    Q_Q(QAccelerometer);
+    if (!preprocessing || !active) {
+        if (gyroscope)
+            gyroscope->stop();
+        return;
+    }
+
+    // A gyroscope, where there is one, keeps the estimate right while the
+    // device turns
+    if (!gyroscope && !QSensor::defaultSensorForType(QGyroscope::sensorType).isEmpty()) {
+        gyroscope = new QGyroscope(q);
+        QObject::connect(gyroscope, &QSensor::readingChanged, q, [this] {
+            const QGyroscopeReading *reading = gyroscope->reading();
+            gravityEstimator.rotate(reading->x(), reading->y(), reading->z(), reading->timestamp());
+        });
+    }
+    if (gyroscope) {
+        gyroscope->setDataRate(dataRate);
+        gyroscope->setAlwaysOn(alwaysOn);
+        gyroscope->start();
+    }
+}
+
+void QAccelerometerPrivate::preprocessReading(QSensorReading *reading)
+{
+    QAccelerometerReading *accelerometerReading = static_cast<QAccelerometerReading *>(reading);
+    const qreal x = accelerometerReading->x();
+    const qreal y = accelerometerReading->y();
+    const qreal z = accelerometerReading->z();
+    gravityEstimator.update(x, y, z, accelerometerReading->timestamp());
+    const qreal *gravity = gravityEstimator.gravity;
+    if (accelerationMode == QAccelerometer::Gravity) {
+        accelerometerReading->setX(gravity[0]);
+        accelerometerReading->setY(gravity[1]);
+        accelerometerReading->setZ(gravity[2]);
+    } else {
+        accelerometerReading->setX(x - gravity[0]);
+        accelerometerReading->setY(y - gravity[1]);
+        accelerometerReading->setZ(z - gravity[2]);
+    }
+}
+
 QT_END_NAMESPACE
 
 #include "moc_qaccelerometer.cpp"
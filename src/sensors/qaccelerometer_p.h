@@ -16,6 +16,8 @@
 //
 
 #include "qsensor_p.h"
+#include "qaccelerometer.h"
+#include "qgyroscope.h"
 
 QT_BEGIN_NAMESPACE
 
@@ -34,15 +36,49 @@ public:
     qreal z;
 };
 
+// Separates gravity from the acceleration the user causes for backends
+// that only measure both combined. Gravity is the accelerometer reading
+// low-pass filtered. With gyroscope readings the estimate also turns with
+// the device, so it follows quick turns and is filtered for longer.
+class Q_SENSORS_EXPORT QGravityEstimator
+{
+public:
+    void reset();
+    // Turns the estimate by the rotation rates in degrees per second
+    void rotate(qreal x, qreal y, qreal z, quint64 timestamp);
+    // Moves the estimate towards an accelerometer reading
+    void update(qreal x, qreal y, qreal z, quint64 timestamp);
+
+    qreal gravity[3] = { 0, 0, 0 };
+
+private:
+    bool m_hasGravity = false;
+    bool m_hasRotation = false;
+    quint64 m_gravityTimestamp = 0;
+    quint64 m_rotationTimestamp = 0;
+};
+
 class QAccelerometerPrivate : public QSensorPrivate
 {
+    Q_DECLARE_PUBLIC(QAccelerometer)
 public:
     QAccelerometerPrivate()
         : accelerationMode(QAccelerometer::Combined)
+        , gyroscope(nullptr)
     {
     }
 
+    bool emulatesFeature(QSensor::Feature feature) const override;
+    void starting() override;
+    void started() override;
+    void stopped() override;
+    void preprocessReading(QSensorReading *reading) override;
+    void updatePreprocessing();
+    void updateGyroscope();
+
     QAccelerometer::AccelerationMode accelerationMode;
+    QGravityEstimator gravityEstimator;
+    QGyroscope *gyroscope;
 };
 
 QT_END_NAMESPACE
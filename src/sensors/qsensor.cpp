@@ -5,9 +5,15 @@
 #include "qsensor_p.h"
 #include "qsensorbackend.h"
 #include "qsensormanager.h"
+#include "qsensorreadinglayout_p.h"
+#include <qtsensors_tracepoints_p.h>
 #include <QDebug>
+#include <QDeadlineTimer>
 #include <QMetaProperty>
+#include <QThread>
 #include <QTimer>
+#include <QtCore/qalgorithms.h>
+#include <QtCore/qmath.h>
 
 QT_BEGIN_NAMESPACE
 
@@ -108,6 +114,99 @@ QT_BEGIN_NAMESPACE
     \sa QList, qoutputrange, QSensor::outputRanges
 */
 
+/*!
+    \class QSensorStatistics
+    \inmodule QtSensors
+    \brief The QSensorStatistics class holds what a sensor has delivered.
+    \since 6.5
+
+    The class is defined as a simple struct and returned by
+    QSensor::statistics(). Times are in microseconds.
+
+    \sa QSensor::statistics()
+*/
+
+/*!
+    \variable QSensorStatistics::readingsReceived
+
+    The number of readings the backend reported.
+*/
+
+/*!
+    \variable QSensorStatistics::readingsDelivered
+
+    The number of readings the application was notified about, with
+    QSensor::readingChanged() or in QSensor::readingsAvailable().
+*/
+
+/*!
+    \variable QSensorStatistics::readingsSkipped
+
+    The number of readings skipped as duplicates, see QSensor::skipDuplicates.
+    Backends that skip duplicates themselves do not report them.
+*/
+
+/*!
+    \variable QSensorStatistics::readingsFiltered
+
+    The number of readings filters or batch filters dropped.
+*/
+
+/*!
+    \variable QSensorStatistics::readingsDropped
+
+    The number of readings that were lost on the way from a backend in
+    another thread, because the sensor was stopped or a queue was full.
+
+    \sa QSensor::deliveryPolicy
+*/
+
+/*!
+    \variable QSensorStatistics::readingsCoalesced
+
+    The number of readings of a threaded backend that a newer reading
+    replaced before they were delivered, see QSensor::DeliverLatest.
+*/
+
+/*!
+    \variable QSensorStatistics::rate
+
+    The rate at which the backend reports readings, in Hz.
+*/
+
+/*!
+    \variable QSensorStatistics::meanInterval
+
+    The mean time between two readings the backend reported.
+*/
+
+/*!
+    \variable QSensorStatistics::intervalJitter
+
+    The standard deviation of the time between two readings the backend reported.
+*/
+
+/*!
+    \variable QSensorStatistics::intervalHistogram
+
+    The number of intervals between readings by length. Entry \c i counts
+    the intervals of at least 2 to the power of \c i microseconds and less
+    than twice that, the last entry also counts all longer intervals.
+*/
+
+/*!
+    \variable QSensorStatistics::filterTime
+
+    The time spent in filters and batch filters.
+*/
+
+/*!
+    \variable QSensorStatistics::handlerTime
+
+    The time spent in the slots connected to QSensor::readingChanged() and
+    QSensor::readingsAvailable(), when they are called directly.
+*/
+
 static void registerTypes()
 {
     qRegisterMetaType<qrange>("qrange");
@@ -125,6 +224,444 @@ void QSensorPrivate::init(const QByteArray &sensorType)
     q->registerInstance(); // so the availableSensorsChanged() signal works
 }
 
+void QSensorPrivate::appendToBatch(QSensorReading *reading)
+{
+    const qsizetype index = batch.size();
+    if (index == batchPool.size())
+        batchPool.append(readingFactory(backendThread ? static_cast<QObject *>(q_func()) : backend));
+    QSensorReading *slot = batchPool.at(index);
+    slot->copyValuesFrom(reading);
+    batch.append(slot);
+}
+
+void QSensorPrivate::flushBatch()
+{
+    Q_Q(QSensor);
+    if (!batchFilters.isEmpty()) {
+        const qint64 filterStart = statistics.startTiming();
+        const qsizetype size = batch.size();
+        for (QSensorBatchFilter *filter : std::as_const(batchFilters)) {
+            if (!filter->filter(batch)) {
+                batch.clear();
+                break;
+            }
+        }
+        QSensorStatisticsCounters::add(statistics.filtered, size - batch.size());
+        QSensorStatisticsCounters::addTime(statistics.filterTime, filterStart);
+    }
+    if (batch.isEmpty())
+        return;
+
+    // reading() reflects the newest reading of the batch
+    publishReading(batch.constLast());
+
+    QSensorStatisticsCounters::add(statistics.delivered, batch.size());
+    const qint64 handlerStart = statistics.startTiming();
+    Q_TRACE(QSensor_readingsAvailable_entry, q, int(batch.size()), batch.constLast()->timestamp());
+    Q_EMIT q->readingsAvailable(batch);
+    Q_EMIT q->readingChanged();
+    Q_TRACE(QSensor_readingsAvailable_exit, q);
+    QSensorStatisticsCounters::addTime(statistics.handlerTime, handlerStart);
+    batch.clear();
+}
+
+// Counts the reading as delivered and the time its handlers take
+void QSensorPrivate::emitReadingChanged(const QSensorReading *reading)
+{
+    Q_Q(QSensor);
+    QSensorStatisticsCounters::add(statistics.delivered, 1);
+    const qint64 handlerStart = statistics.startTiming();
+    Q_TRACE(QSensor_readingChanged_entry, q, reading->timestamp());
+    Q_EMIT q->readingChanged();
+    Q_TRACE(QSensor_readingChanged_exit, q);
+    QSensorStatisticsCounters::addTime(statistics.handlerTime, handlerStart);
+}
+
+void QSensorPrivate::processDeviceReading()
+{
+    QSensorReading *reading = device_reading;
+    if (preprocessing || translatingTimestamps) {
+        filter_reading->copyValuesFrom(device_reading);
+        // Readings of a threaded backend arrive late, which only matters
+        // if none of them arrives quickly
+        if (translatingTimestamps) {
+            filter_reading->setTimestamp(timestampTranslator.translate(
+                    device_reading->timestamp(), QSensorTimestampTranslator::now()));
+        }
+        if (preprocessing)
+            preprocessReading(filter_reading);
+        reading = filter_reading;
+    }
+    if (skippingDuplicates && isDuplicate(reading)) {
+        Q_TRACE(QSensor_duplicateSkipped, q_func(), reading->timestamp());
+        QSensorStatisticsCounters::add(statistics.skipped, 1);
+        return;
+    }
+
+    if (filters.isEmpty()) {
+        if (isBatching()) {
+            appendToBatch(reading);
+            if (!explicitBatch && batch.size() >= batchSize)
+                flushBatch();
+            return;
+        }
+        // Nothing can modify or suppress the reading so skip the filter reading.
+        // In zero-copy mode the device reading itself is what reading() returns.
+        publishReading(reading);
+        emitReadingChanged(reading);
+        return;
+    }
+
+    // Copy the values from the device reading to the filter reading
+    if (reading != filter_reading)
+        filter_reading->copyValuesFrom(device_reading);
+
+    const qint64 filterStart = statistics.startTiming();
+    Q_TRACE(QSensor_filters_entry, q_func(), filter_reading->timestamp());
+    bool accepted = true;
+    for (QFilterList::const_iterator it = filters.constBegin(); accepted && it != filters.constEnd(); ++it) {
+        QSensorFilter *filter = (*it);
+        accepted = filter->filter(filter_reading);
+    }
+    Q_TRACE(QSensor_filters_exit, q_func(), accepted);
+    QSensorStatisticsCounters::addTime(statistics.filterTime, filterStart);
+    if (!accepted) {
+        QSensorStatisticsCounters::add(statistics.filtered, 1);
+        return;
+    }
+
+    if (isBatching()) {
+        appendToBatch(filter_reading);
+        if (!explicitBatch && batch.size() >= batchSize)
+            flushBatch();
+        return;
+    }
+
+    // Copy the values from the filter reading to the cached reading
+    publishReading(filter_reading);
+
+    emitReadingChanged(filter_reading);
+}
+
+// Makes reading() and latestSnapshot() return the values of a reading that
+// is about to be delivered
+void QSensorPrivate::publishReading(const QSensorReading *reading)
+{
+    if (publishesDeviceReading()) {
+        cacheIsCurrent = false;
+    } else {
+        cache_reading->copyValuesFrom(reading);
+        cacheIsCurrent = true;
+    }
+    publishSnapshot(reading);
+}
+
+qint64 QSensorStatisticsCounters::now()
+{
+    return QDeadlineTimer::current().deadlineNSecs();
+}
+
+void QSensorStatisticsCounters::readingArrived()
+{
+    add(received, 1);
+    if (!timing.load(std::memory_order_relaxed))
+        return;
+    const qint64 arrival = now();
+    const qint64 last = lastArrival.exchange(arrival, std::memory_order_relaxed);
+    if (last <= 0 || arrival < last)
+        return;
+
+    // Only the backend's thread writes the sums
+    const double interval = double(arrival - last) / 1000;
+    add(intervalCount, 1);
+    intervalSum.store(intervalSum.load(std::memory_order_relaxed) + interval,
+                      std::memory_order_relaxed);
+    intervalSumSquares.store(intervalSumSquares.load(std::memory_order_relaxed) + interval * interval,
+                             std::memory_order_relaxed);
+    const quint64 microseconds = quint64(interval);
+    const int bucket = microseconds ? 63 - qCountLeadingZeroBits(microseconds) : 0;
+    add(intervalHistogram[qMin(bucket, int(QSensorStatistics::HistogramSize) - 1)], 1);
+}
+
+void QSensorStatisticsCounters::reset()
+{
+    for (std::atomic<quint64> *counter : { &received, &delivered, &skipped, &filtered, &dropped,
+                                           &coalesced, &intervalCount, &filterTime,
+                                           &handlerTime })
+        counter->store(0, std::memory_order_relaxed);
+    for (std::atomic<quint64> &count : intervalHistogram)
+        count.store(0, std::memory_order_relaxed);
+    lastArrival.store(0, std::memory_order_relaxed);
+    intervalSum.store(0, std::memory_order_relaxed);
+    intervalSumSquares.store(0, std::memory_order_relaxed);
+}
+
+void QSensorPrivate::publishSnapshot(const QSensorReading *reading)
+{
+    const QSensorReadingLayout *layout = snapshotLayout.load(std::memory_order_relaxed);
+    if (!layout || layout->metaObject() != reading->metaObject()) {
+        layout = QSensorReadingLayout::forReading(reading);
+        if (!layout || layout->sampleSize() > int(SnapshotWords * sizeof(quint64)))
+            return;
+    }
+    quint64 sample[SnapshotWords];
+    layout->read(reading, sample);
+    const int words = (layout->sampleSize() + int(sizeof(quint64)) - 1) / int(sizeof(quint64));
+
+    // Only the sensor thread writes, so the sequence can't change under us
+    const quint32 sequence = snapshotSequence.load(std::memory_order_relaxed);
+    snapshotSequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    snapshotLayout.store(layout, std::memory_order_relaxed);
+    for (int i = 0; i < words; ++i)
+        snapshotSample[i].store(sample[i], std::memory_order_relaxed);
+    snapshotSequence.store(sequence + 2, std::memory_order_release);
+}
+
+bool QSensorPrivate::emulatesFeature(QSensor::Feature feature) const
+{
+    // Readings with a layout can be compared value by value. Some backends
+    // only create their reading when started, the reading types of QtSensors
+    // all have a layout.
+    return feature == QSensor::SkipDuplicates
+            && (!device_reading || QSensorReadingLayout::forReading(device_reading));
+}
+
+void QSensorPrivate::startSkippingDuplicates()
+{
+    skippingDuplicates = skipDuplicates && !backend->isFeatureSupported(QSensor::SkipDuplicates);
+    duplicateLayout = nullptr;
+    hasLastSample = false;
+    duplicateTolerance = skipDuplicatesThreshold;
+    if (duplicateTolerance <= 0 && !outputRanges.isEmpty())
+        duplicateTolerance = outputRanges.at(qBound(0, outputRange, int(outputRanges.size()) - 1)).accuracy;
+}
+
+// Returns true if no value of the reading differs from the last reading
+// that was not skipped by the tolerance of its field or more. Integer and
+// boolean values must be equal.
+bool QSensorPrivate::isDuplicate(const QSensorReading *reading)
+{
+    const QSensorReadingLayout *layout = duplicateLayout;
+    if (!layout) {
+        layout = QSensorReadingLayout::forReading(reading);
+        if (!layout) {
+            skippingDuplicates = false;
+            return false;
+        }
+        const qsizetype size = (layout->sampleSize() + qsizetype(sizeof(quint64)) - 1)
+                / qsizetype(sizeof(quint64));
+        lastSample.resize(size);
+        candidateSample.resize(size);
+        duplicateLayout = layout;
+    }
+    layout->read(reading, candidateSample.data());
+    if (hasLastSample) {
+        bool duplicate = true;
+        for (int i = 0; duplicate && i < layout->fieldCount(); ++i) {
+            const qreal last = layout->value(lastSample.constData(), i);
+            const qreal value = layout->value(candidateSample.constData(), i);
+            const int type = layout->field(i).type;
+            if (type != QMetaType::Double && type != QMetaType::Float) {
+                duplicate = value == last;
+                continue;
+            }
+            const QSensorReadingField &field = layout->field(i);
+            qreal difference = qAbs(value - last);
+            // For angles in degrees, 359 is close to 1
+            if (field.period > 0) {
+                difference = std::fmod(difference, field.period);
+                difference = qMin(difference, field.period - difference);
+            }
+            const qreal tolerance = field.tolerance < 0 ? duplicateTolerance : field.tolerance;
+            duplicate = difference == 0 || difference < tolerance;
+        }
+        if (duplicate)
+            return true;
+    }
+    lastSample.swap(candidateSample);
+    hasLastSample = true;
+    return false;
+}
+
+namespace {
+// The thread shared by all sensors with a threaded backend
+struct QSensorWorker
+{
+    QSensorWorker()
+    {
+        thread.setObjectName(QStringLiteral("QSensorWorker"));
+        context.moveToThread(&thread);
+        thread.start(QThread::HighPriority);
+    }
+    ~QSensorWorker()
+    {
+        thread.quit();
+        thread.wait();
+    }
+
+    QThread thread;
+    QObject context; // receives the calls made through callBackend()
+};
+}
+Q_GLOBAL_STATIC(QSensorWorker, sensorWorker)
+
+QThread *QSensorPrivate::workerThread()
+{
+    return &sensorWorker()->thread;
+}
+
+QObject *QSensorPrivate::workerContext()
+{
+    return &sensorWorker()->context;
+}
+
+bool QSensorPrivate::isWorkerRunning()
+{
+    return !sensorWorker.isDestroyed() && sensorWorker()->thread.isRunning();
+}
+
+void QSensorPrivate::moveBackendToWorkerThread()
+{
+    Q_Q(QSensor);
+    if (backend->parent() || !readingFactory) {
+        qWarning() << "QSensor: the backend" << identifier
+                   << "cannot be moved to the sensor worker thread";
+        return;
+    }
+
+    // A backend that may have to wait for the sensor's thread gets a thread of
+    // its own, waiting in the shared one would hold up the other sensors and
+    // deadlock when the sensor's thread makes a call into any of them
+    QThread *thread = workerThread();
+    if (deliveryPolicy == QSensor::BlockBackend) {
+        ownBackendThread = new QThread;
+        ownBackendThread->setObjectName(QStringLiteral("QSensorBackend ") + QString::fromLatin1(identifier));
+        ownBackendContext = new QObject;
+        ownBackendContext->moveToThread(ownBackendThread);
+        ownBackendThread->start(QThread::HighPriority);
+        thread = ownBackendThread;
+    }
+
+    // Sensors the backend reads from (e.g. for generic backends) move along with it
+    const QList<QSensor *> sources = backend->findChildren<QSensor *>();
+    for (QSensor *source : sources) {
+        QSensorBackend *sourceBackend = source->d_func()->backend;
+        if (sourceBackend && !sourceBackend->parent())
+            sourceBackend->moveToThread(thread);
+    }
+
+    // The backend keeps writing into its own reading, the sensor thread gets
+    // a separate set that is only touched when pending readings are delivered
+    backendReading = device_reading;
+    device_reading = readingFactory(q);
+    filter_reading = readingFactory(q);
+    cache_reading = readingFactory(q);
+    device_reading->copyValuesFrom(backendReading);
+    cache_reading->copyValuesFrom(backendReading);
+
+    backendThread = thread;
+    backend->moveToThread(thread);
+}
+
+// Called in the backend thread
+void QSensorPrivate::queueBackendReading()
+{
+    Q_Q(QSensor);
+    QMutexLocker locker(&pendingMutex);
+    switch (deliveryPolicy) {
+    case QSensor::DeliverAll:
+        break;
+    case QSensor::DeliverLatest:
+        // A delivery is scheduled already
+        if (!pendingReadings.isEmpty()) {
+            pendingReadings.constLast()->copyValuesFrom(backendReading);
+            QSensorStatisticsCounters::add(statistics.coalesced, 1);
+            return;
+        }
+        break;
+    case QSensor::BlockBackend:
+        // Only a backend in a thread of its own may wait, the shared worker
+        // thread must keep serving the other sensors
+        if (ownBackendThread) {
+            while (pendingReadings.size() >= deliveryQueueSize
+                   && !backendCallInProgress.load(std::memory_order_acquire)) {
+                pendingSpace.wait(&pendingMutex);
+            }
+            break;
+        }
+        Q_FALLTHROUGH();
+    case QSensor::DropOldest:
+        if (pendingReadings.size() >= deliveryQueueSize) {
+            pendingPool.append(pendingReadings.takeFirst());
+            QSensorStatisticsCounters::add(statistics.dropped, 1);
+        }
+        break;
+    }
+    QSensorReading *reading = pendingPool.isEmpty() ? readingFactory(nullptr) : pendingPool.takeLast();
+    reading->copyValuesFrom(backendReading);
+    pendingReadings.append(reading);
+    if (deliveryScheduled)
+        return;
+    deliveryScheduled = true;
+    locker.unlock();
+    QMetaObject::invokeMethod(q, [this] { deliverPendingReadings(); }, Qt::QueuedConnection);
+}
+
+void QSensorPrivate::deliverPendingReadings()
+{
+    QList<QSensorReading *> readings;
+    {
+        QMutexLocker locker(&pendingMutex);
+        readings.swap(pendingReadings);
+        deliveryScheduled = false;
+        pendingSpace.wakeAll();
+    }
+
+    // Everything that arrived since the last delivery forms one block
+    if (readings.size() > 1)
+        explicitBatch = true;
+    for (qsizetype i = 0; i < readings.size(); ++i) {
+        // Readings still in flight when the sensor was stopped are dropped
+        if (!active) {
+            QSensorStatisticsCounters::add(statistics.dropped, readings.size() - i);
+            break;
+        }
+        device_reading->copyValuesFrom(readings.at(i));
+        processDeviceReading();
+    }
+    if (explicitBatch) {
+        explicitBatch = false;
+        flushBatch();
+    }
+
+    QMutexLocker locker(&pendingMutex);
+    pendingPool.append(readings);
+}
+
+void QSensorPrivate::destroyBackend()
+{
+    QSensorBackend *oldBackend = backend;
+    backend = nullptr;
+    callBackend([oldBackend] { delete oldBackend; });
+    if (ownBackendThread) {
+        ownBackendThread->quit();
+        ownBackendThread->wait();
+        delete ownBackendContext;
+        delete ownBackendThread;
+        ownBackendContext = nullptr;
+        ownBackendThread = nullptr;
+    }
+    backendThread = nullptr;
+    backendReading = nullptr;
+
+    QMutexLocker locker(&pendingMutex);
+    qDeleteAll(pendingReadings);
+    qDeleteAll(pendingPool);
+    pendingReadings.clear();
+    pendingPool.clear();
+}
+
 /*!
     \class QSensor
     \ingroup sensors_main
@@ -194,7 +731,8 @@ void QSensorPrivate::init(const QByteArray &sensorType)
                     controlled by the QSensor::alwaysOn property.
     \value SkipDuplicates The backend supports skipping of same or very similar successive
                           readings. This can be enabled by setting the QSensor::skipDuplicates
-                          property to true.
+                          property to true. Since Qt 6.5, QtSensors skips duplicates itself
+                          for backends that do not.
 
     The features of QMagnetometer are:
 
@@ -210,6 +748,8 @@ void QSensorPrivate::init(const QByteArray &sensorType)
 
     \value AccelerationMode The backend supports switching the acceleration mode
                             of the acceleromter with the QAccelerometer::accelerationMode property.
+                            Since Qt 6.5, QtSensors separates gravity itself for backends
+                            that do not, so this feature is supported by every accelerometer.
 
     The features of QPressureSensor are:
 
@@ -279,9 +819,10 @@ QSensor::~QSensor()
     stop();
     for (QSensorFilter *filter : d->filters)
         filter->setSensor(0);
-    delete d->backend;
-    d->backend = 0;
-    // owned by the backend
+    for (QSensorBatchFilter *filter : d->batchFilters)
+        filter->setSensor(nullptr);
+    d->destroyBackend();
+    // owned by the backend (or by the sensor for a threaded backend)
     d->device_reading = 0;
     d->filter_reading = 0;
     d->cache_reading = 0;
@@ -363,9 +904,14 @@ bool QSensor::connectToBackend()
     int dataRate = d->dataRate;
     int outputRange = d->outputRange;
 
+    Q_TRACE(QSensorManager_createBackend_entry, d->type, d->identifier);
     d->backend = QSensorManager::createBackend(this);
+    Q_TRACE(QSensorManager_createBackend_exit, d->backend);
 
     if (d->backend) {
+        if (d->threadedBackend)
+            d->moveBackendToWorkerThread();
+
         // Reset the properties to their default values and re-set them now so
         // that the logic we've put into the setters gets called.
         if (dataRate != 0) {
@@ -482,7 +1028,10 @@ bool QSensor::isAlwaysOn() const
     not moved.
 
     Support for this property depends on the backend. Use isFeatureSupported() to check if it is
-    supported on the current platform.
+    supported on the current platform. Since Qt 6.5, readings of backends that do not skip
+    duplicates themselves are compared in QtSensors before the filters run: a reading is skipped
+    when none of its values differs from the last reading that was not skipped by
+    skipDuplicatesThreshold or more.
 
     Duplicate skipping is disabled by default.
 
@@ -563,9 +1112,9 @@ qrangelist QSensor::availableDataRates() const
     notice changes to this value while it is running.
 
     Note that there is no mechanism to determine the current data rate in use by the
-    platform.
+    platform. statistics() reports the rate at which readings actually arrive.
 
-    \sa QSensor::availableDataRates
+    \sa QSensor::availableDataRates, statistics()
 */
 
 int QSensor::dataRate() const
@@ -595,6 +1144,8 @@ void QSensor::setDataRate(int rate)
    or start() will create a connection to the backend.
 
    Backends have to implement QSensorBackend::isFeatureSupported() to make this work.
+   Features that QtSensors implements itself when the backend does not, such as
+   QSensor::AccelerationMode, are supported regardless of the backend.
 
    Returns whether or not the feature is supported if the backend is connected, or false if the backend is not connected.
    \since 5.0
@@ -602,7 +1153,7 @@ void QSensor::setDataRate(int rate)
 bool QSensor::isFeatureSupported(Feature feature) const
 {
     Q_D(const QSensor);
-    return d->backend && d->backend->isFeatureSupported(feature);
+    return d->backend && (d->backend->isFeatureSupported(feature) || d->emulatesFeature(feature));
 }
 
 /*!
@@ -646,8 +1197,25 @@ bool QSensor::start()
     // Set these flags to their defaults
     d->active = true;
     d->busy = false;
+    // Backends that buffer in hardware deliver their own blocks of readings,
+    // for all others the requested buffer size is collected here
+    d->batchSize = 1;
+    if (d->bufferSize > 1 && !d->backend->isFeatureSupported(QSensor::Buffering))
+        d->batchSize = d->bufferSize;
+    d->batch.clear();
+    d->startSkippingDuplicates();
+    d->timestampTranslator.reset();
+    d->translatingTimestamps = d->translateTimestamps;
+    d->starting();
+    if (!d->publishesDeviceReading())
+        d->makeCacheCurrent();
     // Backend will update the flags appropriately
-    d->backend->start();
+    Q_TRACE(QSensorBackend_start_entry, this, d->type, d->identifier);
+    d->callBackend([d] { d->backend->start(); });
+    Q_TRACE(QSensorBackend_start_exit, this, d->active);
+    // A backend that fails to start has reported it with sensorStopped()
+    if (d->active)
+        d->started();
     Q_EMIT activeChanged();
     return isActive();
 }
@@ -665,7 +1233,16 @@ void QSensor::stop()
     if (!isConnectedToBackend() || !isActive())
         return;
     d->active = false;
-    d->backend->stop();
+    Q_TRACE(QSensorBackend_stop_entry, this);
+    d->callBackend([d] { d->backend->stop(); });
+    Q_TRACE(QSensorBackend_stop_exit, this);
+    d->translatingTimestamps = false;
+    // The time the sensor is stopped is not an interval between readings
+    d->statistics.lastArrival.store(0, std::memory_order_relaxed);
+    d->stopped();
+    // A partially filled buffer is not delivered
+    d->batch.clear();
+    d->explicitBatch = false;
     Q_EMIT activeChanged();
 }
 
@@ -689,9 +1266,160 @@ void QSensor::stop()
 QSensorReading *QSensor::reading() const
 {
     Q_D(const QSensor);
-    return d->cache_reading;
+    return d->publishedReading();
+}
+
+/*!
+    \since 6.5
+
+    Copies the values of the latest reading the sensor published into
+    \a reading and returns true. Returns false if the sensor has not
+    published a reading yet or if \a reading is not of the sensor's
+    reading type, for example a QAccelerometerReading for a QAccelerometer.
+
+    Unlike reading(), this function can be called from any thread while
+    the sensor delivers readings. It does not lock or touch the sensor's
+    reading objects: the values are copied from a plain copy of the latest
+    reading that is protected by a sequence lock, and the sensor never waits
+    for callers. A caller that overlaps with a new reading copies again.
+    \a reading must not be used by another thread meanwhile.
+
+    \code
+    // In a worker thread
+    QAccelerometerReading latest;
+    if (accelerometer->latestSnapshot(&latest))
+        integrate(latest.timestamp(), latest.x(), latest.y(), latest.z());
+    \endcode
+
+    \sa reading(), statistics()
+*/
+bool QSensor::latestSnapshot(QSensorReading *reading) const
+{
+    Q_D(const QSensor);
+    if (!reading)
+        return false;
+    quint64 sample[QSensorPrivate::SnapshotWords];
+    const QSensorReadingLayout *layout = nullptr;
+    quint32 sequence;
+    do {
+        sequence = d->snapshotSequence.load(std::memory_order_acquire);
+        if (sequence & 1)
+            continue;
+        layout = d->snapshotLayout.load(std::memory_order_relaxed);
+        if (!layout)
+            return false;
+        const int words = (layout->sampleSize() + int(sizeof(quint64)) - 1) / int(sizeof(quint64));
+        for (int i = 0; i < words; ++i)
+            sample[i] = d->snapshotSample[i].load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+    } while ((sequence & 1) || d->snapshotSequence.load(std::memory_order_relaxed) != sequence);
+
+    if (reading->metaObject() != layout->metaObject())
+        return false;
+    layout->write(reading, sample);
+    return true;
+}
+
+/*!
+    \since 6.5
+
+    Returns what the sensor has actually delivered since it was created or
+    since resetStatistics() was called. Unlike dataRate, which is only the
+    rate that was requested, the rate and the intervals are measured when
+    the backend reports the readings.
+
+    The counters are updated without locks as readings arrive, and this
+    function can be called from any thread. The values are read one by one,
+    so a reading that arrives meanwhile may only be counted in some of them.
+
+    The readings are always counted. The intervals between them and the time
+    spent in filters and handlers are only measured while statisticsTiming
+    is set, so that sensors nobody inspects do not read the clock for every
+    reading.
+
+    \sa QSensorStatistics, resetStatistics(), statisticsTiming
+*/
+QSensorStatistics QSensor::statistics() const
+{
+    Q_D(const QSensor);
+    const QSensorStatisticsCounters &counters = d->statistics;
+    const auto load = [](const auto &counter) { return counter.load(std::memory_order_relaxed); };
+
+    QSensorStatistics statistics;
+    statistics.readingsReceived = load(counters.received);
+    statistics.readingsDelivered = load(counters.delivered);
+    statistics.readingsSkipped = load(counters.skipped);
+    statistics.readingsFiltered = load(counters.filtered);
+    statistics.readingsDropped = load(counters.dropped);
+    statistics.readingsCoalesced = load(counters.coalesced);
+    const quint64 intervals = load(counters.intervalCount);
+    if (intervals > 0) {
+        statistics.meanInterval = load(counters.intervalSum) / intervals;
+        const qreal variance = load(counters.intervalSumSquares) / intervals
+                - statistics.meanInterval * statistics.meanInterval;
+        statistics.intervalJitter = variance > 0 ? qSqrt(variance) : 0;
+        if (statistics.meanInterval > 0)
+            statistics.rate = 1000000 / statistics.meanInterval;
+    }
+    for (int i = 0; i < QSensorStatistics::HistogramSize; ++i)
+        statistics.intervalHistogram[i] = load(counters.intervalHistogram[i]);
+    statistics.filterTime = load(counters.filterTime) / 1000;
+    statistics.handlerTime = load(counters.handlerTime) / 1000;
+    return statistics;
 }
 
+/*!
+    \since 6.5
+
+    Sets all the counters of statistics() back to zero.
+
+    \sa statistics()
+*/
+void QSensor::resetStatistics()
+{
+    Q_D(QSensor);
+    d->statistics.reset();
+}
+
+/*!
+    \property QSensor::statisticsTiming
+    \since 6.5
+    \brief whether statistics() measures intervals and processing times.
+
+    Measuring the intervals between readings and the time spent in filters
+    and handlers reads the clock for every reading, so it is off by default.
+    Readings are counted either way. The property takes effect with the next
+    reading; the first interval is measured from the first reading that
+    arrives after it was set.
+
+    \sa statistics()
+*/
+
+bool QSensor::statisticsTiming() const
+{
+    Q_D(const QSensor);
+    return d->statistics.timing.load(std::memory_order_relaxed);
+}
+
+void QSensor::setStatisticsTiming(bool statisticsTiming)
+{
+    Q_D(QSensor);
+    if (d->statistics.timing.load(std::memory_order_relaxed) == statisticsTiming)
+        return;
+    d->statistics.timing.store(statisticsTiming, std::memory_order_relaxed);
+    // Don't measure the time it was off as an interval
+    if (!statisticsTiming)
+        d->statistics.lastArrival.store(0, std::memory_order_relaxed);
+    emit statisticsTimingChanged(statisticsTiming);
+}
+
+/*!
+    \fn QSensor::statisticsTimingChanged(bool statisticsTiming)
+    \since 6.5
+
+    This signal is emitted when the \a statisticsTiming property changes.
+*/
+
 /*!
     Add a \a filter to the sensor.
 
@@ -708,6 +1436,8 @@ void QSensor::addFilter(QSensorFilter *filter)
         return;
     }
     filter->setSensor(this);
+    // Leaving the zero-copy path, the cache must hold the last published values
+    d->makeCacheCurrent();
     d->filters << filter;
 }
 
@@ -738,6 +1468,73 @@ QList<QSensorFilter*> QSensor::filters() const
     return d->filters;
 }
 
+/*!
+    Add a batch \a filter to the sensor.
+
+    Batch filters are run when a block of readings is delivered, after the
+    per-reading filters. The sensor does not take ownership of the filter.
+    QSensorBatchFilter will inform the sensor if it is destroyed.
+
+    \since 6.5
+    \sa QSensorBatchFilter, readingsAvailable()
+*/
+void QSensor::addBatchFilter(QSensorBatchFilter *filter)
+{
+    Q_D(QSensor);
+    if (!filter) {
+        qWarning() << "addBatchFilter: passed a null filter!";
+        return;
+    }
+    filter->setSensor(this);
+    d->batchFilters << filter;
+}
+
+/*!
+    Remove the batch \a filter from the sensor.
+
+    \since 6.5
+    \sa QSensorBatchFilter
+*/
+void QSensor::removeBatchFilter(QSensorBatchFilter *filter)
+{
+    Q_D(QSensor);
+    if (!filter) {
+        qWarning() << "removeBatchFilter: passed a null filter!";
+        return;
+    }
+    d->batchFilters.removeOne(filter);
+    filter->setSensor(nullptr);
+}
+
+/*!
+    Returns the batch filters currently attached to the sensor.
+
+    \since 6.5
+    \sa QSensorBatchFilter
+*/
+QList<QSensorBatchFilter*> QSensor::batchFilters() const
+{
+    Q_D(const QSensor);
+    return d->batchFilters;
+}
+
+/*!
+    \fn QSensor::readingsAvailable(const QList<QSensorReading *> &readings)
+    \since 6.5
+
+    This signal is emitted when a block of \a readings has been received,
+    either because the backend delivered several readings at once or because
+    the sensor collected bufferSize readings. The readings are in the order
+    they were produced and have already passed all filters.
+
+    The reading objects are reused for the next block, so the values must
+    be processed immediately or saved somewhere else. The readingChanged()
+    signal is emitted once after this signal, with reading() holding the
+    newest reading of the block.
+
+    \sa bufferSize, QSensorBatchFilter
+*/
+
 /*!
     \fn QSensor::readingChanged()
 
@@ -1077,10 +1874,15 @@ void QSensor::setEfficientBufferSize(int efficientBufferSize)
 
     Buffering is turned on when bufferSize is greater than 1. The sensor will collect
     the requested number of samples and deliver them all to the application at one time.
-    They will be delivered to the application as a burst of changed readings so it is
+    They will be delivered to the application with a single readingsAvailable() signal,
+    followed by one readingChanged() signal for the newest reading, so it is
     particularly important that the application processes each reading immediately or
     saves the values somewhere else.
 
+    If the backend does not support the QSensor::Buffering feature, the samples are
+    collected by QSensor itself, so the application still wakes up only once per
+    buffer.
+
     If stop() is called when buffering is on-going, the partial buffer is not delivered.
 
     When the sensor is started with buffering option, values are collected from that
@@ -1110,6 +1912,379 @@ void QSensor::setBufferSize(int bufferSize)
     }
 }
 
+/*!
+    \property QSensor::zeroCopyReadings
+    \since 6.5
+    \brief Indicates whether readings are published without being copied.
+
+    By default every new reading is copied out of the backend into a cache
+    reading before readingChanged() is emitted, so the object returned by
+    reading() only changes when the signal is emitted.
+
+    When this property is set to true and no filters are attached to the
+    sensor, reading() returns the backend's own reading object and
+    readingChanged() is emitted without copying any values. This removes the
+    per-reading copy cost for high-rate sensors. The reading object must then
+    be treated as volatile: the backend may update it while preparing the next
+    reading, so values should only be read in response to readingChanged().
+
+    As soon as a filter is added the sensor falls back to the copying
+    behavior, so filters always see a private copy of the reading and
+    suppressed readings never become visible. When the last filter is
+    removed or the sensor is stopped, reading() keeps returning the copy
+    until the next reading is published without one.
+
+    The default is false.
+
+    \sa reading(), addFilter()
+*/
+
+bool QSensor::zeroCopyReadings() const
+{
+    Q_D(const QSensor);
+    return d->zeroCopyReadings;
+}
+
+void QSensor::setZeroCopyReadings(bool zeroCopyReadings)
+{
+    Q_D(QSensor);
+    if (d->zeroCopyReadings == zeroCopyReadings)
+        return;
+    // Keep reading() stable when the cache takes over again
+    if (!zeroCopyReadings)
+        d->makeCacheCurrent();
+    d->zeroCopyReadings = zeroCopyReadings;
+    emit zeroCopyReadingsChanged(zeroCopyReadings);
+}
+
+/*!
+    \fn QSensor::zeroCopyReadingsChanged(bool zeroCopyReadings)
+    \since 6.5
+
+    This signal is emitted when the \a zeroCopyReadings property changes.
+*/
+
+/*!
+    \property QSensor::threadedBackend
+    \since 6.5
+    \brief Indicates whether the backend runs in the shared sensor worker thread.
+
+    By default a backend lives in the thread of its QSensor, usually the GUI
+    thread. A busy event loop in that thread then delays or drops samples, and
+    backends that block while starting stall the application.
+
+    When this property is set to true the backend is moved to a worker
+    thread that is shared by all sensors using this mode, or to a thread of
+    its own with the BlockBackend deliveryPolicy. The backend
+    acquires and timestamps its samples there, independent of the
+    application's event loop. Readings are copied and marshalled back to
+    the sensor's thread, where they pass the filters and are published as
+    usual. When several readings arrived since the last delivery they are
+    handed out together through readingsAvailable(), followed by a single
+    readingChanged() signal. start() and stop() wait for the backend to
+    handle the call. deliveryPolicy controls what happens to the readings
+    while the sensor's thread is busy.
+
+    Signals that the backend causes the sensor to emit while starting, such
+    as busyChanged(), are emitted from the worker thread. Connections with
+    the default connection type are queued to the receiver's thread.
+
+    This property must be set before the sensor connects to a backend.
+    Backends that were created with a parent object cannot be moved and
+    stay in the sensor's thread.
+
+    The default is false.
+
+    \sa readingsAvailable(), connectToBackend(), deliveryPolicy
+*/
+
+bool QSensor::threadedBackend() const
+{
+    Q_D(const QSensor);
+    return d->threadedBackend;
+}
+
+void QSensor::setThreadedBackend(bool threadedBackend)
+{
+    Q_D(QSensor);
+    if (isConnectedToBackend()) {
+        qWarning() << "ERROR: Cannot call QSensor::setThreadedBackend while connected to a backend!";
+        return;
+    }
+    if (d->threadedBackend == threadedBackend)
+        return;
+    d->threadedBackend = threadedBackend;
+    emit threadedBackendChanged(threadedBackend);
+}
+
+/*!
+    \fn QSensor::threadedBackendChanged(bool threadedBackend)
+    \since 6.5
+
+    This signal is emitted when the \a threadedBackend property changes.
+*/
+
+/*!
+    \property QSensor::sharedBackend
+    \since 6.5
+    \brief Indicates whether the sensor shares its backend with other sensors.
+
+    When this property is set to true, the sensor shares one backend with
+    the other sensors of the same type and identifier that live in the same
+    thread and set it too. The backend runs while any of them is active, at
+    the highest data rate any of them requested, and each reading is
+    delivered to every active sensor. A sensor that requested a lower data
+    rate receives readings at its own rate, each one averaged over the
+    readings it replaces. Each sensor still applies its own filters and
+    settings. This is useful when several parts of an application observe
+    the same hardware sensor.
+
+    This property must be set before the sensor connects to a backend.
+    A sensor with a threadedBackend does not share its backend.
+
+    The default is false.
+
+    \sa connectToBackend(), threadedBackend
+*/
+
+bool QSensor::sharedBackend() const
+{
+    Q_D(const QSensor);
+    return d->sharedBackend;
+}
+
+void QSensor::setSharedBackend(bool sharedBackend)
+{
+    Q_D(QSensor);
+    if (isConnectedToBackend()) {
+        qWarning() << "ERROR: Cannot call QSensor::setSharedBackend while connected to a backend!";
+        return;
+    }
+    if (d->sharedBackend == sharedBackend)
+        return;
+    d->sharedBackend = sharedBackend;
+    emit sharedBackendChanged(sharedBackend);
+}
+
+/*!
+    \fn QSensor::sharedBackendChanged(bool sharedBackend)
+    \since 6.5
+
+    This signal is emitted when the \a sharedBackend property changes.
+*/
+
+/*!
+    \property QSensor::skipDuplicatesThreshold
+    \since 6.5
+    \brief the difference below which a value counts as a duplicate.
+
+    When QtSensors skips duplicate readings for a backend that does not
+    skip them itself, a reading is a duplicate if none of its values
+    differs from the last reading that was not skipped by this threshold or
+    more. The values that are not floating point numbers must be equal.
+
+    The threshold is in the unit of the sensor's main values, like degrees
+    for the azimuth of a QCompassReading. Values in another unit, like the
+    calibration level, count as changed whenever they differ. Angles are
+    compared the short way around the circle, so 359.5 and 0.2 degrees are
+    0.7 degrees apart.
+
+    The default is 0, which uses the accuracy of the current output range,
+    or skips only readings with exactly the same values if the backend
+    does not report output ranges.
+
+    Like skipDuplicates, the threshold takes effect when the sensor is started.
+
+    \sa skipDuplicates, outputRanges
+*/
+
+qreal QSensor::skipDuplicatesThreshold() const
+{
+    Q_D(const QSensor);
+    return d->skipDuplicatesThreshold;
+}
+
+void QSensor::setSkipDuplicatesThreshold(qreal threshold)
+{
+    Q_D(QSensor);
+    if (d->skipDuplicatesThreshold == threshold)
+        return;
+    d->skipDuplicatesThreshold = threshold;
+    emit skipDuplicatesThresholdChanged(threshold);
+}
+
+/*!
+    \fn QSensor::skipDuplicatesThresholdChanged(qreal threshold)
+    \since 6.5
+
+    This signal is emitted when the \a threshold property changes.
+*/
+
+/*!
+    \property QSensor::translateTimestamps
+    \since 6.5
+    \brief whether reading timestamps are translated to a common clock.
+
+    Backends stamp readings with the clock of the platform API they use,
+    which may not be related to the clocks of other backends or to the
+    clocks the application can read. If this property is true, the
+    timestamps of the readings are translated to microseconds of the steady
+    clock that QDeadlineTimer and QElapsedTimer use, so that the readings
+    of different sensors can be compared with each other and with
+    QDeadlineTimer::current().
+
+    The offset and the drift between the clock of the backend and the
+    steady clock are estimated from the times the readings arrive, as they
+    arrive. The first timestamps can be off by the latency of the first
+    readings, the estimate improves over the first seconds. A reading is
+    never stamped after the time it arrived. If the clock of the backend
+    jumps, for example when the device was suspended, the estimate starts
+    over.
+
+    The property is false by default and takes effect when the sensor is
+    started.
+
+    \sa QSensorReading::timestamp
+*/
+
+bool QSensor::translateTimestamps() const
+{
+    Q_D(const QSensor);
+    return d->translateTimestamps;
+}
+
+void QSensor::setTranslateTimestamps(bool translateTimestamps)
+{
+    Q_D(QSensor);
+    if (d->translateTimestamps == translateTimestamps)
+        return;
+    d->translateTimestamps = translateTimestamps;
+    emit translateTimestampsChanged(translateTimestamps);
+}
+
+/*!
+    \fn QSensor::translateTimestampsChanged(bool translateTimestamps)
+    \since 6.5
+
+    This signal is emitted when the \a translateTimestamps property changes.
+*/
+
+/*!
+    \enum QSensor::DeliveryPolicy
+    \since 6.5
+
+    This enum describes what happens to the readings of a threaded backend
+    while the sensor's thread is busy, for example in a slow slot connected
+    to readingChanged().
+
+    \value DeliverAll    All readings are queued and delivered. The queue is not bounded.
+    \value DeliverLatest Only the newest reading is delivered, it replaces the readings
+                         that were not delivered yet. This suits a user interface that
+                         shows the current value.
+    \value DropOldest    At most deliveryQueueSize readings are queued, the oldest one is
+                         dropped to make room for a new one.
+    \value BlockBackend  At most deliveryQueueSize readings are queued, the backend waits
+                         until there is room for a new one. No reading is lost in the
+                         core, which suits recording, but a backend that receives
+                         readings from elsewhere may lose them while it waits. The
+                         backend runs in a thread of its own while it may wait.
+
+    \sa deliveryPolicy, statistics()
+*/
+
+/*!
+    \property QSensor::deliveryPolicy
+    \since 6.5
+    \brief what happens to readings the sensor's thread cannot keep up with.
+
+    The policy applies to readings that a threaded backend hands over to the
+    sensor's thread, see threadedBackend. Other backends report their
+    readings in the sensor's thread, where a slow slot delays the backend.
+
+    The readings that were replaced or dropped are counted in statistics().
+    The default is DeliverAll.
+
+    A threaded backend of a sensor that connects with the BlockBackend policy
+    runs in a thread of its own instead of the one shared by the threaded
+    backends, so that its waiting does not hold up the other sensors. If the
+    policy is changed to BlockBackend after the backend was moved to the
+    shared thread, the oldest readings are dropped as with DropOldest.
+
+    \sa deliveryQueueSize
+*/
+
+QSensor::DeliveryPolicy QSensor::deliveryPolicy() const
+{
+    Q_D(const QSensor);
+    QMutexLocker locker(&d->pendingMutex);
+    return d->deliveryPolicy;
+}
+
+void QSensor::setDeliveryPolicy(QSensor::DeliveryPolicy policy)
+{
+    Q_D(QSensor);
+    {
+        QMutexLocker locker(&d->pendingMutex);
+        if (d->deliveryPolicy == policy)
+            return;
+        d->deliveryPolicy = policy;
+        d->pendingSpace.wakeAll();
+    }
+    if (policy == BlockBackend && d->backendThread && !d->ownBackendThread) {
+        qWarning() << "QSensor::setDeliveryPolicy: the backend" << d->identifier
+                   << "shares its thread and cannot be blocked, readings are dropped instead";
+    }
+    emit deliveryPolicyChanged(policy);
+}
+
+/*!
+    \property QSensor::deliveryQueueSize
+    \since 6.5
+    \brief the number of readings queued with the DropOldest and BlockBackend policies.
+
+    The default is 64.
+
+    \sa deliveryPolicy
+*/
+
+int QSensor::deliveryQueueSize() const
+{
+    Q_D(const QSensor);
+    QMutexLocker locker(&d->pendingMutex);
+    return d->deliveryQueueSize;
+}
+
+void QSensor::setDeliveryQueueSize(int size)
+{
+    Q_D(QSensor);
+    if (size < 1) {
+        qWarning() << "setDeliveryQueueSize: invalid size" << size;
+        return;
+    }
+    {
+        QMutexLocker locker(&d->pendingMutex);
+        if (d->deliveryQueueSize == size)
+            return;
+        d->deliveryQueueSize = size;
+        d->pendingSpace.wakeAll();
+    }
+    emit deliveryQueueSizeChanged(size);
+}
+
+/*!
+    \fn QSensor::deliveryPolicyChanged(QSensor::DeliveryPolicy policy)
+    \since 6.5
+
+    This signal is emitted when the \a policy property changes.
+*/
+
+/*!
+    \fn QSensor::deliveryQueueSizeChanged(int size)
+    \since 6.5
+
+    This signal is emitted when the \a size property changes.
+*/
+
 // =====================================================================
 
 /*!
@@ -1177,6 +2352,64 @@ void QSensorFilter::setSensor(QSensor *sensor)
 
 // =====================================================================
 
+/*!
+    \class QSensorBatchFilter
+    \ingroup sensors_main
+    \inmodule QtSensors
+    \since 6.5
+
+    \brief The QSensorBatchFilter class processes a whole block of readings
+           at once.
+
+    When readings are delivered in batches (see QSensor::bufferSize and
+    QSensor::readingsAvailable()), batch filters are called once per block
+    instead of once per reading. This allows a filter to amortize its setup
+    cost over many readings or to run vectorized code over the whole block.
+
+    Batch filters are called in order, after the per-reading QSensorFilter
+    instances have been run.
+
+    \sa filter(), QSensor::addBatchFilter()
+*/
+
+/*!
+    \internal
+*/
+QSensorBatchFilter::QSensorBatchFilter()
+    : m_sensor(nullptr)
+{
+}
+
+/*!
+    Notifies the attached sensor (if any) that the filter is being destroyed.
+*/
+QSensorBatchFilter::~QSensorBatchFilter()
+{
+    if (m_sensor)
+        m_sensor->removeBatchFilter(this);
+}
+
+/*!
+    \fn QSensorBatchFilter::filter(QList<QSensorReading *> &readings)
+
+    This function is called when a block of \a readings is about to be delivered.
+
+    The filter can modify the readings and may remove readings from the list.
+
+    Returns true to allow the next filter to receive the block.
+    Returns false to drop the whole block.
+*/
+
+/*!
+    \internal
+*/
+void QSensorBatchFilter::setSensor(QSensor *sensor)
+{
+    m_sensor = sensor;
+}
+
+// =====================================================================
+
 /*!
     \class QSensorReading
     \ingroup sensors_main
@@ -1213,6 +2446,7 @@ QSensorReading::~QSensorReading()
 
     Note that sensor timestamps from different sensors may not be directly
     comparable (as they may choose different fixed points for their reference).
+    Set QSensor::translateTimestamps to get timestamps of a common clock.
 
     \b{Note that some platforms do not deliver timestamps correctly}.
     Applications should be prepared for occasional issues that cause timestamps to jump
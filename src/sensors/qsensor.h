@@ -18,7 +18,9 @@ class QSensorPrivate;
 class QSensorBackend;
 class QSensorReading;
 class QSensorReadingPrivate;
+class QSensorReadingLayout;
 class QSensorFilter;
+class QSensorBatchFilter;
 
 using qrange = QPair<int,int>;
 using qrangelist = QList<qrange>;
@@ -32,6 +34,24 @@ struct qoutputrange
 
 using qoutputrangelist = QList<qoutputrange>;
 
+struct QSensorStatistics
+{
+    enum { HistogramSize = 24 };
+
+    quint64 readingsReceived = 0;
+    quint64 readingsDelivered = 0;
+    quint64 readingsSkipped = 0;
+    quint64 readingsFiltered = 0;
+    quint64 readingsDropped = 0;
+    quint64 readingsCoalesced = 0;
+    qreal rate = 0;
+    qreal meanInterval = 0;
+    qreal intervalJitter = 0;
+    quint64 intervalHistogram[HistogramSize] = {};
+    quint64 filterTime = 0;
+    quint64 handlerTime = 0;
+};
+
 class Q_SENSORS_EXPORT QSensor : public QObject
 {
     friend class QSensorBackend;
@@ -56,6 +76,14 @@ class Q_SENSORS_EXPORT QSensor : public QObject
     Q_PROPERTY(int maxBufferSize READ maxBufferSize NOTIFY maxBufferSizeChanged)
     Q_PROPERTY(int efficientBufferSize READ efficientBufferSize NOTIFY efficientBufferSizeChanged)
     Q_PROPERTY(int bufferSize READ bufferSize WRITE setBufferSize NOTIFY bufferSizeChanged)
+    Q_PROPERTY(bool zeroCopyReadings READ zeroCopyReadings WRITE setZeroCopyReadings NOTIFY zeroCopyReadingsChanged)
+    Q_PROPERTY(bool threadedBackend READ threadedBackend WRITE setThreadedBackend NOTIFY threadedBackendChanged)
+    Q_PROPERTY(bool sharedBackend READ sharedBackend WRITE setSharedBackend NOTIFY sharedBackendChanged)
+    Q_PROPERTY(qreal skipDuplicatesThreshold READ skipDuplicatesThreshold WRITE setSkipDuplicatesThreshold NOTIFY skipDuplicatesThresholdChanged)
+    Q_PROPERTY(bool translateTimestamps READ translateTimestamps WRITE setTranslateTimestamps NOTIFY translateTimestampsChanged)
+    Q_PROPERTY(DeliveryPolicy deliveryPolicy READ deliveryPolicy WRITE setDeliveryPolicy NOTIFY deliveryPolicyChanged)
+    Q_PROPERTY(int deliveryQueueSize READ deliveryQueueSize WRITE setDeliveryQueueSize NOTIFY deliveryQueueSizeChanged)
+    Q_PROPERTY(bool statisticsTiming READ statisticsTiming WRITE setStatisticsTiming NOTIFY statisticsTimingChanged)
 public:
     enum Feature {
         Buffering,
@@ -78,6 +106,14 @@ public:
     };
     Q_ENUM(AxesOrientationMode)
 
+    enum DeliveryPolicy {
+        DeliverAll,
+        DeliverLatest,
+        DropOldest,
+        BlockBackend
+    };
+    Q_ENUM(DeliveryPolicy)
+
     explicit QSensor(const QByteArray &type, QObject *parent = nullptr);
     virtual ~QSensor();
 
@@ -116,8 +152,21 @@ public:
     void removeFilter(QSensorFilter *filter);
     QList<QSensorFilter*> filters() const;
 
+    // Batch filters see all readings of a batch at once
+    void addBatchFilter(QSensorBatchFilter *filter);
+    void removeBatchFilter(QSensorBatchFilter *filter);
+    QList<QSensorBatchFilter*> batchFilters() const;
+
     // The readings are exposed via this object
     QSensorReading *reading() const;
+    // Copies the latest reading, safe to call from any thread
+    bool latestSnapshot(QSensorReading *reading) const;
+
+    // What the sensor actually delivers, safe to call from any thread
+    QSensorStatistics statistics() const;
+    void resetStatistics();
+    bool statisticsTiming() const;
+    void setStatisticsTiming(bool statisticsTiming);
 
     // Information about available sensors
     // These functions are implemented in qsensormanager.cpp
@@ -145,6 +194,26 @@ public:
     int bufferSize() const;
     void setBufferSize(int bufferSize);
 
+    bool zeroCopyReadings() const;
+    void setZeroCopyReadings(bool zeroCopyReadings);
+
+    bool threadedBackend() const;
+    void setThreadedBackend(bool threadedBackend);
+
+    bool sharedBackend() const;
+    void setSharedBackend(bool sharedBackend);
+
+    qreal skipDuplicatesThreshold() const;
+    void setSkipDuplicatesThreshold(qreal threshold);
+
+    bool translateTimestamps() const;
+    void setTranslateTimestamps(bool translateTimestamps);
+
+    DeliveryPolicy deliveryPolicy() const;
+    void setDeliveryPolicy(DeliveryPolicy policy);
+    int deliveryQueueSize() const;
+    void setDeliveryQueueSize(int size);
+
 public Q_SLOTS:
     // Start receiving values from the sensor
     bool start();
@@ -156,6 +225,7 @@ Q_SIGNALS:
     void busyChanged();
     void activeChanged();
     void readingChanged();
+    void readingsAvailable(const QList<QSensorReading *> &readings);
     void sensorError(int error);
     void availableSensorsChanged();
     void alwaysOnChanged();
@@ -168,6 +238,14 @@ Q_SIGNALS:
     void efficientBufferSizeChanged(int efficientBufferSize);
     void bufferSizeChanged(int bufferSize);
     void identifierChanged();
+    void zeroCopyReadingsChanged(bool zeroCopyReadings);
+    void threadedBackendChanged(bool threadedBackend);
+    void sharedBackendChanged(bool sharedBackend);
+    void skipDuplicatesThresholdChanged(qreal threshold);
+    void translateTimestampsChanged(bool translateTimestamps);
+    void deliveryPolicyChanged(QSensor::DeliveryPolicy policy);
+    void deliveryQueueSizeChanged(int size);
+    void statisticsTimingChanged(bool statisticsTiming);
 
 protected:
     explicit QSensor(const QByteArray &type, QSensorPrivate &dd, QObject* parent = nullptr);
@@ -192,8 +270,22 @@ protected:
     QSensor *m_sensor;
 };
 
+class Q_SENSORS_EXPORT QSensorBatchFilter
+{
+    friend class QSensor;
+public:
+    virtual bool filter(QList<QSensorReading *> &readings) = 0;
+protected:
+    QSensorBatchFilter();
+    virtual ~QSensorBatchFilter();
+    virtual void setSensor(QSensor *sensor);
+    QSensor *m_sensor;
+};
+
 class Q_SENSORS_EXPORT QSensorReading : public QObject
 {
+    friend class QSensor;
+    friend class QSensorPrivate;
     friend class QSensorBackend;
 
     Q_OBJECT
@@ -228,6 +320,7 @@ private:
         virtual ~classname();\
         void copyValuesFrom(QSensorReading *other) override;\
     private:\
+        friend class QT_PREPEND_NAMESPACE(QSensorReadingLayout);\
         QScopedPointer<pclassname> d;
 
 #define IMPLEMENT_READING(classname)\
@@ -16,12 +16,66 @@
 //
 
 #include "qsensor.h"
+#include "qsensorbackend.h"
+#include "qsensortimestamptranslator_p.h"
 
 #include "private/qobject_p.h"
 
+#include <QtCore/qmutex.h>
+#include <QtCore/qthread.h>
+#include <QtCore/qwaitcondition.h>
+#include <QtCore/qvarlengtharray.h>
+
+#include <atomic>
+
 QT_BEGIN_NAMESPACE
 
+class QSensorReadingLayout;
+
+// The counters behind QSensor::statistics(). The arrival counters are
+// updated in the backend's thread, the others in the sensor's thread, and
+// statistics() may read them from any thread. Times are in nanoseconds.
+// The intervals and the time spent in filters and handlers need the clock,
+// so they are only measured while QSensor::statisticsTiming is set.
+struct QSensorStatisticsCounters
+{
+    std::atomic<bool> timing = false;
+    std::atomic<quint64> received = 0;
+    std::atomic<quint64> delivered = 0;
+    std::atomic<quint64> skipped = 0;
+    std::atomic<quint64> filtered = 0;
+    std::atomic<quint64> dropped = 0;
+    std::atomic<quint64> coalesced = 0;
+    std::atomic<qint64> lastArrival = 0;     // 0 after a reset or stop()
+    std::atomic<quint64> intervalCount = 0;
+    std::atomic<double> intervalSum = 0;     // in microseconds
+    std::atomic<double> intervalSumSquares = 0;
+    std::atomic<quint64> intervalHistogram[QSensorStatistics::HistogramSize] = {};
+    std::atomic<quint64> filterTime = 0;
+    std::atomic<quint64> handlerTime = 0;
+
+    static qint64 now();
+    static void add(std::atomic<quint64> &counter, quint64 value)
+    {
+        counter.fetch_add(value, std::memory_order_relaxed);
+    }
+    // 0 while not timing
+    qint64 startTiming() const
+    {
+        return timing.load(std::memory_order_relaxed) ? now() : 0;
+    }
+    static void addTime(std::atomic<quint64> &counter, qint64 start)
+    {
+        if (start)
+            add(counter, now() - start);
+    }
+    void readingArrived();
+    void reset();
+};
+
 typedef QList<QSensorFilter*> QFilterList;
+typedef QList<QSensorBatchFilter*> QBatchFilterList;
+typedef QSensorReading *(*QSensorReadingFactory)(QObject *parent);
 
 class QSensorPrivate : public QObjectPrivate
 {
@@ -38,6 +92,7 @@ public:
         , device_reading(0)
         , filter_reading(0)
         , cache_reading(0)
+        , cacheIsCurrent(true)
         , error(0)
         , alwaysOn(false)
         , skipDuplicates(false)
@@ -47,11 +102,63 @@ public:
         , bufferSize(1)
         , maxBufferSize(1)
         , efficientBufferSize(1)
+        , zeroCopyReadings(false)
+        , readingFactory(nullptr)
+        , batchSize(1)
+        , explicitBatch(false)
+        , preprocessing(false)
+        , skipDuplicatesThreshold(0)
+        , skippingDuplicates(false)
+        , duplicateLayout(nullptr)
+        , duplicateTolerance(0)
+        , hasLastSample(false)
+        , snapshotSequence(0)
+        , snapshotLayout(nullptr)
+        , snapshotSample()
+        , translateTimestamps(false)
+        , translatingTimestamps(false)
+        , sharedBackend(false)
+        , threadedBackend(false)
+        , backendThread(nullptr)
+        , ownBackendThread(nullptr)
+        , ownBackendContext(nullptr)
+        , backendReading(nullptr)
+        , backendCallInProgress(false)
+        , deliveryScheduled(false)
+        , deliveryPolicy(QSensor::DeliverAll)
+        , deliveryQueueSize(DefaultDeliveryQueueSize)
     {
     }
 
     void init(const QByteArray &sensorType);
 
+    static QSensorPrivate *get(QSensor *sensor) { return sensor->d_func(); }
+
+    // Makes the device reading a copy of a reading of another sensor
+    void setDeviceReadingValues(QSensorReading *reading) { device_reading->copyValuesFrom(reading); }
+
+    // The reading that QSensor::reading() hands out. In zero-copy mode the
+    // device reading is published directly as long as no filter needs the
+    // filter/cache double buffer. Once the cache is in use it stays published
+    // until a reading goes through the zero-copy path again, the device
+    // reading may hold values that were never published.
+    QSensorReading *publishedReading() const
+    {
+        return cacheIsCurrent ? cache_reading : device_reading;
+    }
+    bool publishesDeviceReading() const
+    {
+        return zeroCopyReadings && filters.isEmpty() && !preprocessing && !translatingTimestamps;
+    }
+    void publishReading(const QSensorReading *reading);
+    // Called before the zero-copy path is left
+    void makeCacheCurrent()
+    {
+        if (!cacheIsCurrent && device_reading)
+            cache_reading->copyValuesFrom(device_reading);
+        cacheIsCurrent = true;
+    }
+
     // meta-data
     QByteArray identifier;
     QByteArray type;
@@ -72,6 +179,7 @@ public:
     QSensorReading *device_reading;
     QSensorReading *filter_reading;
     QSensorReading *cache_reading;
+    bool cacheIsCurrent; // false while the device reading is published
 
     int error;
 
@@ -85,6 +193,113 @@ public:
     int bufferSize;
     int maxBufferSize;
     int efficientBufferSize;
+
+    bool zeroCopyReadings;
+
+    // batched delivery
+    QBatchFilterList batchFilters;
+    QSensorReadingFactory readingFactory;
+    QList<QSensorReading *> batchPool; // owned by the backend, reused between batches
+    QList<QSensorReading *> batch;     // readings collected for the next readingsAvailable()
+    int batchSize;                     // number of readings the core collects per batch
+    bool explicitBatch;                // the backend is delivering a block of readings
+
+    bool isBatching() const { return readingFactory && (explicitBatch || batchSize > 1); }
+    void appendToBatch(QSensorReading *reading);
+    void flushBatch();
+
+    // Runs the device reading through the filters and publishes it
+    void processDeviceReading();
+
+    // Sensor types that implement a feature in the core when the backend
+    // does not report it override these. While preprocessing is set, each
+    // device reading is copied to the filter reading and preprocessReading()
+    // changes the copy before the filters see it. The backend's reading is
+    // left alone, backends may only update some of its values.
+    // starting() runs before the backend starts, started() once it has
+    // started, and stopped() whenever the sensor stops being active.
+    bool preprocessing;
+    virtual bool emulatesFeature(QSensor::Feature feature) const;
+    virtual void starting() {}
+    virtual void started() {}
+    virtual void stopped() {}
+    virtual void preprocessReading(QSensorReading *) {}
+
+    // duplicate skipping for backends that do not skip duplicates themselves
+    qreal skipDuplicatesThreshold;               // 0 to use the accuracy of the output range
+    bool skippingDuplicates;
+    const QSensorReadingLayout *duplicateLayout; // looked up with the first reading
+    qreal duplicateTolerance;
+    bool hasLastSample;
+    QVarLengthArray<quint64, 16> lastSample;     // of the last reading that was not skipped
+    QVarLengthArray<quint64, 16> candidateSample;
+    void startSkippingDuplicates();
+    bool isDuplicate(const QSensorReading *reading);
+
+    // The latest published reading for latestSnapshot(). A sequence lock:
+    // the sensor thread makes the sequence odd while it writes the sample,
+    // readers in other threads retry if it was odd or changed meanwhile.
+    enum { SnapshotWords = 16 };
+    std::atomic<quint32> snapshotSequence;
+    std::atomic<const QSensorReadingLayout *> snapshotLayout; // null until published
+    std::atomic<quint64> snapshotSample[SnapshotWords];
+    void publishSnapshot(const QSensorReading *reading);
+
+    // Timestamps in the clock of QDeadlineTimer. Like preprocessing, this
+    // works on a copy of the device reading.
+    bool translateTimestamps;                    // requested by the application
+    bool translatingTimestamps;                  // from start() to stop()
+    QSensorTimestampTranslator timestampTranslator;
+
+    QSensorStatisticsCounters statistics;
+    void emitReadingChanged(const QSensorReading *reading);
+
+    bool sharedBackend;                            // see QSharedSensorBackend
+
+    // threaded backend
+    bool threadedBackend;                          // requested by the application
+    QThread *backendThread;                        // set once the backend has been moved there
+    QThread *ownBackendThread;                     // a thread of the sensor's own for BlockBackend
+    QObject *ownBackendContext;                    // receives calls made in ownBackendThread
+    QSensorReading *backendReading;                // the backend's device reading, used in backendThread
+    std::atomic<bool> backendCallInProgress;       // the sensor thread waits for a call into the backend
+    mutable QMutex pendingMutex;
+    QList<QSensorReading *> pendingReadings;       // copied in backendThread, waiting for delivery
+    QList<QSensorReading *> pendingPool;           // recycled pending readings
+    bool deliveryScheduled;                        // guarded by pendingMutex
+    QSensor::DeliveryPolicy deliveryPolicy;        // guarded by pendingMutex
+    int deliveryQueueSize;                         // guarded by pendingMutex
+    QWaitCondition pendingSpace;                   // for BlockBackend
+    enum { DefaultDeliveryQueueSize = 64 };
+
+    static QThread *workerThread();
+    static QObject *workerContext();
+    static bool isWorkerRunning();
+    void moveBackendToWorkerThread();
+    bool isBackendThreadRunning() const { return ownBackendThread || isWorkerRunning(); }
+    void queueBackendReading();
+    void deliverPendingReadings();
+    void destroyBackend();
+
+    // Calls func in the backend's thread and waits for it to return
+    template <typename Func>
+    void callBackend(Func func)
+    {
+        if (!backendThread || QThread::currentThread() == backendThread || !isBackendThreadRunning()) {
+            func();
+            return;
+        }
+        {
+            // A backend waiting for room in the pending readings must not
+            // block the call
+            QMutexLocker locker(&pendingMutex);
+            backendCallInProgress.store(true, std::memory_order_release);
+            pendingSpace.wakeAll();
+        }
+        QMetaObject::invokeMethod(ownBackendContext ? ownBackendContext : workerContext(),
+                                  std::move(func), Qt::BlockingQueuedConnection);
+        backendCallInProgress.store(false, std::memory_order_release);
+    }
 };
 
 class QSensorReadingPrivate
@@ -5,9 +5,20 @@
 #include "qsensorbackend_p.h"
 #include "qsensor_p.h"
 #include <QDebug>
+#include <qtsensors_tracepoints_p.h>
+#include <QThread>
 
 QT_BEGIN_NAMESPACE
 
+// State changes reported by a threaded backend are applied in the sensor's
+// thread, unless that thread is blocked waiting for a call into the backend
+static bool forwardToSensorThread(QSensorPrivate *sensorPrivate)
+{
+    return sensorPrivate->backendThread
+            && QThread::currentThread() == sensorPrivate->backendThread
+            && !sensorPrivate->backendCallInProgress.load(std::memory_order_acquire);
+}
+
 /*!
     \class QSensorBackend
     \ingroup sensors_backend
@@ -57,20 +68,72 @@ void QSensorBackend::newReadingAvailable()
 {
     Q_D(QSensorBackend);
     QSensorPrivate *sensorPrivate = d->m_sensor->d_func();
+    sensorPrivate->statistics.readingArrived();
+    Q_TRACE(QSensorBackend_newReadingAvailable, d->m_sensor,
+            (sensorPrivate->backendThread ? sensorPrivate->backendReading
+                                          : sensorPrivate->device_reading)->timestamp());
+
+    // A threaded backend hands the reading over to the sensor's thread
+    if (sensorPrivate->backendThread) {
+        sensorPrivate->queueBackendReading();
+        return;
+    }
 
-    // Copy the values from the device reading to the filter reading
-    sensorPrivate->filter_reading->copyValuesFrom(sensorPrivate->device_reading);
+    sensorPrivate->processDeviceReading();
+}
 
-    for (QFilterList::const_iterator it = sensorPrivate->filters.constBegin(); it != sensorPrivate->filters.constEnd(); ++it) {
-        QSensorFilter *filter = (*it);
-        if (!filter->filter(sensorPrivate->filter_reading))
-            return;
+/*!
+    \since 6.5
+
+    Notify the QSensor class that the following readings belong to one block.
+
+    Backends that receive several readings at once (for example from a
+    hardware FIFO) should call this function, then fill in the reading and
+    call newReadingAvailable() for each of them, and finally call
+    endReadingBatch(). The readings are run through the filters one by one
+    but delivered to the application with a single
+    QSensor::readingsAvailable() signal.
+
+    \code
+    void MyBackend::frameAvailable(const QList<Sample> &frame)
+    {
+        beginReadingBatch();
+        for (const Sample &sample : frame) {
+            m_reading.setTimestamp(sample.timestamp);
+            m_reading.setX(sample.x);
+            newReadingAvailable();
+        }
+        endReadingBatch();
     }
+    \endcode
+
+    \sa endReadingBatch(), QSensor::bufferSize
+*/
+void QSensorBackend::beginReadingBatch()
+{
+    Q_D(QSensorBackend);
+    QSensorPrivate *sensorPrivate = d->m_sensor->d_func();
+    // Readings of a threaded backend are always delivered in blocks
+    if (sensorPrivate->backendThread)
+        return;
+    sensorPrivate->explicitBatch = true;
+}
+
+/*!
+    \since 6.5
 
-    // Copy the values from the filter reading to the cached reading
-    sensorPrivate->cache_reading->copyValuesFrom(sensorPrivate->filter_reading);
+    Deliver the readings collected since beginReadingBatch().
 
-    Q_EMIT d->m_sensor->readingChanged();
+    \sa beginReadingBatch()
+*/
+void QSensorBackend::endReadingBatch()
+{
+    Q_D(QSensorBackend);
+    QSensorPrivate *sensorPrivate = d->m_sensor->d_func();
+    if (sensorPrivate->backendThread || !sensorPrivate->explicitBatch)
+        return;
+    sensorPrivate->explicitBatch = false;
+    sensorPrivate->flushBatch();
 }
 
 /*!
@@ -98,6 +161,8 @@ QSensorReading *QSensorBackend::reading() const
 {
     Q_D(const QSensorBackend);
     QSensorPrivate *sensorPrivate = d->m_sensor->d_func();
+    if (sensorPrivate->backendThread)
+        return sensorPrivate->backendReading;
     return sensorPrivate->device_reading;
 }
 
@@ -186,6 +251,16 @@ void QSensorBackend::setReadings(QSensorReading *device, QSensorReading *filter,
     sensorPrivate->cache_reading = cache;
 }
 
+/*!
+    \internal
+*/
+void QSensorBackend::setReadingFactory(QSensorReading *(*factory)(QObject *parent))
+{
+    Q_D(QSensorBackend);
+    QSensorPrivate *sensorPrivate = d->m_sensor->d_func();
+    sensorPrivate->readingFactory = factory;
+}
+
 /*!
     Add a data rate (consisting of \a min and \a max values) for the sensor.
 
@@ -278,7 +353,14 @@ void QSensorBackend::sensorStopped()
 {
     Q_D(QSensorBackend);
     QSensorPrivate *sensorPrivate = d->m_sensor->d_func();
+    if (forwardToSensorThread(sensorPrivate)) {
+        QMetaObject::invokeMethod(d->m_sensor, [this] { sensorStopped(); }, Qt::QueuedConnection);
+        return;
+    }
+    if (!sensorPrivate->active)
+        return;
     sensorPrivate->active = false;
+    sensorPrivate->stopped();
 }
 
 /*!
@@ -297,10 +379,16 @@ void QSensorBackend::sensorBusy(bool busy)
 {
     Q_D(QSensorBackend);
     QSensorPrivate *sensorPrivate = d->m_sensor->d_func();
+    if (forwardToSensorThread(sensorPrivate)) {
+        QMetaObject::invokeMethod(d->m_sensor, [this, busy] { sensorBusy(busy); }, Qt::QueuedConnection);
+        return;
+    }
     if (sensorPrivate->busy == busy)
         return;
-    if (busy)
+    if (busy && sensorPrivate->active) {
         sensorPrivate->active = false;
+        sensorPrivate->stopped();
+    }
     sensorPrivate->busy = busy;
     emit d->m_sensor->busyChanged();
 }
@@ -316,6 +404,10 @@ void QSensorBackend::sensorError(int error)
 {
     Q_D(QSensorBackend);
     QSensorPrivate *sensorPrivate = d->m_sensor->d_func();
+    if (forwardToSensorThread(sensorPrivate)) {
+        QMetaObject::invokeMethod(d->m_sensor, [this, error] { sensorError(error); }, Qt::QueuedConnection);
+        return;
+    }
     sensorPrivate->error = error;
     Q_EMIT d->m_sensor->sensorError(error);
 }
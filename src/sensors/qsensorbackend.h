@@ -35,6 +35,7 @@ public:
         if (!readingClass)
             readingClass = new T(this);
         setReadings(readingClass, new T(this), new T(this));
+        setReadingFactory(&createReading<T>);
         return readingClass;
     }
 
@@ -43,12 +44,18 @@ public:
 
     // used by the backend to inform us of events
     void newReadingAvailable();
+    void beginReadingBatch();
+    void endReadingBatch();
     void sensorStopped();
     void sensorBusy(bool busy = true);
     void sensorError(int error);
 
 private:
     void setReadings(QSensorReading *device, QSensorReading *filter, QSensorReading *cache);
+    void setReadingFactory(QSensorReading *(*factory)(QObject *parent));
+
+    template <typename T>
+    static QSensorReading *createReading(QObject *parent) { return new T(parent); }
 
     Q_DECLARE_PRIVATE(QSensorBackend)
     Q_DISABLE_COPY(QSensorBackend)
@@ -6,19 +6,56 @@
 #include <private/qfactoryloader_p.h>
 #include <QPluginLoader>
 #include "qsensorplugin.h"
+#include "qsensorregistrycache_p.h"
+#include "qsharedsensorbackend_p.h"
 #include <QStandardPaths>
 #include "sensorlog_p.h"
 #include <QTimer>
 #include <QFile>
 #include <QLoggingCategory>
+#include <QCoreApplication>
+#include <QDir>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QLibrary>
+#include <QtCore/qcbormap.h>
+#include <qtsensors_tracepoints_p.h>
 
 QT_BEGIN_NAMESPACE
 
 typedef QHash<QByteArray,QSensorBackendFactory*> FactoryForIdentifierMap;
 typedef QHash<QByteArray,FactoryForIdentifierMap> BackendIdentifiersForTypeMap;
 
+typedef QList<QPair<QByteArray, QByteArray>> BackendList; // type and identifier
+
 Q_LOGGING_CATEGORY(lcSensorManager, "qt.sensors");
 
+static const char sensorPluginIid[] = "com.qt-project.Qt.QSensorPluginInterface/1.0";
+
+// Stands in for the backends that a plugin declares in its metadata, or
+// registered the last time it was loaded, until one of them is created and
+// the plugin is loaded
+class QDeclaredBackendFactory : public QSensorBackendFactory
+{
+public:
+    QDeclaredBackendFactory(int pluginIndex, const QString &fileName)
+        : pluginIndex(pluginIndex)
+        , fileName(fileName)
+        , instance(nullptr)
+        , loaded(false)
+    {
+    }
+    ~QDeclaredBackendFactory() override = default;
+
+    QSensorBackend *createBackend(QSensor *sensor) override;
+
+    int pluginIndex;  // in the factory loader, or -1
+    QString fileName; // for plugins that are not found by the factory loader
+    QObject *instance; // for plugins declared by qt_sensors_declare_plugin()
+    bool loaded;
+    BackendList backends;
+};
+
 class QSensorManagerPrivate : public QObject
 {
     friend class QSensorManager;
@@ -33,7 +70,9 @@ public:
     QSensorManagerPrivate()
         : loadExternalPlugins(true)
         , pluginLoadingState(NotLoaded)
-        , loader(new QFactoryLoader("com.qt-project.Qt.QSensorPluginInterface/1.0", QLatin1String("/sensors")))
+        , loader(nullptr)
+        , useRegistryCache(false)
+        , registryCache(nullptr)
         , defaultIdentifierForTypeLoaded(false)
         , sensorsChanged(false)
     {
@@ -41,12 +80,42 @@ public:
         if (env == "0") {
             loadExternalPlugins = false;
         }
+        if (qgetenv("QT_SENSORS_REGISTRY_CACHE") == "1")
+            useRegistryCache = true;
+    }
+    ~QSensorManagerPrivate()
+    {
+        qDeleteAll(declaredPlugins);
+        delete registryCache;
     }
+
     bool loadExternalPlugins;
     PluginLoadingState pluginLoadingState;
-    QFactoryLoader *loader;
+    QFactoryLoader *loader; // created when it is needed, it scans the plugin directories
+    QFactoryLoader *factoryLoader()
+    {
+        if (!loader)
+            loader = new QFactoryLoader(sensorPluginIid, QLatin1String("/sensors"));
+        return loader;
+    }
     void loadPlugins();
 
+    // Plugins whose metadata lists their backends are only loaded when one
+    // of the backends is created
+    QList<QDeclaredBackendFactory *> declaredPlugins;
+    QDeclaredBackendFactory *declarePlugin(int pluginIndex, const QString &fileName,
+                                           const BackendList &backends);
+    void loadDeclaredPlugin(QDeclaredBackendFactory *declared);
+
+    // The plugins found and the backends they declare, kept on disk
+    bool useRegistryCache;
+    QSensorRegistryCache *registryCache;
+    QStringList registryDirectories;
+    void loadPluginsWithCache();
+
+    bool addBackend(const QByteArray &type, const QByteArray &identifier, QSensorBackendFactory *factory);
+    void removeBackend(const QByteArray &type, const QByteArray &identifier);
+
     // Holds a mapping from type to available identifiers (and from there to the factory)
     BackendIdentifiersForTypeMap backendsByType;
 
@@ -164,7 +233,9 @@ static void initPlugin(QObject *o, bool warnOnFail = true)
     if (plugin) {
         qCDebug(lcSensorManager) << "Register sensors for " << plugin;
         d->seenPlugins.insert(o);
+        Q_TRACE(QSensorManager_initPlugin_entry, o->metaObject()->className());
         plugin->registerSensors();
+        Q_TRACE(QSensorManager_initPlugin_exit, o->metaObject()->className());
     } else if (warnOnFail) {
         qCWarning(lcSensorManager) << "Can't cast to plugin" << o;
     }
@@ -175,21 +246,34 @@ void QSensorManagerPrivate::loadPlugins()
     QSensorManagerPrivate *d = this;
     if (d->pluginLoadingState != QSensorManagerPrivate::NotLoaded) return;
     d->pluginLoadingState = QSensorManagerPrivate::Loading;
+    Q_TRACE(QSensorManager_loadPlugins_entry);
 
     SENSORLOG() << "initializing static plugins";
     // Qt-style static plugins
     for (QObject *plugin : QPluginLoader::staticInstances())
         initPlugin(plugin, false /*do not warn on fail*/);
-    if (d->loadExternalPlugins) {
+    if (d->loadExternalPlugins && d->useRegistryCache) {
+        d->loadPluginsWithCache();
+    } else if (d->loadExternalPlugins) {
         SENSORLOG() << "initializing plugins";
-        QList<QPluginParsedMetaData> meta = d->loader->metaData();
+        QList<QPluginParsedMetaData> meta = d->factoryLoader()->metaData();
         for (int i = 0; i < meta.count(); i++) {
-            QObject *plugin = d->loader->instance(i);
-            initPlugin(plugin);
+            const BackendList backends = QSensorRegistryCache::declaredBackends(
+                    meta.at(i).value(QtPluginMetaDataKeys::MetaData).toMap());
+            if (backends.isEmpty()) {
+                QObject *plugin = d->loader->instance(i);
+                initPlugin(plugin);
+                continue;
+            }
+
+            // The plugin tells which backends it provides, so it is only
+            // loaded when one of them is needed
+            d->declarePlugin(i, QString(), backends);
         }
     }
 
     d->pluginLoadingState = QSensorManagerPrivate::Loaded;
+    Q_TRACE(QSensorManager_loadPlugins_exit);
 
     if (d->sensorsChanged) {
         // Notify the app that the available sensor list has changed.
@@ -198,6 +282,180 @@ void QSensorManagerPrivate::loadPlugins()
     }
 }
 
+QDeclaredBackendFactory *QSensorManagerPrivate::declarePlugin(int pluginIndex, const QString &fileName,
+                                                               const BackendList &backends)
+{
+    QDeclaredBackendFactory *declared = new QDeclaredBackendFactory(pluginIndex, fileName);
+    declaredPlugins.append(declared);
+    for (const auto &backend : backends) {
+        if (addBackend(backend.first, backend.second, declared))
+            declared->backends.append(backend);
+    }
+    return declared;
+}
+
+void QSensorManagerPrivate::loadPluginsWithCache()
+{
+    registryDirectories.clear();
+    const QStringList libraryPaths = QCoreApplication::libraryPaths();
+    for (const QString &path : libraryPaths) {
+        const QString directory = path + QLatin1String("/sensors");
+        if (QFileInfo(directory).isDir())
+            registryDirectories.append(directory);
+    }
+    registryCache = new QSensorRegistryCache(QSensorRegistryCache::defaultFileName(registryDirectories));
+
+    if (registryCache->read(registryDirectories)) {
+        SENSORLOG() << "using the plugin registry cache" << registryCache->fileName();
+        for (const QSensorPluginRecord &record : std::as_const(registryCache->plugins)) {
+            if (record.backends.isEmpty()) {
+                QPluginLoader pluginLoader(record.fileName);
+                initPlugin(pluginLoader.instance());
+            } else {
+                declarePlugin(-1, record.fileName, record.backends);
+            }
+        }
+        return;
+    }
+
+    SENSORLOG() << "scanning the plugin directories for the registry cache";
+    QSet<QString> seen;
+    for (const QString &directory : std::as_const(registryDirectories)) {
+        const QStringList entries = QDir(directory).entryList(QDir::Files, QDir::Name);
+        for (const QString &entry : entries) {
+            const QString fileName = directory + QLatin1Char('/') + entry;
+            // The first directory that has a plugin wins, as with the factory loader
+            if (seen.contains(entry) || !QLibrary::isLibrary(fileName))
+                continue;
+            QPluginLoader pluginLoader(fileName);
+            const QJsonObject metaData = pluginLoader.metaData();
+            if (metaData.value(QLatin1String("IID")).toString() != QLatin1String(sensorPluginIid))
+                continue;
+            seen.insert(entry);
+
+            QSensorPluginRecord record;
+            record.fileName = fileName;
+            record.modified = QSensorRegistryCache::modificationTime(fileName);
+            record.size = QFileInfo(fileName).size();
+            // What a plugin registers without declaring it may depend on the
+            // hardware, services or environment of each run, so only the
+            // declarations are cached and the other plugins are always loaded
+            record.backends = QSensorRegistryCache::declaredBackends(QCborMap::fromJsonObject(
+                    metaData.value(QLatin1String("MetaData")).toObject()));
+            if (record.backends.isEmpty())
+                initPlugin(pluginLoader.instance());
+            else
+                declarePlugin(-1, fileName, record.backends);
+            registryCache->plugins.append(record);
+        }
+    }
+    if (!registryCache->write(registryDirectories))
+        qCWarning(lcSensorManager) << "Can't write the plugin registry cache" << registryCache->fileName();
+}
+
+void QSensorManagerPrivate::loadDeclaredPlugin(QDeclaredBackendFactory *declared)
+{
+    if (declared->loaded)
+        return;
+    declared->loaded = true;
+
+    // The plugin registers the backends itself
+    for (const auto &backend : std::as_const(declared->backends)) {
+        if (backendsByType.value(backend.first).value(backend.second) == declared)
+            removeBackend(backend.first, backend.second);
+    }
+    if (declared->instance) {
+        initPlugin(declared->instance);
+    } else if (declared->fileName.isEmpty()) {
+        SENSORLOG() << "loading plugin" << declared->pluginIndex << "on demand";
+        initPlugin(factoryLoader()->instance(declared->pluginIndex));
+    } else {
+        SENSORLOG() << "loading plugin" << declared->fileName << "on demand";
+        QPluginLoader pluginLoader(declared->fileName);
+        initPlugin(pluginLoader.instance());
+    }
+
+    bool changed = false;
+    for (const auto &backend : std::as_const(declared->backends))
+        changed |= !backendsByType.value(backend.first).contains(backend.second);
+    if (changed) {
+        // Notify the app that the plugin does not provide all it declared.
+        // This may cause recursive calls!
+        emitSensorsChanged();
+    }
+}
+
+bool QSensorManagerPrivate::addBackend(const QByteArray &type, const QByteArray &identifier, QSensorBackendFactory *factory)
+{
+    if (!backendsByType.contains(type)) {
+        (void)backendsByType[type];
+        firstIdentifierForType[type] = identifier;
+    } else if (firstIdentifierForType[type].startsWith("generic.") ||
+        firstIdentifierForType[type].startsWith("dummy.")) {
+        // Don't let a generic or dummy backend be the default when some other backend exists!
+        firstIdentifierForType[type] = identifier;
+    }
+    FactoryForIdentifierMap &factoryByIdentifier = backendsByType[type];
+    if (factoryByIdentifier.contains(identifier)) {
+        qWarning() << "A backend with type" << type << "and identifier" << identifier << "has already been registered!";
+        return false;
+    }
+    SENSORLOG() << "registering backend for type" << type << "identifier" << identifier;// << "factory" << QString().sprintf("0x%08x", (unsigned int)factory);
+    factoryByIdentifier[identifier] = factory;
+    return true;
+}
+
+void QSensorManagerPrivate::removeBackend(const QByteArray &type, const QByteArray &identifier)
+{
+    FactoryForIdentifierMap &factoryByIdentifier = backendsByType[type];
+    (void)factoryByIdentifier.take(identifier); // we don't own this pointer anyway
+    if (firstIdentifierForType[type] == identifier) {
+        if (factoryByIdentifier.count()) {
+            firstIdentifierForType[type] = factoryByIdentifier.begin().key();
+            if (firstIdentifierForType[type].startsWith("generic.")) {
+                // Don't let a generic backend be the default when some other backend exists!
+                for (FactoryForIdentifierMap::const_iterator it = factoryByIdentifier.begin()++; it != factoryByIdentifier.end(); ++it) {
+                    const QByteArray &identifier(it.key());
+                    if (!identifier.startsWith("generic.")) {
+                        firstIdentifierForType[type] = identifier;
+                        break;
+                    }
+                }
+            }
+        } else {
+            (void)firstIdentifierForType.take(type);
+        }
+    }
+    if (!factoryByIdentifier.count())
+        (void)backendsByType.take(type);
+}
+
+QSensorBackend *QDeclaredBackendFactory::createBackend(QSensor *sensor)
+{
+    QSensorManagerPrivate *d = sensorManagerPrivate();
+    if (!d) return 0; // hardly likely but just in case...
+    d->loadDeclaredPlugin(this);
+
+    QSensorBackendFactory *factory = d->backendsByType.value(sensor->type()).value(sensor->identifier());
+    if (!factory || factory == this) {
+        qCWarning(lcSensorManager) << "Plugin" << pluginIndex << "did not register the backend"
+                                   << sensor->identifier() << "it declared for type" << sensor->type();
+        return 0;
+    }
+    return factory->createBackend(sensor);
+}
+
+// Declares the backends of \a plugin as if its metadata listed them, so that
+// it is initialized when one of them is created. For tests.
+Q_SENSORS_EXPORT void qt_sensors_declare_plugin(QObject *plugin, const BackendList &backends)
+{
+    QSensorManagerPrivate *d = sensorManagerPrivate();
+    if (!d) return; // hardly likely but just in case...
+    d->loadPlugins();
+    d->declarePlugin(-1, QString(), backends)->instance = plugin;
+    d->emitSensorsChanged();
+}
+
 // =====================================================================
 
 /*!
@@ -227,21 +485,8 @@ void QSensorManager::registerBackend(const QByteArray &type, const QByteArray &i
     Q_ASSERT(factory);
     QSensorManagerPrivate *d = sensorManagerPrivate();
     if (!d) return; // hardly likely but just in case...
-    if (!d->backendsByType.contains(type)) {
-        (void)d->backendsByType[type];
-        d->firstIdentifierForType[type] = identifier;
-    } else if (d->firstIdentifierForType[type].startsWith("generic.") ||
-        d->firstIdentifierForType[type].startsWith("dummy.")) {
-        // Don't let a generic or dummy backend be the default when some other backend exists!
-        d->firstIdentifierForType[type] = identifier;
-    }
-    FactoryForIdentifierMap &factoryByIdentifier = d->backendsByType[type];
-    if (factoryByIdentifier.contains(identifier)) {
-        qWarning() << "A backend with type" << type << "and identifier" << identifier << "has already been registered!";
+    if (!d->addBackend(type, identifier, factory))
         return;
-    }
-    SENSORLOG() << "registering backend for type" << type << "identifier" << identifier;// << "factory" << QString().sprintf("0x%08x", (unsigned int)factory);
-    factoryByIdentifier[identifier] = factory;
 
     // Notify the app that the available sensor list has changed.
     // This may cause recursive calls!
@@ -263,32 +508,11 @@ void QSensorManager::unregisterBackend(const QByteArray &type, const QByteArray
         qWarning() << "No backends of type" << type << "are registered";
         return;
     }
-    FactoryForIdentifierMap &factoryByIdentifier = d->backendsByType[type];
-    if (!factoryByIdentifier.contains(identifier)) {
+    if (!d->backendsByType[type].contains(identifier)) {
         qWarning() << "Identifier" << identifier << "is not registered";
         return;
     }
-
-    (void)factoryByIdentifier.take(identifier); // we don't own this pointer anyway
-    if (d->firstIdentifierForType[type] == identifier) {
-        if (factoryByIdentifier.count()) {
-            d->firstIdentifierForType[type] = factoryByIdentifier.begin().key();
-            if (d->firstIdentifierForType[type].startsWith("generic.")) {
-                // Don't let a generic backend be the default when some other backend exists!
-                for (FactoryForIdentifierMap::const_iterator it = factoryByIdentifier.begin()++; it != factoryByIdentifier.end(); ++it) {
-                    const QByteArray &identifier(it.key());
-                    if (!identifier.startsWith("generic.")) {
-                        d->firstIdentifierForType[type] = identifier;
-                        break;
-                    }
-                }
-            }
-        } else {
-            (void)d->firstIdentifierForType.take(type);
-        }
-    }
-    if (!factoryByIdentifier.count())
-        (void)d->backendsByType.take(type);
+    d->removeBackend(type, identifier);
 
     // Notify the app that the available sensor list has changed.
     // This may cause recursive calls!
@@ -313,7 +537,14 @@ QSensorBackend *QSensorManager::createBackend(QSensor *sensor)
         return 0;
     }
 
-    const FactoryForIdentifierMap &factoryByIdentifier = d->backendsByType[sensor->type()];
+    // Sensors that run their backend in a thread of their own keep it to themselves
+    if (sensor->sharedBackend() && !sensor->threadedBackend()) {
+        if (QSensorBackend *backend = QSharedSensorBackend::create(sensor))
+            return backend;
+    }
+
+    // A copy, loading a plugin on demand changes the registered backends
+    const FactoryForIdentifierMap factoryByIdentifier = d->backendsByType[sensor->type()];
     QSensorBackendFactory *factory;
     QSensorBackend *backend;
 
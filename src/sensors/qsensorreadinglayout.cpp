@@ -0,0 +1,316 @@
+// Copyright (C) 2022 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "qsensorreadinglayout_p.h"
+
+#include "qaccelerometer.h"
+#include "qaccelerometer_p.h"
+#include "qambientlightsensor.h"
+#include "qambientlightsensor_p.h"
+#include "qambienttemperaturesensor.h"
+#include "qambienttemperaturesensor_p.h"
+#include "qcompass.h"
+#include "qcompass_p.h"
+#include "qgyroscope.h"
+#include "qgyroscope_p.h"
+#include "qhumiditysensor.h"
+#include "qhumiditysensor_p.h"
+#include "qirproximitysensor.h"
+#include "qirproximitysensor_p.h"
+#include "qlidsensor.h"
+#include "qlidsensor_p.h"
+#include "qlightsensor.h"
+#include "qlightsensor_p.h"
+#include "qmagnetometer.h"
+#include "qmagnetometer_p.h"
+#include "qorientationsensor.h"
+#include "qorientationsensor_p.h"
+#include "qpressuresensor.h"
+#include "qpressuresensor_p.h"
+#include "qproximitysensor.h"
+#include "qproximitysensor_p.h"
+#include "qrotationsensor.h"
+#include "qrotationsensor_p.h"
+#include "qtapsensor.h"
+#include "qtapsensor_p.h"
+#include "qtiltsensor.h"
+#include "qtiltsensor_p.h"
+
+#include <QtCore/qdebug.h>
+#include <QtCore/qhash.h>
+#include <QtCore/qmutex.h>
+
+#include <atomic>
+
+QT_BEGIN_NAMESPACE
+
+#define LAYOUT_FIELD(pclassname, name) QSensorReadingLayout::field(#name, &pclassname::name)
+// Angles in degrees
+#define LAYOUT_ANGLE(pclassname, name) QSensorReadingLayout::field(#name, &pclassname::name, 360)
+// Values in another unit than the accuracy of the sensor, every change counts
+#define LAYOUT_OTHER_UNIT(pclassname, name) QSensorReadingLayout::field(#name, &pclassname::name, 0, 0)
+
+// The layouts of the Sensors module are added when the registry is created
+// and never change, so looking them up needs no lock. Layouts registered
+// later are kept apart under a mutex. Layouts are never replaced or deleted
+// before shutdown, code keeps pointers to them.
+class QSensorReadingLayoutRegistry
+{
+public:
+    QSensorReadingLayoutRegistry()
+    {
+        typedef QSensorReadingLayout L;
+        add(L::create<QAccelerometerReading, QAccelerometerReadingPrivate>({
+            LAYOUT_FIELD(QAccelerometerReadingPrivate, x),
+            LAYOUT_FIELD(QAccelerometerReadingPrivate, y),
+            LAYOUT_FIELD(QAccelerometerReadingPrivate, z) }));
+        add(L::create<QAmbientLightReading, QAmbientLightReadingPrivate>({
+            LAYOUT_FIELD(QAmbientLightReadingPrivate, lightLevel) }));
+        add(L::create<QAmbientTemperatureReading, QAmbientTemperatureReadingPrivate>({
+            LAYOUT_FIELD(QAmbientTemperatureReadingPrivate, temperature) }));
+        add(L::create<QCompassReading, QCompassReadingPrivate>({
+            LAYOUT_ANGLE(QCompassReadingPrivate, azimuth),
+            LAYOUT_OTHER_UNIT(QCompassReadingPrivate, calibrationLevel) }));
+        add(L::create<QGyroscopeReading, QGyroscopeReadingPrivate>({
+            LAYOUT_FIELD(QGyroscopeReadingPrivate, x),
+            LAYOUT_FIELD(QGyroscopeReadingPrivate, y),
+            LAYOUT_FIELD(QGyroscopeReadingPrivate, z) }));
+        add(L::create<QHumidityReading, QHumidityReadingPrivate>({
+            LAYOUT_FIELD(QHumidityReadingPrivate, relativeHumidity),
+            LAYOUT_OTHER_UNIT(QHumidityReadingPrivate, absoluteHumidity) }));
+        add(L::create<QIRProximityReading, QIRProximityReadingPrivate>({
+            LAYOUT_FIELD(QIRProximityReadingPrivate, reflectance) }));
+        add(L::create<QLidReading, QLidReadingPrivate>({
+            LAYOUT_FIELD(QLidReadingPrivate, backLidClosed),
+            LAYOUT_FIELD(QLidReadingPrivate, frontLidClosed) }));
+        add(L::create<QLightReading, QLightReadingPrivate>({
+            LAYOUT_FIELD(QLightReadingPrivate, lux) }));
+        add(L::create<QMagnetometerReading, QMagnetometerReadingPrivate>({
+            LAYOUT_FIELD(QMagnetometerReadingPrivate, x),
+            LAYOUT_FIELD(QMagnetometerReadingPrivate, y),
+            LAYOUT_FIELD(QMagnetometerReadingPrivate, z),
+            LAYOUT_OTHER_UNIT(QMagnetometerReadingPrivate, calibrationLevel) }));
+        add(L::create<QOrientationReading, QOrientationReadingPrivate>({
+            LAYOUT_FIELD(QOrientationReadingPrivate, orientation) }));
+        add(L::create<QPressureReading, QPressureReadingPrivate>({
+            LAYOUT_FIELD(QPressureReadingPrivate, pressure),
+            LAYOUT_OTHER_UNIT(QPressureReadingPrivate, temperature) }));
+        add(L::create<QProximityReading, QProximityReadingPrivate>({
+            LAYOUT_FIELD(QProximityReadingPrivate, close) }));
+        add(L::create<QRotationReading, QRotationReadingPrivate>({
+            LAYOUT_ANGLE(QRotationReadingPrivate, x),
+            LAYOUT_ANGLE(QRotationReadingPrivate, y),
+            LAYOUT_ANGLE(QRotationReadingPrivate, z) }));
+        add(L::create<QTapReading, QTapReadingPrivate>({
+            LAYOUT_FIELD(QTapReadingPrivate, tapDirection),
+            LAYOUT_FIELD(QTapReadingPrivate, doubleTap) }));
+        add(L::create<QTiltReading, QTiltReadingPrivate>({
+            LAYOUT_FIELD(QTiltReadingPrivate, yRotation),
+            LAYOUT_FIELD(QTiltReadingPrivate, xRotation) }));
+    }
+
+    ~QSensorReadingLayoutRegistry()
+    {
+        qDeleteAll(builtinLayouts);
+        qDeleteAll(registeredLayouts);
+    }
+
+    void add(QSensorReadingLayout *layout)
+    {
+        builtinLayouts.insert(layout->metaObject(), layout);
+    }
+
+    QHash<const QMetaObject *, QSensorReadingLayout *> builtinLayouts;
+    QMutex mutex;
+    QHash<const QMetaObject *, QSensorReadingLayout *> registeredLayouts; // guarded by mutex
+    std::atomic<bool> hasRegisteredLayouts = false;
+};
+
+#undef LAYOUT_FIELD
+#undef LAYOUT_ANGLE
+#undef LAYOUT_OTHER_UNIT
+
+Q_GLOBAL_STATIC(QSensorReadingLayoutRegistry, readingLayoutRegistry)
+
+/*!
+    \class QSensorReadingLayout
+    \internal
+
+    Describes the plain-data sample of a reading type. A sample is a
+    QSensorReadingSample: the timestamp followed by the reading's private
+    value struct, so it can be copied with memcpy and stored in arrays with
+    a stride of sampleSize(). The fields are listed in the same order as
+    QSensorReading::value() so generic code can read them by index.
+*/
+QSensorReadingLayout::QSensorReadingLayout(const QMetaObject *metaObject, int sampleSize,
+                                           const QList<QSensorReadingField> &fields,
+                                           ReadFunction read, WriteFunction write)
+    : m_metaObject(metaObject)
+    , m_sampleSize(sampleSize)
+    , m_fields(fields)
+    , m_read(read)
+    , m_write(write)
+{
+}
+
+/*!
+    Returns the index of the field called \a name, or -1.
+*/
+int QSensorReadingLayout::indexOf(const char *name) const
+{
+    for (int i = 0; i < m_fields.size(); ++i) {
+        if (qstrcmp(m_fields.at(i).name, name) == 0)
+            return i;
+    }
+    return -1;
+}
+
+/*!
+    Returns the field at \a index of \a sample converted to qreal.
+*/
+qreal QSensorReadingLayout::value(const void *sample, int index) const
+{
+    const QSensorReadingField &f = m_fields.at(index);
+    const char *data = static_cast<const char *>(sample) + f.offset;
+    switch (f.type) {
+    case QMetaType::Double: {
+        double value;
+        memcpy(&value, data, sizeof(value));
+        return qreal(value);
+    }
+    case QMetaType::Float: {
+        float value;
+        memcpy(&value, data, sizeof(value));
+        return qreal(value);
+    }
+    case QMetaType::Int: {
+        int value;
+        memcpy(&value, data, sizeof(value));
+        return qreal(value);
+    }
+    case QMetaType::Bool: {
+        bool value;
+        memcpy(&value, data, sizeof(value));
+        return value ? 1.0 : 0.0;
+    }
+    default:
+        break;
+    }
+    return 0;
+}
+
+/*!
+    Stores \a value in the field at \a index of \a sample, converted to the
+    field's type.
+*/
+void QSensorReadingLayout::setValue(void *sample, int index, qreal value) const
+{
+    const QSensorReadingField &f = m_fields.at(index);
+    char *data = static_cast<char *>(sample) + f.offset;
+    switch (f.type) {
+    case QMetaType::Double: {
+        const double v = double(value);
+        memcpy(data, &v, sizeof(v));
+        break;
+    }
+    case QMetaType::Float: {
+        const float v = float(value);
+        memcpy(data, &v, sizeof(v));
+        break;
+    }
+    case QMetaType::Int: {
+        const int v = qRound(value);
+        memcpy(data, &v, sizeof(v));
+        break;
+    }
+    case QMetaType::Bool: {
+        const bool v = value != 0;
+        memcpy(data, &v, sizeof(v));
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+/*!
+    Returns the layout of \a reading or nullptr if its type has not been registered.
+*/
+const QSensorReadingLayout *QSensorReadingLayout::forReading(const QSensorReading *reading)
+{
+    return reading ? forMetaObject(reading->metaObject()) : nullptr;
+}
+
+/*!
+    Returns the layout of the reading type \a metaObject or nullptr if it
+    has not been registered.
+*/
+const QSensorReadingLayout *QSensorReadingLayout::forMetaObject(const QMetaObject *metaObject)
+{
+    QSensorReadingLayoutRegistry *registry = readingLayoutRegistry();
+    if (!registry)
+        return nullptr;
+    if (const QSensorReadingLayout *layout = registry->builtinLayouts.value(metaObject))
+        return layout;
+    if (!registry->hasRegisteredLayouts.load(std::memory_order_acquire))
+        return nullptr;
+    QMutexLocker locker(&registry->mutex);
+    return registry->registeredLayouts.value(metaObject);
+}
+
+/*!
+    Returns the layout of the reading class called \a className or nullptr
+    if it has not been registered.
+*/
+const QSensorReadingLayout *QSensorReadingLayout::forClassName(const QByteArray &className)
+{
+    QSensorReadingLayoutRegistry *registry = readingLayoutRegistry();
+    if (!registry)
+        return nullptr;
+    for (const QSensorReadingLayout *layout : std::as_const(registry->builtinLayouts)) {
+        if (className == layout->metaObject()->className())
+            return layout;
+    }
+    QMutexLocker locker(&registry->mutex);
+    for (const QSensorReadingLayout *layout : std::as_const(registry->registeredLayouts)) {
+        if (className == layout->metaObject()->className())
+            return layout;
+    }
+    return nullptr;
+}
+
+/*!
+    Registers \a layout for a reading type that is not part of the Sensors
+    module and returns true. Takes ownership of \a layout.
+
+    A type can only be registered once, because code keeps pointers to the
+    layouts. If the type has a layout already, \a layout is deleted and
+    false is returned.
+
+    \code
+    QSensorReadingLayout::registerLayout(QSensorReadingLayout::create<MyReading, MyReadingPrivate>({
+        QSensorReadingLayout::field("value", &MyReadingPrivate::value) }));
+    \endcode
+*/
+bool QSensorReadingLayout::registerLayout(QSensorReadingLayout *layout)
+{
+    QSensorReadingLayoutRegistry *registry = readingLayoutRegistry();
+    if (!registry) {
+        delete layout;
+        return false;
+    }
+    const QMetaObject *metaObject = layout->metaObject();
+    QMutexLocker locker(&registry->mutex);
+    if (registry->builtinLayouts.contains(metaObject)
+            || registry->registeredLayouts.contains(metaObject)) {
+        qWarning() << "QSensorReadingLayout: a layout for" << metaObject->className()
+                   << "is registered already";
+        delete layout;
+        return false;
+    }
+    registry->registeredLayouts.insert(metaObject, layout);
+    registry->hasRegisteredLayouts.store(true, std::memory_order_release);
+    return true;
+}
+
+QT_END_NAMESPACE
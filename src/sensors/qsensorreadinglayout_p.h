@@ -0,0 +1,148 @@
+// Copyright (C) 2022 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef QSENSORREADINGLAYOUT_P_H
+#define QSENSORREADINGLAYOUT_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtSensors/qsensor.h>
+#include <QtCore/qlist.h>
+#include <QtCore/qmetatype.h>
+
+#include <cstring>
+#include <initializer_list>
+#include <type_traits>
+
+QT_BEGIN_NAMESPACE
+
+// Plain-data image of a reading: the timestamp followed by the reading's
+// private value struct. Samples of one type can be stored back to back.
+template <typename Private>
+struct QSensorReadingSample
+{
+    quint64 timestamp;
+    Private values;
+};
+
+struct QSensorReadingField
+{
+    const char *name;
+    int type;   // QMetaType id: Double, Float, Int or Bool
+    int offset; // in bytes from the start of the sample
+    // Values that wrap around, like angles in degrees, have a period and
+    // cannot be averaged or interpolated. 0 if the values do not wrap.
+    qreal period = 0;
+    // Values closer than this are the same when duplicates are skipped. -1
+    // for the accuracy of the sensor, which is given in the unit of its main
+    // values. Fields in another unit, like a calibration level, set their own.
+    qreal tolerance = -1;
+};
+
+// Describes the sample of one reading type so that generic code can store
+// readings in contiguous memory and access their values by index without
+// going through QMetaProperty and QVariant.
+class Q_SENSORS_EXPORT QSensorReadingLayout
+{
+public:
+    typedef void (*ReadFunction)(const QSensorReading *reading, void *sample);
+    typedef void (*WriteFunction)(QSensorReading *reading, const void *sample);
+
+    QSensorReadingLayout(const QMetaObject *metaObject, int sampleSize,
+                         const QList<QSensorReadingField> &fields,
+                         ReadFunction read, WriteFunction write);
+
+    const QMetaObject *metaObject() const { return m_metaObject; }
+    int sampleSize() const { return m_sampleSize; }
+
+    // The fields are in the same order as QSensorReading::value()
+    int fieldCount() const { return int(m_fields.size()); }
+    const QSensorReadingField &field(int index) const { return m_fields.at(index); }
+    int indexOf(const char *name) const;
+
+    bool isPeriodic(int index) const { return m_fields.at(index).period > 0; }
+
+    // The sample must be aligned like quint64
+    void read(const QSensorReading *reading, void *sample) const { m_read(reading, sample); }
+    void write(QSensorReading *reading, const void *sample) const { m_write(reading, sample); }
+
+    static quint64 timestamp(const void *sample)
+    {
+        quint64 timestamp;
+        memcpy(&timestamp, sample, sizeof(timestamp));
+        return timestamp;
+    }
+    static void setTimestamp(void *sample, quint64 timestamp)
+    {
+        memcpy(sample, &timestamp, sizeof(timestamp));
+    }
+    qreal value(const void *sample, int index) const;
+    void setValue(void *sample, int index, qreal value) const;
+
+    static const QSensorReadingLayout *forReading(const QSensorReading *reading);
+    static const QSensorReadingLayout *forMetaObject(const QMetaObject *metaObject);
+    static const QSensorReadingLayout *forClassName(const QByteArray &className);
+    // Takes ownership. Reading types of the Sensors module are registered
+    // already, and a type cannot be registered twice.
+    static bool registerLayout(QSensorReadingLayout *layout);
+
+    // Builds the layout of a reading declared with DECLARE_READING_D(Reading, Private)
+    template <typename Reading, typename Private>
+    static QSensorReadingLayout *create(std::initializer_list<QSensorReadingField> fields)
+    {
+        static_assert(std::is_trivially_copyable_v<Private>,
+                      "Reading values must be trivially copyable");
+        return new QSensorReadingLayout(&Reading::staticMetaObject,
+                                        int(sizeof(QSensorReadingSample<Private>)), fields,
+                                        &readSample<Reading, Private>,
+                                        &writeSample<Reading, Private>);
+    }
+
+    template <typename Private, typename T>
+    static QSensorReadingField field(const char *name, T Private::*member,
+                                     qreal period = 0, qreal tolerance = -1)
+    {
+        const QSensorReadingSample<Private> probe = {};
+        const char *base = reinterpret_cast<const char *>(&probe);
+        const char *value = reinterpret_cast<const char *>(&(probe.values.*member));
+        return { name, QMetaType::fromType<T>().id(), int(value - base), period, tolerance };
+    }
+
+private:
+    template <typename Reading, typename Private>
+    static void readSample(const QSensorReading *reading, void *sample)
+    {
+        const Reading *typed = static_cast<const Reading *>(reading);
+        auto *out = static_cast<QSensorReadingSample<Private> *>(sample);
+        out->timestamp = typed->timestamp();
+        out->values = *typed->d;
+    }
+
+    template <typename Reading, typename Private>
+    static void writeSample(QSensorReading *reading, const void *sample)
+    {
+        Reading *typed = static_cast<Reading *>(reading);
+        const auto *in = static_cast<const QSensorReadingSample<Private> *>(sample);
+        typed->setTimestamp(in->timestamp);
+        *typed->d = in->values;
+    }
+
+    const QMetaObject *m_metaObject;
+    int m_sampleSize;
+    QList<QSensorReadingField> m_fields;
+    ReadFunction m_read;
+    WriteFunction m_write;
+};
+
+QT_END_NAMESPACE
+
+#endif
@@ -0,0 +1,751 @@
+// Copyright (C) 2022 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "qsensorrecorder_p.h"
+#include "qsensorreadinglayout_p.h"
+
+#include <QtCore/QDebug>
+#include <QtCore/QIODevice>
+#include <QtCore/QLocale>
+#include <QtCore/qendian.h>
+
+#include <cstring>
+
+QT_BEGIN_NAMESPACE
+
+/*
+    Recording format, all integers little endian:
+
+    header   "QSNR" quint16 version quint16 flags
+    chunk    quint32 tag, quint32 payload size, payload
+
+    'STRM'   varint stream id, string reading class, string identifier,
+             varint field count, per field: char kind, string name
+    'DATA'   quint64 base timestamp, quint32 record count, records:
+             varint stream id, zigzag varint timestamp delta,
+             values: 'd' 8 bytes, 'f' 4 bytes, 'i' zigzag varint, 'b' 1 byte
+
+    Strings are a varint length followed by UTF-8 bytes. The first delta
+    of a data chunk is relative to its base timestamp, every other one to
+    the previous record. Chunks with unknown tags are skipped and a
+    truncated chunk at the end of the file is ignored, so a recording that
+    was cut off by a crash is still readable up to its last complete chunk.
+*/
+
+static const char recordingMagic[4] = { 'Q', 'S', 'N', 'R' };
+static const quint16 recordingVersion = 1;
+static const int fileHeaderSize = 8;
+static const int chunkHeaderSize = 8;
+static const int dataHeaderSize = 12;
+
+static constexpr quint32 chunkTag(char a, char b, char c, char d)
+{
+    return quint32(uchar(a)) | quint32(uchar(b)) << 8 | quint32(uchar(c)) << 16 | quint32(uchar(d)) << 24;
+}
+
+static const quint32 streamTag = chunkTag('S', 'T', 'R', 'M');
+static const quint32 dataTag = chunkTag('D', 'A', 'T', 'A');
+
+static inline quint64 zigzagEncode(qint64 value)
+{
+    return (quint64(value) << 1) ^ quint64(value >> 63);
+}
+
+static inline qint64 zigzagDecode(quint64 value)
+{
+    return qint64(value >> 1) ^ -qint64(value & 1);
+}
+
+static inline void putVarint(QByteArray &out, quint64 value)
+{
+    while (value >= 0x80) {
+        out.append(char(value | 0x80));
+        value >>= 7;
+    }
+    out.append(char(value));
+}
+
+static inline bool getVarint(const char *&p, const char *end, quint64 *value)
+{
+    quint64 result = 0;
+    for (int shift = 0; shift < 64 && p < end; shift += 7) {
+        const uchar byte = uchar(*p++);
+        result |= quint64(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            *value = result;
+            return true;
+        }
+    }
+    return false;
+}
+
+template <typename T>
+static inline void putLittleEndian(QByteArray &out, T value)
+{
+    char buffer[sizeof(T)];
+    qToLittleEndian(value, buffer);
+    out.append(buffer, sizeof(T));
+}
+
+static void putString(QByteArray &out, const QByteArray &string)
+{
+    putVarint(out, quint64(string.size()));
+    out.append(string);
+}
+
+static bool getString(const char *&p, const char *end, QByteArray *string)
+{
+    quint64 size;
+    if (!getVarint(p, end, &size) || size > quint64(end - p))
+        return false;
+    *string = QByteArray(p, qsizetype(size));
+    p += size;
+    return true;
+}
+
+static char fieldKind(int type)
+{
+    switch (type) {
+    case QMetaType::Double:
+        return 'd';
+    case QMetaType::Float:
+        return 'f';
+    case QMetaType::Int:
+        return 'i';
+    case QMetaType::Bool:
+        return 'b';
+    default:
+        return 0;
+    }
+}
+
+// Names used by the sensorclerk text format
+struct QSensorTextName
+{
+    const char *name;
+    const char *readingType;
+    const char *field; // the only value written, or nullptr for all of them
+};
+
+static const QSensorTextName textNames[] = {
+    { "accelerometer", "QAccelerometerReading", nullptr },
+    { "ambientLight", "QAmbientLightReading", nullptr },
+    { "ambientTemperature", "QAmbientTemperatureReading", nullptr },
+    { "compass", "QCompassReading", nullptr },
+    { "gyroscope", "QGyroscopeReading", nullptr },
+    { "humidity", "QHumidityReading", nullptr },
+    { "irProximity", "QIRProximityReading", nullptr },
+    { "lid", "QLidReading", nullptr },
+    { "light", "QLightReading", nullptr },
+    { "magnetometer", "QMagnetometerReading", nullptr },
+    { "orientation", "QOrientationReading", nullptr },
+    { "pressure", "QPressureReading", nullptr },
+    { "proximity", "QProximityReading", nullptr },
+    { "rotation", "QRotationReading", nullptr },
+    { "tap", "QTapReading", "doubleTap" },
+    { "tilt", "QTiltReading", nullptr },
+};
+
+static const QSensorTextName *textNameForType(const QByteArray &readingType)
+{
+    for (const QSensorTextName &entry : textNames) {
+        if (readingType == entry.readingType)
+            return &entry;
+    }
+    return nullptr;
+}
+
+static const QSensorTextName *textNameForName(const QByteArray &name)
+{
+    for (const QSensorTextName &entry : textNames) {
+        if (name == entry.name)
+            return &entry;
+    }
+    return nullptr;
+}
+
+// =====================================================================
+
+class QSensorRecorderFilter : public QSensorFilter
+{
+public:
+    QSensorRecorderFilter(QSensorRecorder *recorder, int stream)
+        : m_recorder(recorder)
+        , m_stream(stream)
+    {
+    }
+
+    bool filter(QSensorReading *reading) override
+    {
+        m_recorder->record(m_stream, reading);
+        return true;
+    }
+
+    QSensor *sensor() const { return m_sensor; }
+
+private:
+    QSensorRecorder *m_recorder;
+    int m_stream;
+};
+
+/*!
+    \class QSensorRecorder
+    \internal
+
+    Writes sensor readings to \a device in a compact binary format. Every
+    attached sensor becomes a stream that is described once by a header
+    chunk; its readings are then appended to shared data chunks with delta
+    encoded timestamps. Records are collected in memory and written one
+    chunk of about \a chunkSize bytes at a time.
+
+    The device must be open for writing and should be empty.
+*/
+QSensorRecorder::QSensorRecorder(QIODevice *device, int chunkSize)
+    : m_device(device)
+    , m_chunkSize(qMax(chunkSize, 256))
+    , m_valid(false)
+    , m_recordCount(0)
+    , m_baseTimestamp(0)
+    , m_lastTimestamp(0)
+{
+    if (!m_device || !m_device->isWritable()) {
+        qWarning() << "QSensorRecorder: the device is not open for writing";
+        return;
+    }
+
+    QByteArray header(recordingMagic, sizeof(recordingMagic));
+    putLittleEndian<quint16>(header, recordingVersion);
+    putLittleEndian<quint16>(header, 0);
+    m_valid = m_device->write(header) == header.size();
+
+    m_records.reserve(m_chunkSize + 1024);
+    m_records.resize(chunkHeaderSize + dataHeaderSize);
+}
+
+/*!
+    Writes out the buffered records and detaches from all sensors.
+*/
+QSensorRecorder::~QSensorRecorder()
+{
+    qDeleteAll(m_filters);
+    flush();
+}
+
+/*!
+    Records every reading of \a sensor from now on. The sensor is
+    connected to its backend if necessary. Returns false if the reading
+    type of the sensor has no layout.
+*/
+bool QSensorRecorder::attach(QSensor *sensor)
+{
+    if (!sensor || !sensor->connectToBackend() || !sensor->reading()) {
+        qWarning() << "QSensorRecorder: cannot record a sensor without a backend";
+        return false;
+    }
+    const int stream = addStream(sensor->reading()->metaObject(), sensor->identifier());
+    if (stream < 0)
+        return false;
+    QSensorRecorderFilter *filter = new QSensorRecorderFilter(this, stream);
+    sensor->addFilter(filter);
+    m_filters.append(filter);
+    return true;
+}
+
+/*!
+    Stops recording \a sensor.
+*/
+void QSensorRecorder::detach(QSensor *sensor)
+{
+    for (qsizetype i = m_filters.size() - 1; i >= 0; --i) {
+        if (m_filters.at(i)->sensor() == sensor)
+            delete m_filters.takeAt(i);
+    }
+}
+
+/*!
+    Declares a stream of readings of the class \a readingType, coming from
+    the backend \a identifier. Returns the stream number to pass to
+    record(), or -1 if the reading type has no layout.
+*/
+int QSensorRecorder::addStream(const QMetaObject *readingType, const QByteArray &identifier)
+{
+    const QSensorReadingLayout *layout = QSensorReadingLayout::forMetaObject(readingType);
+    if (!layout) {
+        qWarning() << "QSensorRecorder: no reading layout for" << readingType->className();
+        return -1;
+    }
+
+    const int stream = int(m_streams.size());
+    QByteArray payload;
+    putVarint(payload, quint64(stream));
+    putString(payload, readingType->className());
+    putString(payload, identifier);
+    putVarint(payload, quint64(layout->fieldCount()));
+    for (int i = 0; i < layout->fieldCount(); ++i) {
+        payload.append(fieldKind(layout->field(i).type));
+        putString(payload, layout->field(i).name);
+    }
+
+    // Records of the streams declared so far go first
+    flush();
+    writeChunk(streamTag, payload);
+    m_streams.append(layout);
+    return stream;
+}
+
+/*!
+    Appends \a reading to \a stream.
+*/
+void QSensorRecorder::record(int stream, const QSensorReading *reading)
+{
+    if (stream < 0 || stream >= m_streams.size())
+        return;
+    const QSensorReadingLayout *layout = m_streams.at(stream);
+    QVarLengthArray<quint64, 16> sample((layout->sampleSize() + 7) / 8);
+    layout->read(reading, sample.data());
+    recordSample(stream, sample.data());
+}
+
+/*!
+    Appends \a sample, laid out as described by the stream's
+    QSensorReadingLayout, to \a stream.
+*/
+void QSensorRecorder::recordSample(int stream, const void *sample)
+{
+    if (!m_valid || stream < 0 || stream >= m_streams.size())
+        return;
+    const QSensorReadingLayout *layout = m_streams.at(stream);
+
+    const quint64 timestamp = QSensorReadingLayout::timestamp(sample);
+    if (m_recordCount == 0) {
+        m_baseTimestamp = timestamp;
+        m_lastTimestamp = timestamp;
+    }
+    putVarint(m_records, quint64(stream));
+    putVarint(m_records, zigzagEncode(qint64(timestamp - m_lastTimestamp)));
+    m_lastTimestamp = timestamp;
+
+    const char *data = static_cast<const char *>(sample);
+    for (int i = 0; i < layout->fieldCount(); ++i) {
+        const QSensorReadingField &field = layout->field(i);
+        const char *value = data + field.offset;
+        switch (field.type) {
+        case QMetaType::Double: {
+            quint64 bits;
+            memcpy(&bits, value, sizeof(bits));
+            putLittleEndian(m_records, bits);
+            break;
+        }
+        case QMetaType::Float: {
+            quint32 bits;
+            memcpy(&bits, value, sizeof(bits));
+            putLittleEndian(m_records, bits);
+            break;
+        }
+        case QMetaType::Int: {
+            int v;
+            memcpy(&v, value, sizeof(v));
+            putVarint(m_records, zigzagEncode(v));
+            break;
+        }
+        case QMetaType::Bool: {
+            bool v;
+            memcpy(&v, value, sizeof(v));
+            m_records.append(char(v ? 1 : 0));
+            break;
+        }
+        default:
+            break;
+        }
+    }
+
+    ++m_recordCount;
+    if (m_records.size() >= m_chunkSize)
+        flush();
+}
+
+/*!
+    Writes the buffered records to the device as one data chunk.
+*/
+void QSensorRecorder::flush()
+{
+    if (!m_valid || m_recordCount == 0)
+        return;
+
+    // The chunk and data headers were reserved at the start of the buffer
+    char *header = m_records.data();
+    qToLittleEndian(dataTag, header);
+    qToLittleEndian(quint32(m_records.size() - chunkHeaderSize), header + 4);
+    qToLittleEndian(m_baseTimestamp, header + chunkHeaderSize);
+    qToLittleEndian(m_recordCount, header + chunkHeaderSize + 8);
+    if (m_device->write(m_records) != m_records.size()) {
+        qWarning() << "QSensorRecorder: write failed:" << m_device->errorString();
+        m_valid = false;
+    }
+
+    m_records.resize(chunkHeaderSize + dataHeaderSize);
+    m_recordCount = 0;
+}
+
+void QSensorRecorder::writeChunk(quint32 tag, const QByteArray &payload)
+{
+    if (!m_valid)
+        return;
+    QByteArray chunk;
+    chunk.reserve(chunkHeaderSize + payload.size());
+    putLittleEndian(chunk, tag);
+    putLittleEndian(chunk, quint32(payload.size()));
+    chunk.append(payload);
+    if (m_device->write(chunk) != chunk.size()) {
+        qWarning() << "QSensorRecorder: write failed:" << m_device->errorString();
+        m_valid = false;
+    }
+}
+
+/*!
+    Writes the binary \a recording to \a out in the line based text format
+    of the sensorclerk tool, one "name: timestamp,value,..." line per
+    reading. Returns false if the recording is invalid.
+*/
+bool QSensorRecorder::toText(const QByteArray &recording, QIODevice *out)
+{
+    QSensorRecordingReader reader(recording);
+    if (!reader.isValid() || !out)
+        return false;
+
+    // Per stream: the line prefix and which recorded values are written
+    QList<QByteArray> prefixes;
+    QList<QList<int>> columns;
+    for (const QSensorRecordingStream &stream : reader.streams()) {
+        const QSensorTextName *textName = textNameForType(stream.readingType);
+        prefixes.append((textName ? QByteArray(textName->name) : stream.readingType) + ": ");
+        QList<int> streamColumns;
+        for (int i = 0; i < stream.fields.size(); ++i) {
+            if (!textName || !textName->field || stream.fields.at(i).name == textName->field)
+                streamColumns.append(i);
+        }
+        columns.append(streamColumns);
+    }
+
+    QByteArray line;
+    while (reader.next()) {
+        const QSensorRecordingStream &stream = reader.streams().at(reader.stream());
+        line = prefixes.at(reader.stream());
+        line += QByteArray::number(reader.timestamp());
+        for (int column : columns.at(reader.stream())) {
+            line += ',';
+            const char kind = stream.fields.at(column).kind;
+            if (kind == 'd' || kind == 'f')
+                line += QByteArray::number(reader.value(column), 'g', QLocale::FloatingPointShortest);
+            else
+                line += QByteArray::number(qint64(reader.value(column)));
+        }
+        line += '\n';
+        if (out->write(line) != line.size())
+            return false;
+    }
+    return true;
+}
+
+/*!
+    Reads the sensorclerk text format from \a in and writes it to \a out as
+    a binary recording. Lines that cannot be parsed are skipped. Returns
+    false if the recording could not be written.
+*/
+bool QSensorRecorder::fromText(QIODevice *in, QIODevice *out)
+{
+    if (!in || !in->isReadable())
+        return false;
+    QSensorRecorder recorder(out);
+    if (!recorder.isValid())
+        return false;
+
+    struct TextStream
+    {
+        QByteArray name;
+        int stream;
+        const QSensorReadingLayout *layout;
+        QList<int> fields;
+    };
+    QList<TextStream> streams;
+    QVarLengthArray<quint64, 16> sample;
+    int skipped = 0;
+
+    while (!in->atEnd()) {
+        const QByteArray line = in->readLine().trimmed();
+        if (line.isEmpty())
+            continue;
+        const qsizetype colon = line.indexOf(':');
+        if (colon <= 0) {
+            ++skipped;
+            continue;
+        }
+        const QByteArray name = line.left(colon);
+
+        TextStream *stream = nullptr;
+        for (TextStream &candidate : streams) {
+            if (candidate.name == name) {
+                stream = &candidate;
+                break;
+            }
+        }
+        if (!stream) {
+            const QSensorTextName *textName = textNameForName(name);
+            const QSensorReadingLayout *layout =
+                    QSensorReadingLayout::forClassName(textName ? QByteArray(textName->readingType) : name);
+            if (!layout) {
+                ++skipped;
+                continue;
+            }
+            TextStream added = { name, recorder.addStream(layout->metaObject()), layout, {} };
+            for (int i = 0; i < layout->fieldCount(); ++i) {
+                if (!textName || !textName->field || qstrcmp(layout->field(i).name, textName->field) == 0)
+                    added.fields.append(i);
+            }
+            streams.append(added);
+            stream = &streams.last();
+        }
+
+        const QList<QByteArray> values = line.mid(colon + 1).trimmed().split(',');
+        if (values.size() != stream->fields.size() + 1) {
+            ++skipped;
+            continue;
+        }
+        sample.resize((stream->layout->sampleSize() + 7) / 8);
+        memset(sample.data(), 0, stream->layout->sampleSize());
+        bool ok = false;
+        QSensorReadingLayout::setTimestamp(sample.data(), values.at(0).trimmed().toULongLong(&ok));
+        for (int i = 0; ok && i < stream->fields.size(); ++i)
+            stream->layout->setValue(sample.data(), stream->fields.at(i), values.at(i + 1).trimmed().toDouble(&ok));
+        if (!ok) {
+            ++skipped;
+            continue;
+        }
+        recorder.recordSample(stream->stream, sample.data());
+    }
+
+    if (skipped)
+        qWarning() << "QSensorRecorder: skipped" << skipped << "malformed lines";
+    recorder.flush();
+    return recorder.isValid();
+}
+
+// =====================================================================
+
+/*!
+    \class QSensorRecordingReader
+    \internal
+
+    Decodes a recording written by QSensorRecorder from the \a size bytes at
+    \a data, for example a memory mapped file. All streams are known after
+    construction; next() then walks the records in the order they were
+    recorded.
+*/
+QSensorRecordingReader::QSensorRecordingReader(const char *data, qsizetype size)
+    : m_data(data)
+    , m_size(size)
+    , m_pos(fileHeaderSize)
+    , m_valid(false)
+    , m_chunk(nullptr)
+    , m_chunkEnd(nullptr)
+    , m_recordsLeft(0)
+    , m_stream(-1)
+    , m_timestamp(0)
+{
+    if (!m_data || m_size < fileHeaderSize || memcmp(m_data, recordingMagic, sizeof(recordingMagic)) != 0
+            || qFromLittleEndian<quint16>(m_data + 4) != recordingVersion) {
+        return;
+    }
+
+    // Collect the stream descriptions up front
+    qsizetype pos = fileHeaderSize;
+    while (m_size - pos >= chunkHeaderSize) {
+        const quint32 tag = qFromLittleEndian<quint32>(m_data + pos);
+        const quint32 size = qFromLittleEndian<quint32>(m_data + pos + 4);
+        if (size > quint64(m_size - pos - chunkHeaderSize))
+            break;
+        if (tag == streamTag && !readStreamChunk(m_data + pos + chunkHeaderSize, size))
+            return;
+        pos += chunkHeaderSize + size;
+    }
+    m_valid = true;
+}
+
+QSensorRecordingReader::QSensorRecordingReader(const QByteArray &recording)
+    : QSensorRecordingReader(recording.constData(), recording.size())
+{
+}
+
+bool QSensorRecordingReader::readStreamChunk(const char *data, qsizetype size)
+{
+    const char *p = data;
+    const char *end = data + size;
+    quint64 id;
+    quint64 fieldCount;
+    QSensorRecordingStream stream;
+    if (!getVarint(p, end, &id) || id != quint64(m_streams.size())
+            || !getString(p, end, &stream.readingType)
+            || !getString(p, end, &stream.identifier)
+            || !getVarint(p, end, &fieldCount)) {
+        return false;
+    }
+    stream.layout = QSensorReadingLayout::forClassName(stream.readingType);
+    for (quint64 i = 0; i < fieldCount; ++i) {
+        QSensorRecordingStream::Field field;
+        if (p == end)
+            return false;
+        field.kind = *p++;
+        if (!getString(p, end, &field.name))
+            return false;
+        if (field.kind != 'd' && field.kind != 'f' && field.kind != 'i' && field.kind != 'b')
+            return false;
+        stream.fields.append(field);
+        stream.layoutIndex.append(stream.layout ? stream.layout->indexOf(field.name.constData()) : -1);
+    }
+    m_streams.append(stream);
+    return true;
+}
+
+/*!
+    Moves to the next record. Returns false at the end of the recording.
+*/
+bool QSensorRecordingReader::next()
+{
+    if (!m_valid)
+        return false;
+
+    for (;;) {
+        while (m_recordsLeft == 0) {
+            if (m_size - m_pos < chunkHeaderSize)
+                return false;
+            const quint32 tag = qFromLittleEndian<quint32>(m_data + m_pos);
+            const quint32 size = qFromLittleEndian<quint32>(m_data + m_pos + 4);
+            if (size > quint64(m_size - m_pos - chunkHeaderSize))
+                return false; // truncated
+            const char *payload = m_data + m_pos + chunkHeaderSize;
+            m_pos += chunkHeaderSize + size;
+            if (tag != dataTag || size < quint32(dataHeaderSize))
+                continue;
+            m_timestamp = qFromLittleEndian<quint64>(payload);
+            m_recordsLeft = qFromLittleEndian<quint32>(payload + 8);
+            m_chunk = payload + dataHeaderSize;
+            m_chunkEnd = payload + size;
+        }
+
+        --m_recordsLeft;
+        quint64 stream;
+        quint64 delta;
+        if (!getVarint(m_chunk, m_chunkEnd, &stream) || stream >= quint64(m_streams.size())
+                || !getVarint(m_chunk, m_chunkEnd, &delta)) {
+            m_recordsLeft = 0; // skip the rest of a corrupt chunk
+            continue;
+        }
+
+        const QList<QSensorRecordingStream::Field> &fields = m_streams.at(qsizetype(stream)).fields;
+        m_values.resize(fields.size());
+        bool ok = true;
+        for (qsizetype i = 0; ok && i < fields.size(); ++i) {
+            switch (fields.at(i).kind) {
+            case 'd': {
+                if (m_chunkEnd - m_chunk < 8) {
+                    ok = false;
+                    break;
+                }
+                const quint64 bits = qFromLittleEndian<quint64>(m_chunk);
+                double value;
+                memcpy(&value, &bits, sizeof(value));
+                m_values[i] = qreal(value);
+                m_chunk += 8;
+                break;
+            }
+            case 'f': {
+                if (m_chunkEnd - m_chunk < 4) {
+                    ok = false;
+                    break;
+                }
+                const quint32 bits = qFromLittleEndian<quint32>(m_chunk);
+                float value;
+                memcpy(&value, &bits, sizeof(value));
+                m_values[i] = qreal(value);
+                m_chunk += 4;
+                break;
+            }
+            case 'i': {
+                quint64 value;
+                ok = getVarint(m_chunk, m_chunkEnd, &value);
+                m_values[i] = qreal(zigzagDecode(value));
+                break;
+            }
+            case 'b':
+                if (m_chunk == m_chunkEnd) {
+                    ok = false;
+                    break;
+                }
+                m_values[i] = *m_chunk++ ? 1 : 0;
+                break;
+            }
+        }
+        if (!ok) {
+            m_recordsLeft = 0;
+            continue;
+        }
+
+        m_stream = int(stream);
+        m_timestamp += quint64(zigzagDecode(delta));
+        return true;
+    }
+}
+
+/*!
+    Goes back to the first record.
+*/
+void QSensorRecordingReader::rewind()
+{
+    m_pos = fileHeaderSize;
+    m_chunk = nullptr;
+    m_chunkEnd = nullptr;
+    m_recordsLeft = 0;
+    m_stream = -1;
+    m_timestamp = 0;
+}
+
+/*!
+    Writes the current record into \a sample, which is laid out as described
+    by the QSensorReadingLayout of the record's stream. Returns false if the
+    reading type is not known in this process.
+*/
+bool QSensorRecordingReader::readSample(void *sample) const
+{
+    if (m_stream < 0)
+        return false;
+    const QSensorRecordingStream &stream = m_streams.at(m_stream);
+    if (!stream.layout)
+        return false;
+    memset(sample, 0, stream.layout->sampleSize());
+    QSensorReadingLayout::setTimestamp(sample, m_timestamp);
+    for (qsizetype i = 0; i < stream.layoutIndex.size(); ++i) {
+        if (stream.layoutIndex.at(i) >= 0)
+            stream.layout->setValue(sample, stream.layoutIndex.at(i), m_values.at(i));
+    }
+    return true;
+}
+
+/*!
+    Copies the current record into \a reading, which must be of the
+    stream's reading class.
+*/
+bool QSensorRecordingReader::readReading(QSensorReading *reading) const
+{
+    if (m_stream < 0 || !reading)
+        return false;
+    const QSensorReadingLayout *layout = m_streams.at(m_stream).layout;
+    if (!layout || layout->metaObject() != reading->metaObject())
+        return false;
+    QVarLengthArray<quint64, 16> sample((layout->sampleSize() + 7) / 8);
+    if (!readSample(sample.data()))
+        return false;
+    layout->write(reading, sample.data());
+    return true;
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,130 @@
+// Copyright (C) 2022 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef QSENSORRECORDER_P_H
+#define QSENSORRECORDER_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtSensors/qsensor.h>
+#include <QtCore/qbytearray.h>
+#include <QtCore/qlist.h>
+#include <QtCore/qvarlengtharray.h>
+
+QT_BEGIN_NAMESPACE
+
+class QIODevice;
+class QSensorReadingLayout;
+class QSensorRecorderFilter;
+
+// Description of one recorded stream, as found in the recording
+struct QSensorRecordingStream
+{
+    struct Field
+    {
+        QByteArray name;
+        char kind; // 'd' double, 'f' float, 'i' int, 'b' bool
+    };
+
+    QByteArray readingType; // class name of the reading, e.g. QAccelerometerReading
+    QByteArray identifier;  // backend identifier, may be empty
+    QList<Field> fields;
+    const QSensorReadingLayout *layout = nullptr; // nullptr if the type is unknown here
+    QList<int> layoutIndex; // layout field for each recorded field, or -1
+};
+
+// Writes readings in the append-only, chunked binary recording format.
+class Q_SENSORS_EXPORT QSensorRecorder
+{
+public:
+    enum { DefaultChunkSize = 64 * 1024 };
+
+    explicit QSensorRecorder(QIODevice *device, int chunkSize = DefaultChunkSize);
+    ~QSensorRecorder();
+
+    bool isValid() const { return m_valid; }
+
+    // Records every reading of sensor until the recorder is destroyed
+    bool attach(QSensor *sensor);
+    void detach(QSensor *sensor);
+
+    int addStream(const QMetaObject *readingType, const QByteArray &identifier = QByteArray());
+    void record(int stream, const QSensorReading *reading);
+    void recordSample(int stream, const void *sample);
+    void flush();
+
+    // Conversion from and to the text format written by sensorclerk
+    static bool toText(const QByteArray &recording, QIODevice *out);
+    static bool fromText(QIODevice *in, QIODevice *out);
+
+private:
+    void writeChunk(quint32 tag, const QByteArray &payload);
+
+    QIODevice *m_device;
+    int m_chunkSize;
+    bool m_valid;
+    QList<const QSensorReadingLayout *> m_streams;
+    QList<QSensorRecorderFilter *> m_filters;
+    QByteArray m_records;
+    quint32 m_recordCount;
+    quint64 m_baseTimestamp;
+    quint64 m_lastTimestamp;
+
+    Q_DISABLE_COPY(QSensorRecorder)
+};
+
+// Reads a recording from memory, record by record in recording order.
+// The data must stay valid while the reader is in use.
+class Q_SENSORS_EXPORT QSensorRecordingReader
+{
+public:
+    QSensorRecordingReader(const char *data, qsizetype size);
+    explicit QSensorRecordingReader(const QByteArray &recording);
+
+    bool isValid() const { return m_valid; }
+    const QList<QSensorRecordingStream> &streams() const { return m_streams; }
+
+    bool next();
+    void rewind();
+
+    // The current record
+    int stream() const { return m_stream; }
+    quint64 timestamp() const { return m_timestamp; }
+    int valueCount() const { return int(m_values.size()); }
+    qreal value(int index) const { return m_values.at(index); }
+
+    // Fills in a sample of the stream's reading layout
+    bool readSample(void *sample) const;
+    bool readReading(QSensorReading *reading) const;
+
+private:
+    bool readStreamChunk(const char *data, qsizetype size);
+
+    const char *m_data;
+    qsizetype m_size;
+    qsizetype m_pos;
+    bool m_valid;
+    QList<QSensorRecordingStream> m_streams;
+
+    // current data chunk
+    const char *m_chunk;
+    const char *m_chunkEnd;
+    quint64 m_recordsLeft;
+
+    int m_stream;
+    quint64 m_timestamp;
+    QVarLengthArray<qreal, 8> m_values;
+};
+
+QT_END_NAMESPACE
+
+#endif
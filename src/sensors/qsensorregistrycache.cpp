@@ -0,0 +1,182 @@
+// Copyright (C) 2022 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "qsensorregistrycache_p.h"
+
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QDebug>
+#include <QtCore/QDateTime>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QSaveFile>
+#include <QtCore/QStandardPaths>
+#include <QtCore/qcborarray.h>
+#include <QtCore/qcbormap.h>
+#include <QtCore/qcborvalue.h>
+
+QT_BEGIN_NAMESPACE
+
+/*
+    The cache is a CBOR map:
+
+    version      integer, cacheVersion
+    directories  array of [path, modification time]
+    plugins      array of maps: file, modified, size,
+                 backends (array of [type, identifier])
+
+    The directories are compared as well as the plugin files, so adding or
+    removing a plugin invalidates the cache on file systems that update the
+    modification time of a directory when its entries change.
+*/
+
+// Version 1 also recorded what undeclaring plugins registered
+static const int cacheVersion = 2;
+
+/*!
+    \class QSensorRegistryCache
+    \internal
+
+    Remembers which sensor plugins exist in the plugin directories and which
+    backends each of them declares in its metadata. The cache is only used
+    while neither the directories nor the plugin files have changed.
+
+    What a plugin registers is never recorded, because it may depend on the
+    hardware, the services or the environment of a run.
+*/
+QSensorRegistryCache::QSensorRegistryCache(const QString &fileName)
+    : m_fileName(fileName)
+{
+}
+
+/*!
+    Returns the backends listed in the \c Sensors array of the plugin
+    \a metaData, as pairs of type and identifier.
+*/
+QList<QPair<QByteArray, QByteArray>> QSensorRegistryCache::declaredBackends(const QCborMap &metaData)
+{
+    QList<QPair<QByteArray, QByteArray>> backends;
+    const QCborArray sensors = metaData.value(QLatin1String("Sensors")).toArray();
+    for (const QCborValue &sensor : sensors) {
+        const QCborMap backend = sensor.toMap();
+        const QByteArray type = backend.value(QLatin1String("Type")).toString().toLatin1();
+        const QByteArray identifier = backend.value(QLatin1String("Identifier")).toString().toLatin1();
+        if (type.isEmpty() || identifier.isEmpty()) {
+            qWarning() << "Invalid backend declaration in sensor plugin metadata" << metaData;
+            continue;
+        }
+        backends.append(qMakePair(type, identifier));
+    }
+    return backends;
+}
+
+/*!
+    Returns the name of the cache file for the plugin \a directories. Each
+    set of directories has its own file.
+*/
+QString QSensorRegistryCache::defaultFileName(const QStringList &directories)
+{
+    const QByteArray hash = QCryptographicHash::hash(directories.join(QLatin1Char('\n')).toUtf8(),
+                                                     QCryptographicHash::Sha1).toHex().left(16);
+    return QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation)
+            + QLatin1String("/qtsensors/registry-") + QString::fromLatin1(hash) + QLatin1String(".cbor");
+}
+
+/*!
+    Returns the modification time of \a path in milliseconds since the epoch,
+    or -1 if it does not exist.
+*/
+qint64 QSensorRegistryCache::modificationTime(const QString &path)
+{
+    const QFileInfo info(path);
+    if (!info.exists())
+        return -1;
+    return info.fileTime(QFileDevice::FileModificationTime).toMSecsSinceEpoch();
+}
+
+/*!
+    Reads the cache. Returns false if there is none, if it was written for
+    other \a directories or if a directory or plugin changed since.
+*/
+bool QSensorRegistryCache::read(const QStringList &directories)
+{
+    plugins.clear();
+    QFile file(m_fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+    const QCborMap root = QCborValue::fromCbor(file.readAll()).toMap();
+    if (root.value(QLatin1String("version")).toInteger() != cacheVersion)
+        return false;
+
+    const QCborArray cachedDirectories = root.value(QLatin1String("directories")).toArray();
+    if (cachedDirectories.size() != directories.size())
+        return false;
+    for (qsizetype i = 0; i < directories.size(); ++i) {
+        const QCborArray directory = cachedDirectories.at(i).toArray();
+        if (directory.at(0).toString() != directories.at(i)
+                || directory.at(1).toInteger() != modificationTime(directories.at(i))) {
+            return false;
+        }
+    }
+
+    const QCborArray cachedPlugins = root.value(QLatin1String("plugins")).toArray();
+    for (const QCborValue &value : cachedPlugins) {
+        const QCborMap map = value.toMap();
+        QSensorPluginRecord record;
+        record.fileName = map.value(QLatin1String("file")).toString();
+        record.modified = map.value(QLatin1String("modified")).toInteger();
+        record.size = map.value(QLatin1String("size")).toInteger();
+        const QFileInfo info(record.fileName);
+        if (!info.exists() || info.size() != record.size
+                || modificationTime(record.fileName) != record.modified) {
+            plugins.clear();
+            return false;
+        }
+        const QCborArray backends = map.value(QLatin1String("backends")).toArray();
+        for (const QCborValue &backend : backends) {
+            const QCborArray pair = backend.toArray();
+            record.backends.append(qMakePair(pair.at(0).toString().toLatin1(),
+                                             pair.at(1).toString().toLatin1()));
+        }
+        plugins.append(record);
+    }
+    return true;
+}
+
+/*!
+    Writes the cache for the plugin \a directories. Returns false if it
+    could not be written.
+*/
+bool QSensorRegistryCache::write(const QStringList &directories) const
+{
+    QCborArray cachedDirectories;
+    for (const QString &directory : directories)
+        cachedDirectories.append(QCborArray{ directory, modificationTime(directory) });
+
+    QCborArray cachedPlugins;
+    for (const QSensorPluginRecord &record : plugins) {
+        QCborArray backends;
+        for (const auto &backend : record.backends)
+            backends.append(QCborArray{ QString::fromLatin1(backend.first), QString::fromLatin1(backend.second) });
+        QCborMap map;
+        map.insert(QLatin1String("file"), record.fileName);
+        map.insert(QLatin1String("modified"), record.modified);
+        map.insert(QLatin1String("size"), record.size);
+        map.insert(QLatin1String("backends"), backends);
+        cachedPlugins.append(map);
+    }
+
+    QCborMap root;
+    root.insert(QLatin1String("version"), cacheVersion);
+    root.insert(QLatin1String("directories"), cachedDirectories);
+    root.insert(QLatin1String("plugins"), cachedPlugins);
+
+    QDir().mkpath(QFileInfo(m_fileName).absolutePath());
+    QSaveFile file(m_fileName);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+    file.write(root.toCborValue().toCbor());
+    return file.commit();
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,67 @@
+// Copyright (C) 2022 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef QSENSORREGISTRYCACHE_P_H
+#define QSENSORREGISTRYCACHE_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtSensors/qsensorsglobal.h>
+#include <QtCore/qlist.h>
+#include <QtCore/qpair.h>
+#include <QtCore/qstring.h>
+#include <QtCore/qstringlist.h>
+
+QT_BEGIN_NAMESPACE
+
+class QCborMap;
+
+// A sensor plugin and the backends its metadata declares. A plugin without
+// declarations is loaded at startup.
+struct QSensorPluginRecord
+{
+    QString fileName;
+    qint64 modified = 0; // msecs since epoch
+    qint64 size = 0;
+    QList<QPair<QByteArray, QByteArray>> backends; // type and identifier
+};
+
+// The sensor plugins found in the plugin directories and the backends they
+// declare, stored on disk so that later runs neither scan the directories
+// nor load declaring plugins before one of their backends is used.
+class Q_SENSORS_EXPORT QSensorRegistryCache
+{
+public:
+    explicit QSensorRegistryCache(const QString &fileName);
+
+    // The backends listed in the "Sensors" array of a plugin's metadata
+    static QList<QPair<QByteArray, QByteArray>> declaredBackends(const QCborMap &metaData);
+
+    QString fileName() const { return m_fileName; }
+
+    // The cache for these plugin directories in the user's cache location
+    static QString defaultFileName(const QStringList &directories);
+    static qint64 modificationTime(const QString &path);
+
+    // Returns false if the cache is missing or a directory or plugin changed
+    bool read(const QStringList &directories);
+    bool write(const QStringList &directories) const;
+
+    QList<QSensorPluginRecord> plugins;
+
+private:
+    QString m_fileName;
+};
+
+QT_END_NAMESPACE
+
+#endif
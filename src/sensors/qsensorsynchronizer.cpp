@@ -0,0 +1,354 @@
+// Copyright (C) 2022 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "qsensorsynchronizer_p.h"
+#include "qsensor_p.h"
+#include "qsensorreadinglayout_p.h"
+
+#include <QtCore/QDebug>
+
+#include <memory>
+
+QT_BEGIN_NAMESPACE
+
+struct QSensorSynchronizer::Stream
+{
+    const QSensorReadingLayout *layout;
+    QSensorReading *frameReading;
+    QSensorSynchronizerFilter *filter = nullptr;
+    int stride;   // size of a sample in quint64
+    int capacity; // samples in the ring
+    int first = 0;
+    int count = 0;
+    bool overflowed = false; // warned about a full ring
+    std::unique_ptr<quint64[]> ring;
+    std::unique_ptr<quint64[]> frame;
+
+    quint64 *sampleAt(int i) const { return ring.get() + size_t((first + i) % capacity) * stride; }
+    quint64 timestampAt(int i) const { return QSensorReadingLayout::timestamp(sampleAt(i)); }
+    quint64 lastTimestamp() const { return timestampAt(count - 1); }
+
+    void removeFirst()
+    {
+        first = (first + 1) % capacity;
+        --count;
+    }
+};
+
+class QSensorSynchronizerFilter : public QSensorFilter
+{
+public:
+    QSensorSynchronizerFilter(QSensorSynchronizer *synchronizer, int stream)
+        : m_synchronizer(synchronizer)
+        , m_stream(stream)
+    {
+    }
+
+    bool filter(QSensorReading *reading) override
+    {
+        m_synchronizer->addReading(m_stream, reading);
+        return true;
+    }
+
+private:
+    QSensorSynchronizer *m_synchronizer;
+    int m_stream;
+};
+
+static quint64 alignUp(quint64 timestamp, quint64 period)
+{
+    return (timestamp + period - 1) / period * period;
+}
+
+/*!
+    \class QSensorSynchronizer
+    \internal
+
+    Aligns the readings of several sensors in time. The readings of each
+    sensor are kept by timestamp in a ring buffer of fixed capacity. For every
+    point of a time grid with period() microseconds between the points, one
+    frame is built that holds a reading of every sensor at that time, and
+    frameAvailable() is emitted.
+
+    The values of a frame are interpolated between the readings right before
+    and right after the grid point, either by taking the nearer one or
+    linearly. Integer and boolean values and values that wrap around, like
+    angles, are never interpolated linearly.
+
+    A frame is normally built once every sensor has a reading at or after
+    its time. If a sensor falls behind by more than maxLatency()
+    microseconds, the frame is built anyway from its last reading, so a slow
+    or stalled sensor does not hold the others back. The same happens when
+    the ring of a sensor fills up before that, so that no reading a frame
+    still needs is lost. A capacity above the number of readings a sensor
+    delivers in maxLatency() avoids this.
+
+    No memory is allocated once the sensors have been added.
+*/
+QSensorSynchronizer::QSensorSynchronizer(QObject *parent)
+    : QObject(parent)
+    , m_period(10000)
+    , m_maxLatency(100000)
+    , m_interpolation(Linear)
+    , m_started(false)
+    , m_nextFrame(0)
+    , m_frameTimestamp(0)
+{
+}
+
+QSensorSynchronizer::~QSensorSynchronizer()
+{
+    for (Stream *stream : std::as_const(m_streams))
+        delete stream->filter;
+    qDeleteAll(m_streams);
+}
+
+/*!
+    Adds the readings of \a sensor, keeping up to \a capacity of them until
+    they are no longer needed for a frame. The sensor is connected to its
+    backend if necessary. Returns the stream of the sensor in the frames,
+    or -1 if its readings cannot be synchronized.
+
+    The grid is restarted when the sensor is stopped.
+*/
+int QSensorSynchronizer::addSensor(QSensor *sensor, int capacity)
+{
+    if (!sensor->connectToBackend())
+        return -1;
+    QSensorPrivate *sensorPrivate = QSensorPrivate::get(sensor);
+    const QSensorReadingLayout *layout = QSensorReadingLayout::forReading(sensor->reading());
+    if (!layout || !sensorPrivate->readingFactory) {
+        qWarning() << "QSensorSynchronizer: cannot synchronize readings of" << sensor->type();
+        return -1;
+    }
+
+    const int index = addStream(layout, sensorPrivate->readingFactory(this), capacity);
+    if (index < 0)
+        return -1;
+    Stream *stream = m_streams.at(index);
+    stream->filter = new QSensorSynchronizerFilter(this, index);
+    sensor->addFilter(stream->filter);
+    connect(sensor, &QSensor::activeChanged, this, [this, sensor] {
+        if (!sensor->isActive())
+            reset();
+    });
+    return index;
+}
+
+/*!
+    Adds a stream of samples described by \a layout, keeping up to
+    \a capacity of them. Takes ownership of \a frameReading, which must be
+    of the layout's reading type and receives the values of each frame.
+    Returns the stream, or -1.
+*/
+int QSensorSynchronizer::addStream(const QSensorReadingLayout *layout, QSensorReading *frameReading,
+                                   int capacity)
+{
+    if (capacity < 2) {
+        qWarning() << "QSensorSynchronizer: a stream needs a capacity of at least 2";
+        delete frameReading;
+        return -1;
+    }
+    frameReading->setParent(this);
+
+    Stream *stream = new Stream;
+    stream->layout = layout;
+    stream->frameReading = frameReading;
+    stream->stride = (layout->sampleSize() + int(sizeof(quint64)) - 1) / int(sizeof(quint64));
+    stream->capacity = capacity;
+    stream->ring.reset(new quint64[size_t(stream->stride) * capacity]());
+    stream->frame.reset(new quint64[stream->stride]());
+    m_streams.append(stream);
+    reset();
+    return int(m_streams.size()) - 1;
+}
+
+/*!
+    Sets the time between two frames to \a period microseconds. The grid is
+    restarted.
+*/
+void QSensorSynchronizer::setPeriod(quint64 period)
+{
+    if (period == 0) {
+        qWarning() << "QSensorSynchronizer: the period must not be 0";
+        return;
+    }
+    m_period = period;
+    reset();
+}
+
+/*!
+    Sets how far, in microseconds, the newest reading of any sensor may be
+    ahead of a frame before the frame is built without waiting for the
+    other sensors to \a maxLatency.
+*/
+void QSensorSynchronizer::setMaxLatency(quint64 maxLatency)
+{
+    m_maxLatency = maxLatency;
+}
+
+/*!
+    Adds \a reading to \a stream. Readings must arrive in the order of their
+    timestamps, older readings are dropped.
+*/
+void QSensorSynchronizer::addReading(int stream, const QSensorReading *reading)
+{
+    Stream *s = m_streams.at(stream);
+    // Read into the frame buffer, it is only needed while a frame is emitted
+    s->layout->read(reading, s->frame.get());
+    addSample(stream, s->frame.get());
+}
+
+/*!
+    Adds \a sample, which is laid out as the layout of \a stream describes,
+    to \a stream.
+*/
+void QSensorSynchronizer::addSample(int stream, const void *sample)
+{
+    Stream *s = m_streams.at(stream);
+    const quint64 timestamp = QSensorReadingLayout::timestamp(sample);
+    if (s->count > 0 && timestamp < s->lastTimestamp())
+        return;
+    if (s->count == s->capacity) {
+        // The oldest reading is needed for the next frame unless the reading
+        // after it is at or before the frame's time as well. Build the
+        // frames it is needed for now instead of losing it.
+        if (startGrid() && s->timestampAt(1) > m_nextFrame) {
+            if (!s->overflowed) {
+                qWarning() << "QSensorSynchronizer: the readings of stream" << stream
+                           << "overflow its capacity of" << s->capacity
+                           << "before the other streams catch up";
+                s->overflowed = true;
+            }
+            do {
+                if (!emitFrame())
+                    break;
+            } while (s->count == s->capacity && s->timestampAt(1) > m_nextFrame);
+        }
+        if (s->count == s->capacity)
+            s->removeFirst();
+    }
+    memcpy(s->sampleAt(s->count), sample, size_t(s->layout->sampleSize()));
+    ++s->count;
+    processFrames();
+}
+
+/*!
+    Drops all readings and restarts the grid at the next readings.
+*/
+void QSensorSynchronizer::reset()
+{
+    for (Stream *stream : std::as_const(m_streams)) {
+        stream->first = 0;
+        stream->count = 0;
+    }
+    m_started = false;
+}
+
+/*!
+    Returns the reading of \a stream in the current frame.
+*/
+QSensorReading *QSensorSynchronizer::frameReading(int stream) const
+{
+    return m_streams.at(stream)->frameReading;
+}
+
+/*!
+    Returns the sample of \a stream in the current frame.
+*/
+const void *QSensorSynchronizer::frameSample(int stream) const
+{
+    return m_streams.at(stream)->frame.get();
+}
+
+// Returns false until every stream has a reading
+bool QSensorSynchronizer::startGrid()
+{
+    for (const Stream *stream : std::as_const(m_streams)) {
+        if (stream->count == 0)
+            return false;
+    }
+
+    if (!m_started) {
+        // The first frame for which every sensor has a reading
+        quint64 start = 0;
+        for (const Stream *stream : std::as_const(m_streams))
+            start = qMax(start, stream->timestampAt(0));
+        m_nextFrame = alignUp(start, m_period);
+        m_started = true;
+    }
+    return true;
+}
+
+void QSensorSynchronizer::processFrames()
+{
+    if (!startGrid())
+        return;
+
+    for (;;) {
+        bool complete = true;
+        quint64 newest = 0;
+        for (const Stream *stream : std::as_const(m_streams)) {
+            const quint64 last = stream->lastTimestamp();
+            complete &= last >= m_nextFrame;
+            newest = qMax(newest, last);
+        }
+        if (!complete && newest < m_nextFrame + m_maxLatency)
+            return;
+        if (!emitFrame())
+            return;
+    }
+}
+
+// Builds and emits the frame at m_nextFrame. Returns false if a receiver
+// reset the synchronizer.
+bool QSensorSynchronizer::emitFrame()
+{
+    m_frameTimestamp = m_nextFrame;
+    for (Stream *stream : std::as_const(m_streams)) {
+        buildFrame(stream, m_frameTimestamp);
+        stream->layout->write(stream->frameReading, stream->frame.get());
+    }
+    m_nextFrame += m_period;
+
+    // Keep the newest reading before the next frame for interpolation
+    for (Stream *stream : std::as_const(m_streams)) {
+        while (stream->count > 1 && stream->timestampAt(1) <= m_nextFrame)
+            stream->removeFirst();
+    }
+
+    emit frameAvailable(m_frameTimestamp);
+    return m_started;
+}
+
+void QSensorSynchronizer::buildFrame(Stream *stream, quint64 timestamp)
+{
+    // The readings at or right before and right after the time of the frame
+    int after = 0;
+    while (after < stream->count && stream->timestampAt(after) < timestamp)
+        ++after;
+    const quint64 *a = stream->sampleAt(after > 0 ? after - 1 : 0);
+    const quint64 *b = stream->sampleAt(after < stream->count ? after : stream->count - 1);
+    const quint64 ta = QSensorReadingLayout::timestamp(a);
+    const quint64 tb = QSensorReadingLayout::timestamp(b);
+    const quint64 *nearest = (a == b || timestamp - ta <= tb - timestamp) ? a : b;
+
+    quint64 *frame = stream->frame.get();
+    memcpy(frame, nearest, size_t(stream->layout->sampleSize()));
+    QSensorReadingLayout::setTimestamp(frame, timestamp);
+    if (m_interpolation == Nearest || a == b || tb <= ta)
+        return;
+
+    const QSensorReadingLayout *layout = stream->layout;
+    const qreal t = qreal(timestamp - ta) / qreal(tb - ta);
+    for (int i = 0; i < layout->fieldCount(); ++i) {
+        const int type = layout->field(i).type;
+        if ((type != QMetaType::Double && type != QMetaType::Float) || layout->isPeriodic(i))
+            continue;
+        const qreal va = layout->value(a, i);
+        const qreal vb = layout->value(b, i);
+        layout->setValue(frame, i, va + (vb - va) * t);
+    }
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,90 @@
+// Copyright (C) 2022 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef QSENSORSYNCHRONIZER_P_H
+#define QSENSORSYNCHRONIZER_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtSensors/qsensor.h>
+#include <QtCore/qlist.h>
+
+QT_BEGIN_NAMESPACE
+
+class QSensorReadingLayout;
+class QSensorSynchronizerFilter;
+
+// Resamples the readings of several sensors onto one time grid, so that
+// code combining them gets one frame with a reading of every sensor per
+// grid point.
+class Q_SENSORS_EXPORT QSensorSynchronizer : public QObject
+{
+    Q_OBJECT
+public:
+    enum Interpolation {
+        Nearest,
+        Linear
+    };
+
+    enum { DefaultCapacity = 64 };
+
+    explicit QSensorSynchronizer(QObject *parent = nullptr);
+    ~QSensorSynchronizer() override;
+
+    // Returns the stream of the sensor in the frames, or -1
+    int addSensor(QSensor *sensor, int capacity = DefaultCapacity);
+    // For readings that do not come from a sensor, e.g. a recording
+    int addStream(const QSensorReadingLayout *layout, QSensorReading *frameReading,
+                  int capacity = DefaultCapacity);
+    int streamCount() const { return int(m_streams.size()); }
+
+    quint64 period() const { return m_period; }
+    void setPeriod(quint64 period);
+    quint64 maxLatency() const { return m_maxLatency; }
+    void setMaxLatency(quint64 maxLatency);
+    Interpolation interpolation() const { return m_interpolation; }
+    void setInterpolation(Interpolation interpolation) { m_interpolation = interpolation; }
+
+    void addReading(int stream, const QSensorReading *reading);
+    void addSample(int stream, const void *sample);
+    void reset();
+
+    // The current frame, valid while frameAvailable() is emitted
+    quint64 frameTimestamp() const { return m_frameTimestamp; }
+    QSensorReading *frameReading(int stream) const;
+    const void *frameSample(int stream) const;
+
+Q_SIGNALS:
+    void frameAvailable(quint64 timestamp);
+
+private:
+    struct Stream;
+
+    bool startGrid();
+    void processFrames();
+    bool emitFrame();
+    void buildFrame(Stream *stream, quint64 timestamp);
+
+    QList<Stream *> m_streams;
+    quint64 m_period;
+    quint64 m_maxLatency;
+    Interpolation m_interpolation;
+    bool m_started;
+    quint64 m_nextFrame;
+    quint64 m_frameTimestamp;
+
+    Q_DISABLE_COPY(QSensorSynchronizer)
+};
+
+QT_END_NAMESPACE
+
+#endif
@@ -0,0 +1,74 @@
+// Copyright (C) 2022 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "qsensortimestamptranslator_p.h"
+#include <QtCore/qdeadlinetimer.h>
+
+QT_BEGIN_NAMESPACE
+
+// How much of the drift measured over one window goes into the estimate
+static const double DriftGain = 0.25;
+
+void QSensorTimestampTranslator::reset()
+{
+    *this = QSensorTimestampTranslator();
+}
+
+quint64 QSensorTimestampTranslator::now()
+{
+    return QDeadlineTimer::current().deadlineNSecs() / 1000;
+}
+
+qint64 QSensorTimestampTranslator::offset(quint64 timestamp) const
+{
+    return m_anchorOffset + qint64(m_drift * double(qint64(timestamp) - m_anchorTime));
+}
+
+quint64 QSensorTimestampTranslator::translate(quint64 timestamp, quint64 arrival)
+{
+    const qint64 time = qint64(timestamp);
+    const qint64 difference = qint64(arrival) - time;
+    if (m_valid) {
+        // Replayed data, a reset clock or a suspended device
+        const qint64 error = difference - offset(timestamp);
+        if (time < m_windowStart || error > MaxJump || error < -MaxJump)
+            m_valid = false;
+    }
+    if (!m_valid) {
+        reset();
+        m_valid = true;
+        m_anchorTime = m_windowStart = m_windowMinTime = time;
+        m_anchorOffset = m_windowMin = difference;
+    }
+
+    if (difference < m_windowMin) {
+        m_windowMin = difference;
+        m_windowMinTime = time;
+    }
+    if (time - m_windowStart >= WindowLength) {
+        if (m_hasLastWindow && m_windowMinTime > m_lastMinTime) {
+            const double drift = double(m_windowMin - m_lastMin)
+                    / double(m_windowMinTime - m_lastMinTime);
+            m_drift = qBound(-MaxDrift, m_drift + DriftGain * (drift - m_drift), MaxDrift);
+        }
+        m_lastMin = m_windowMin;
+        m_lastMinTime = m_windowMinTime;
+        m_hasLastWindow = true;
+        // Follow the window minimum, which also lets the offset grow again
+        // after a reading that arrived quicker than any since
+        m_anchorTime = m_windowMinTime;
+        m_anchorOffset = m_windowMin;
+        m_windowStart = m_windowMinTime = time;
+        m_windowMin = difference;
+    }
+
+    qint64 translated = offset(timestamp);
+    if (translated > difference) {
+        // The reading can't have been taken after it arrived
+        m_anchorOffset -= translated - difference;
+        translated = difference;
+    }
+    return quint64(qMax<qint64>(0, time + translated));
+}
+
+QT_END_NAMESPACE
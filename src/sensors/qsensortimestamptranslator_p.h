@@ -0,0 +1,65 @@
+// Copyright (C) 2022 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef QSENSORTIMESTAMPTRANSLATOR_P_H
+#define QSENSORTIMESTAMPTRANSLATOR_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtSensors/qsensorsglobal.h>
+
+QT_BEGIN_NAMESPACE
+
+// Maps the timestamps of one backend's clock to microseconds of the
+// steady clock QDeadlineTimer uses, from the times the readings arrive.
+//
+// Arrival is always later than the reading by some latency, so the offset
+// between the clocks is the smallest arrival - timestamp difference seen.
+// It is taken once per window, and the change between windows gives the
+// drift of the backend's clock. Timestamps are never mapped to after their
+// arrival; a jump of the backend's clock starts the estimate over.
+class Q_SENSORS_EXPORT QSensorTimestampTranslator
+{
+public:
+    enum : qint64 {
+        WindowLength = 1000000, // in microseconds of the backend's clock
+        MaxJump = 1000000
+    };
+    static constexpr double MaxDrift = 0.001;
+
+    void reset();
+    quint64 translate(quint64 timestamp, quint64 arrival);
+
+    // The current time in the common domain
+    static quint64 now();
+
+    bool isValid() const { return m_valid; }
+    // Translated timestamp - backend timestamp, at the given backend time
+    qint64 offset(quint64 timestamp) const;
+    double drift() const { return m_drift; }
+
+private:
+    bool m_valid = false;
+    bool m_hasLastWindow = false;
+    qint64 m_anchorTime = 0;    // the offset is m_anchorOffset at m_anchorTime
+    qint64 m_anchorOffset = 0;
+    double m_drift = 0;         // change of the offset per microsecond
+    qint64 m_windowStart = 0;
+    qint64 m_windowMin = 0;     // smallest difference in the current window
+    qint64 m_windowMinTime = 0;
+    qint64 m_lastMin = 0;       // of the previous window
+    qint64 m_lastMinTime = 0;
+};
+
+QT_END_NAMESPACE
+
+#endif
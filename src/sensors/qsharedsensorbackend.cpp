@@ -0,0 +1,585 @@
+// Copyright (C) 2022 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "qsharedsensorbackend_p.h"
+#include "qsensor_p.h"
+#include "qsensorreadinglayout_p.h"
+
+#include "qaccelerometer.h"
+#include "qambientlightsensor.h"
+#include "qambienttemperaturesensor.h"
+#include "qcompass.h"
+#include "qgyroscope.h"
+#include "qhumiditysensor.h"
+#include "qirproximitysensor.h"
+#include "qlidsensor.h"
+#include "qlightsensor.h"
+#include "qmagnetometer.h"
+#include "qorientationsensor.h"
+#include "qpressuresensor.h"
+#include "qproximitysensor.h"
+#include "qrotationsensor.h"
+#include "qtapsensor.h"
+#include "qtiltsensor.h"
+
+#include <QtCore/qhash.h>
+#include <QtCore/qmetaobject.h>
+#include <QtCore/qmutex.h>
+#include <QtCore/qset.h>
+#include <QtCore/qthread.h>
+
+#include <algorithm>
+
+QT_BEGIN_NAMESPACE
+
+namespace {
+
+// Sensor classes of the module, so that the hidden sensor owning a shared
+// backend has the class the backend expects
+struct HostSensorType
+{
+    const char *type;
+    QSensor *(*create)();
+    // Copies state that the backend set on the hidden sensor
+    void (*sync)(const QSensor *host, QSensor *sensor);
+};
+
+template <typename T>
+QSensor *createHostSensor()
+{
+    return new T;
+}
+
+void syncRotationSensor(const QSensor *host, QSensor *sensor)
+{
+    if (QRotationSensor *rotationSensor = qobject_cast<QRotationSensor *>(sensor))
+        rotationSensor->setHasZ(static_cast<const QRotationSensor *>(host)->hasZ());
+}
+
+void syncLightSensor(const QSensor *host, QSensor *sensor)
+{
+    if (QLightSensor *lightSensor = qobject_cast<QLightSensor *>(sensor))
+        lightSensor->setFieldOfView(static_cast<const QLightSensor *>(host)->fieldOfView());
+}
+
+const HostSensorType *hostSensorType(const QByteArray &type)
+{
+    static const HostSensorType types[] = {
+        { QAccelerometer::sensorType, &createHostSensor<QAccelerometer>, nullptr },
+        { QAmbientLightSensor::sensorType, &createHostSensor<QAmbientLightSensor>, nullptr },
+        { QAmbientTemperatureSensor::sensorType, &createHostSensor<QAmbientTemperatureSensor>, nullptr },
+        { QCompass::sensorType, &createHostSensor<QCompass>, nullptr },
+        { QGyroscope::sensorType, &createHostSensor<QGyroscope>, nullptr },
+        { QHumiditySensor::sensorType, &createHostSensor<QHumiditySensor>, nullptr },
+        { QIRProximitySensor::sensorType, &createHostSensor<QIRProximitySensor>, nullptr },
+        { QLidSensor::sensorType, &createHostSensor<QLidSensor>, nullptr },
+        { QLightSensor::sensorType, &createHostSensor<QLightSensor>, &syncLightSensor },
+        { QMagnetometer::sensorType, &createHostSensor<QMagnetometer>, nullptr },
+        { QOrientationSensor::sensorType, &createHostSensor<QOrientationSensor>, nullptr },
+        { QPressureSensor::sensorType, &createHostSensor<QPressureSensor>, nullptr },
+        { QProximitySensor::sensorType, &createHostSensor<QProximitySensor>, nullptr },
+        { QRotationSensor::sensorType, &createHostSensor<QRotationSensor>, &syncRotationSensor },
+        { QTapSensor::sensorType, &createHostSensor<QTapSensor>, nullptr },
+        { QTiltSensor::sensorType, &createHostSensor<QTiltSensor>, nullptr },
+    };
+    for (const HostSensorType &t : types) {
+        if (type == t.type)
+            return &t;
+    }
+    return nullptr;
+}
+
+// Settings that each sensor applies in the core for itself, the hidden
+// sensor runs without them
+bool isAppliedPerSensor(const char *name)
+{
+    return qstrcmp(name, "accelerationMode") == 0;
+}
+
+// Settings that configure the backend. Sensors only share a backend if they
+// agree on them: the writable properties of the sensor class and the
+// dynamic properties, which some backends read.
+QList<QPair<QByteArray, QVariant>> backendSettings(const QSensor *sensor)
+{
+    QList<QPair<QByteArray, QVariant>> settings;
+    const QMetaObject *metaObject = sensor->metaObject();
+    for (int i = QSensor::staticMetaObject.propertyCount(); i < metaObject->propertyCount(); ++i) {
+        const QMetaProperty property = metaObject->property(i);
+        if (property.isWritable() && !isAppliedPerSensor(property.name()))
+            settings.append({ QByteArray(property.name()), property.read(sensor) });
+    }
+    const QList<QByteArray> names = sensor->dynamicPropertyNames();
+    for (const QByteArray &name : names)
+        settings.append({ name, sensor->property(name.constData()) });
+    return settings;
+}
+
+QByteArray hostKey(const QSensor *sensor, const QByteArray &identifier)
+{
+    QByteArray key = sensor->type() + '\n' + identifier + '\n'
+            + QByteArray::number(quintptr(QThread::currentThread()), 16);
+    const auto settings = backendSettings(sensor);
+    for (const auto &setting : settings)
+        key += '\n' + setting.first + '=' + setting.second.toString().toUtf8();
+    return key;
+}
+
+// Integer and boolean values, and values that wrap around, are taken from
+// the newest reading
+bool isAveraged(const QSensorReadingLayout *layout, int index)
+{
+    const int type = layout->field(index).type;
+    return (type == QMetaType::Double || type == QMetaType::Float) && !layout->isPeriodic(index);
+}
+
+} // namespace
+
+class QSharedSensorHost
+{
+public:
+    static QSharedSensorHost *create(const QByteArray &key, QSensor *sensor,
+                                     const QByteArray &identifier);
+    ~QSharedSensorHost();
+
+    void attach(QSharedSensorBackend *consumer) { consumers.append(consumer); }
+    void detach(QSharedSensorBackend *consumer);
+    void start(QSharedSensorBackend *consumer);
+    void stop(QSharedSensorBackend *consumer);
+
+    QByteArray key;
+    QSensor *sensor;
+    const HostSensorType *sensorType;
+    QList<QSharedSensorBackend *> consumers;
+    QList<QSharedSensorBackend *> activeConsumers;
+
+private:
+    QSharedSensorHost(const QByteArray &key, QSensor *sensor, const HostSensorType *sensorType);
+
+    bool applyConsumerSettings();
+    void readingChanged();
+    void readingsAvailable(const QList<QSensorReading *> &readings);
+    void busyChanged();
+    void sensorError(int error);
+    void endDelivery();
+
+    int deliveryDepth = 0;     // in a signal of the hidden sensor
+    bool orphaned = false;     // the last consumer went away during a delivery
+    bool blockDelivered = false;
+};
+
+struct QSharedSensorRegistry
+{
+    QMutex mutex;
+    QHash<QByteArray, QSharedSensorHost *> hosts;
+    QSet<const QSensor *> hostSensors;
+};
+
+Q_GLOBAL_STATIC(QSharedSensorRegistry, sharedSensorRegistry)
+
+QSharedSensorHost::QSharedSensorHost(const QByteArray &key, QSensor *sensor,
+                                     const HostSensorType *sensorType)
+    : key(key)
+    , sensor(sensor)
+    , sensorType(sensorType)
+{
+    QObject::connect(sensor, &QSensor::readingChanged, sensor, [this] { readingChanged(); });
+    QObject::connect(sensor, &QSensor::readingsAvailable, sensor,
+                     [this](const QList<QSensorReading *> &readings) { readingsAvailable(readings); });
+    QObject::connect(sensor, &QSensor::busyChanged, sensor, [this] { busyChanged(); });
+    QObject::connect(sensor, &QSensor::sensorError, sensor, [this](int error) { sensorError(error); });
+}
+
+QSharedSensorHost *QSharedSensorHost::create(const QByteArray &key, QSensor *sensor,
+                                             const QByteArray &identifier)
+{
+    QSharedSensorRegistry *registry = sharedSensorRegistry();
+    const HostSensorType *sensorType = hostSensorType(sensor->type());
+    QSensor *hostSensor = sensorType ? sensorType->create() : new QSensor(sensor->type());
+    hostSensor->setIdentifier(identifier);
+    const auto settings = backendSettings(sensor);
+    for (const auto &setting : settings)
+        hostSensor->setProperty(setting.first.constData(), setting.second);
+    // Nobody filters the readings of the hidden sensor, so publish them as they are
+    hostSensor->setZeroCopyReadings(true);
+
+    {
+        QMutexLocker locker(&registry->mutex);
+        registry->hostSensors.insert(hostSensor);
+    }
+    if (!hostSensor->connectToBackend()
+            || !QSensorPrivate::get(hostSensor)->readingFactory) {
+        {
+            QMutexLocker locker(&registry->mutex);
+            registry->hostSensors.remove(hostSensor);
+        }
+        delete hostSensor;
+        return nullptr;
+    }
+
+    QSharedSensorHost *host = new QSharedSensorHost(key, hostSensor, sensorType);
+    QMutexLocker locker(&registry->mutex);
+    registry->hosts.insert(key, host);
+    return host;
+}
+
+QSharedSensorHost::~QSharedSensorHost()
+{
+    QObject::disconnect(sensor, nullptr, sensor, nullptr);
+    sensor->stop();
+    if (QSharedSensorRegistry *registry = sharedSensorRegistry()) {
+        QMutexLocker locker(&registry->mutex);
+        registry->hostSensors.remove(sensor);
+    }
+    // The hidden sensor is still emitting if the last sensor went away
+    // during a delivery
+    if (orphaned)
+        sensor->deleteLater();
+    else
+        delete sensor;
+}
+
+void QSharedSensorHost::detach(QSharedSensorBackend *consumer)
+{
+    consumers.removeOne(consumer);
+    activeConsumers.removeOne(consumer);
+    if (!consumers.isEmpty())
+        return;
+
+    // New sensors must not find the host any more
+    if (QSharedSensorRegistry *registry = sharedSensorRegistry()) {
+        QMutexLocker locker(&registry->mutex);
+        registry->hosts.remove(key);
+    }
+    if (deliveryDepth > 0)
+        orphaned = true;
+    else
+        delete this;
+}
+
+// Runs the hardware with the most demanding settings of the active sensors
+bool QSharedSensorHost::applyConsumerSettings()
+{
+    int dataRate = 0;
+    bool alwaysOn = false;
+    for (const QSharedSensorBackend *consumer : std::as_const(activeConsumers)) {
+        const QSensor *consumerSensor = consumer->sensor();
+        dataRate = qMax(dataRate, consumerSensor->dataRate());
+        alwaysOn |= consumerSensor->isAlwaysOn();
+    }
+
+    const bool changed = dataRate != sensor->dataRate()
+            || alwaysOn != sensor->isAlwaysOn();
+    sensor->setDataRate(dataRate);
+    sensor->setAlwaysOn(alwaysOn);
+    for (QSharedSensorBackend *consumer : std::as_const(activeConsumers))
+        consumer->setSourceRate(dataRate);
+    return changed;
+}
+
+void QSharedSensorHost::start(QSharedSensorBackend *consumer)
+{
+    if (!activeConsumers.contains(consumer))
+        activeConsumers.append(consumer);
+
+    // Settings only take effect when the backend is started
+    if (applyConsumerSettings() && sensor->isActive())
+        sensor->stop();
+    if (!sensor->isActive())
+        sensor->start();
+
+    if (sensor->isBusy())
+        consumer->sensorBusy();
+    else if (!sensor->isActive())
+        consumer->sensorStopped();
+}
+
+void QSharedSensorHost::stop(QSharedSensorBackend *consumer)
+{
+    activeConsumers.removeOne(consumer);
+    if (activeConsumers.isEmpty()) {
+        sensor->stop();
+    } else if (applyConsumerSettings()) {
+        // The remaining sensors may be served at a lower rate
+        sensor->stop();
+        sensor->start();
+    }
+}
+
+void QSharedSensorHost::readingChanged()
+{
+    // readingChanged() follows readingsAvailable() with the newest reading
+    // of the block, which has been delivered already
+    if (blockDelivered) {
+        blockDelivered = false;
+        return;
+    }
+
+    ++deliveryDepth;
+    QSensorReading *reading = sensor->reading();
+    // A sensor may be stopped or destroyed by one that got the reading before
+    const QList<QSharedSensorBackend *> receivers = activeConsumers;
+    for (QSharedSensorBackend *consumer : receivers) {
+        if (activeConsumers.contains(consumer))
+            consumer->deliver(reading);
+    }
+    endDelivery();
+}
+
+void QSharedSensorHost::readingsAvailable(const QList<QSensorReading *> &readings)
+{
+    ++deliveryDepth;
+    blockDelivered = true;
+    const QList<QSharedSensorBackend *> receivers = activeConsumers;
+    for (QSharedSensorBackend *consumer : receivers) {
+        if (!activeConsumers.contains(consumer))
+            continue;
+        consumer->beginReadingBatch();
+        for (QSensorReading *reading : readings)
+            consumer->deliver(reading);
+        if (activeConsumers.contains(consumer))
+            consumer->endReadingBatch();
+    }
+    endDelivery();
+}
+
+void QSharedSensorHost::busyChanged()
+{
+    ++deliveryDepth;
+    const bool busy = sensor->isBusy();
+    const QList<QSharedSensorBackend *> receivers = consumers;
+    for (QSharedSensorBackend *consumer : receivers) {
+        if (consumers.contains(consumer))
+            consumer->sensorBusy(busy);
+    }
+    endDelivery();
+}
+
+void QSharedSensorHost::sensorError(int error)
+{
+    ++deliveryDepth;
+    const QList<QSharedSensorBackend *> receivers = consumers;
+    for (QSharedSensorBackend *consumer : receivers) {
+        if (consumers.contains(consumer))
+            consumer->sensorError(error);
+    }
+    endDelivery();
+}
+
+void QSharedSensorHost::endDelivery()
+{
+    if (--deliveryDepth == 0 && orphaned)
+        delete this;
+}
+
+/*!
+    \class QSharedSensorBackend
+    \internal
+
+    Backend of a sensor whose hardware backend is shared. Sensors of the same
+    type, identifier and backend settings in the same thread share one
+    hardware backend. It is owned by a hidden sensor of the same class, which
+    is created for the first of them and destroyed with the last one.
+
+    The hidden sensor runs while at least one of the sharing sensors is
+    active, at the highest data rate any of them asked for. Every reading is
+    copied into the device reading of each active sensor, which then runs its
+    own filters and batching.
+
+    A sensor that asked for a lower data rate gets exactly that rate: for
+    every N readings of the hidden sensor, where N is the hidden sensor's
+    data rate, it receives as many readings as its own data rate. Each
+    delivered reading is the average of the readings since
+    the previous one, which keeps the higher frequencies from aliasing into
+    the slower signal. Integer and boolean values, and angles like the
+    compass azimuth, which wrap around, are taken from the newest reading
+    instead.
+
+    Sensors opt in to sharing with QSensor::sharedBackend.
+*/
+
+/*!
+    Returns the shared backend for \a sensor, or nullptr if no backend for
+    it can be created. The hidden sensor is created if this is the first
+    sensor of its kind.
+*/
+QSharedSensorBackend *QSharedSensorBackend::create(QSensor *sensor)
+{
+    QSharedSensorRegistry *registry = sharedSensorRegistry();
+    if (!registry || isHostSensor(sensor))
+        return nullptr;
+
+    QByteArray identifier = sensor->identifier();
+    if (identifier.isEmpty())
+        identifier = QSensor::defaultSensorForType(sensor->type());
+    if (identifier.isEmpty())
+        return nullptr;
+
+    const QByteArray key = hostKey(sensor, identifier);
+    QSharedSensorHost *host;
+    {
+        QMutexLocker locker(&registry->mutex);
+        host = registry->hosts.value(key);
+    }
+    if (!host)
+        host = QSharedSensorHost::create(key, sensor, identifier);
+    if (!host)
+        return nullptr;
+
+    sensor->setIdentifier(host->sensor->identifier()); // as for any other backend
+    if (host->sensorType && host->sensorType->sync)
+        host->sensorType->sync(host->sensor, sensor);
+    return new QSharedSensorBackend(sensor, host);
+}
+
+/*!
+    Returns true if \a sensor is one of the hidden sensors that own a shared
+    hardware backend.
+*/
+bool QSharedSensorBackend::isHostSensor(const QSensor *sensor)
+{
+    QSharedSensorRegistry *registry = sharedSensorRegistry();
+    if (!registry)
+        return false;
+    QMutexLocker locker(&registry->mutex);
+    return registry->hostSensors.contains(sensor);
+}
+
+QSharedSensorBackend::QSharedSensorBackend(QSensor *sensor, QSharedSensorHost *host)
+    : QSensorBackend(sensor)
+    , m_host(host)
+{
+    QSensor *hostSensor = host->sensor;
+    QSensorPrivate *sensorPrivate = QSensorPrivate::get(sensor);
+    QSensorReadingFactory factory = QSensorPrivate::get(hostSensor)->readingFactory;
+    sensorPrivate->device_reading = factory(this);
+    sensorPrivate->filter_reading = factory(this);
+    sensorPrivate->cache_reading = factory(this);
+    sensorPrivate->readingFactory = factory;
+
+    setDataRates(hostSensor);
+    const qoutputrangelist outputRanges = hostSensor->outputRanges();
+    for (const qoutputrange &range : outputRanges)
+        addOutputRange(range.minimum, range.maximum, range.accuracy);
+    setDescription(hostSensor->description());
+
+    m_layout = QSensorReadingLayout::forReading(sensorPrivate->device_reading);
+    if (m_layout) {
+        m_sample.resize((m_layout->sampleSize() + int(sizeof(quint64)) - 1) / int(sizeof(quint64)));
+        m_sums.resize(m_layout->fieldCount());
+    }
+
+    host->attach(this);
+}
+
+QSharedSensorBackend::~QSharedSensorBackend()
+{
+    m_host->detach(this);
+}
+
+void QSharedSensorBackend::start()
+{
+    m_sourceRate = 0;
+    m_rate = 0;
+    m_host->start(this);
+}
+
+void QSharedSensorBackend::stop()
+{
+    m_host->stop(this);
+}
+
+// Decimates if this sensor asked for a lower rate than the shared backend runs at
+void QSharedSensorBackend::setSourceRate(int sourceRate)
+{
+    const int rate = sensor()->dataRate();
+    const int decimatedRate = (rate > 0 && sourceRate > rate) ? rate : 0;
+    if (sourceRate == m_sourceRate && decimatedRate == m_rate)
+        return;
+    m_sourceRate = sourceRate;
+    m_rate = decimatedRate;
+    m_interval = m_rate > 0 ? 1000000 / quint64(m_rate) : 0;
+    // The first reading is delivered right away
+    m_hasDue = false;
+    m_pending = 0;
+    std::fill(m_sums.begin(), m_sums.end(), 0);
+}
+
+bool QSharedSensorBackend::isFeatureSupported(QSensor::Feature feature) const
+{
+    switch (feature) {
+    case QSensor::Buffering:
+        // The hidden sensor does not buffer, the sensors collect their own blocks
+        return false;
+    case QSensor::SkipDuplicates:
+        // The hidden sensor delivers every reading, each sensor skips
+        // duplicates by its own setting
+        return false;
+    case QSensor::AccelerationMode:
+        // The hidden sensor reports the combined acceleration, each sensor
+        // separates gravity by its own mode
+        return false;
+    default:
+        break;
+    }
+    // Ask the hardware backend, features the core emulates for the hidden
+    // sensor are not available to the sensors sharing it
+    const QSensorBackend *backend = QSensorPrivate::get(m_host->sensor)->backend;
+    return backend && backend->isFeatureSupported(feature);
+}
+
+QSensor *QSharedSensorBackend::hostSensor() const
+{
+    return m_host->sensor;
+}
+
+void QSharedSensorBackend::deliver(QSensorReading *reading)
+{
+    QSensorPrivate *sensorPrivate = QSensorPrivate::get(sensor());
+    if (m_rate == 0) {
+        sensorPrivate->setDeviceReadingValues(reading);
+        newReadingAvailable();
+        return;
+    }
+
+    if (m_layout) {
+        void *sample = m_sample.data();
+        m_layout->read(reading, sample);
+        for (int i = 0; i < m_sums.size(); ++i) {
+            if (isAveraged(m_layout, i))
+                m_sums[i] += m_layout->value(sample, i);
+        }
+    }
+    ++m_pending;
+
+    // Backends rarely run at exactly their nominal rate, so the readings are
+    // timed by their timestamps rather than counted
+    const quint64 timestamp = reading->timestamp();
+    if (m_hasDue && timestamp < m_due && timestamp + m_interval >= m_due)
+        return;
+    if (m_hasDue && timestamp >= m_due && timestamp < m_due + m_interval) {
+        // Keep to the grid of due times, so that late readings don't
+        // lower the rate
+        m_due += m_interval;
+    } else {
+        // The first reading, a gap in the readings or a clock that went back
+        m_due = timestamp + m_interval;
+        m_hasDue = true;
+    }
+
+    if (m_layout) {
+        // The sample holds the newest reading, replace what is averaged
+        void *sample = m_sample.data();
+        for (int i = 0; i < m_sums.size(); ++i) {
+            if (isAveraged(m_layout, i))
+                m_layout->setValue(sample, i, m_sums[i] / m_pending);
+            m_sums[i] = 0;
+        }
+        m_layout->write(sensorPrivate->device_reading, sample);
+    } else {
+        sensorPrivate->setDeviceReadingValues(reading);
+    }
+    m_pending = 0;
+    newReadingAvailable();
+}
+
+QT_END_NAMESPACE
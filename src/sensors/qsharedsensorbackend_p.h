@@ -0,0 +1,74 @@
+// Copyright (C) 2022 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef QSHAREDSENSORBACKEND_P_H
+#define QSHAREDSENSORBACKEND_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtSensors/qsensorbackend.h>
+#include <QtCore/qvarlengtharray.h>
+
+QT_BEGIN_NAMESPACE
+
+class QSensorReadingLayout;
+class QSharedSensorHost;
+
+// Backend of a sensor that shares the hardware backend with the other
+// sensors of the same type and identifier. Every reading of the shared
+// backend is copied into this sensor's device reading, so each sensor still
+// runs its own filters and batching. A sensor that asked for a lower data
+// rate than the shared backend runs at gets the average of the readings in
+// each of its periods instead.
+class Q_SENSORS_EXPORT QSharedSensorBackend : public QSensorBackend
+{
+    Q_OBJECT
+public:
+    // Returns nullptr if the sensor cannot use a shared backend
+    static QSharedSensorBackend *create(QSensor *sensor);
+    // True for the hidden sensors that own the shared hardware backends
+    static bool isHostSensor(const QSensor *sensor);
+
+    ~QSharedSensorBackend() override;
+
+    void start() override;
+    void stop() override;
+    bool isFeatureSupported(QSensor::Feature feature) const override;
+
+    // The hidden sensor that owns the hardware backend
+    QSensor *hostSensor() const;
+
+private:
+    QSharedSensorBackend(QSensor *sensor, QSharedSensorHost *host);
+
+    void setSourceRate(int sourceRate);
+    void deliver(QSensorReading *reading);
+
+    QSharedSensorHost *m_host;
+
+    // Decimation from the rate of the shared backend to the rate of this sensor
+    int m_sourceRate = 0;
+    int m_rate = 0;                      // 0 if every reading is delivered
+    quint64 m_interval = 0;              // between delivered readings, in microseconds
+    quint64 m_due = 0;                   // timestamp of the next reading to deliver
+    bool m_hasDue = false;               // false until the first reading is delivered
+    int m_pending = 0;                   // readings averaged since the last delivery
+    const QSensorReadingLayout *m_layout = nullptr; // nullptr if the readings have no layout
+    QVarLengthArray<quint64, 16> m_sample;
+    QVarLengthArray<qreal, 8> m_sums;
+
+    friend class QSharedSensorHost;
+};
+
+QT_END_NAMESPACE
+
+#endif
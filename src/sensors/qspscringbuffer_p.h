@@ -0,0 +1,89 @@
+// Copyright (C) 2022 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef QSPSCRINGBUFFER_P_H
+#define QSPSCRINGBUFFER_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtCore/qglobal.h>
+
+#include <atomic>
+#include <memory>
+#include <type_traits>
+
+QT_BEGIN_NAMESPACE
+
+// Fixed-capacity, wait-free ring buffer for exactly one producer thread and
+// one consumer thread. The capacity is rounded up to a power of two and no
+// memory is allocated after construction.
+template <typename T>
+class QSpscRingBuffer
+{
+    static_assert(std::is_trivially_copyable_v<T>, "QSpscRingBuffer only holds trivially copyable samples");
+public:
+    explicit QSpscRingBuffer(qsizetype capacity)
+    {
+        qsizetype size = 1;
+        while (size < capacity)
+            size <<= 1;
+        m_data.reset(new T[size]);
+        m_mask = size - 1;
+    }
+
+    qsizetype capacity() const { return m_mask + 1; }
+
+    // Number of queued samples. Exact only when called from the producer or
+    // consumer thread while the other side is idle.
+    qsizetype size() const
+    {
+        return qsizetype(m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire));
+    }
+
+    bool isEmpty() const { return size() == 0; }
+
+    // Producer side. Returns false if the ring is full.
+    bool push(const T &value)
+    {
+        const size_t head = m_head.load(std::memory_order_relaxed);
+        if (head - m_tail.load(std::memory_order_acquire) > size_t(m_mask))
+            return false;
+        m_data[head & m_mask] = value;
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side. Returns false if the ring is empty.
+    bool pop(T *value)
+    {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail == m_head.load(std::memory_order_acquire))
+            return false;
+        *value = m_data[tail & m_mask];
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    Q_DISABLE_COPY_MOVE(QSpscRingBuffer)
+
+    std::unique_ptr<T[]> m_data;
+    qsizetype m_mask = 0;
+    // Keep the indices on separate cache lines so the two threads don't
+    // invalidate each other's line on every sample
+    alignas(64) std::atomic<size_t> m_head = 0; // written by the producer
+    alignas(64) std::atomic<size_t> m_tail = 0; // written by the consumer
+};
+
+QT_END_NAMESPACE
+
+#endif
@@ -0,0 +1,82 @@
+// Copyright (C) 2022 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "qthreadsafesensorbackend_p.h"
+#include "qsensor_p.h"
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QEvent>
+
+QT_BEGIN_NAMESPACE
+
+static QEvent::Type drainEventType()
+{
+    static const int type = QEvent::registerEventType();
+    return QEvent::Type(type);
+}
+
+/*!
+    \class QThreadSafeSensorBackendBase
+    \internal
+
+    Common part of QThreadSafeSensorBackend. Coalesces wake-ups from the
+    producer thread so that at most one drain event is queued at any time,
+    and counts the samples that were dropped because the ring was full.
+*/
+
+QThreadSafeSensorBackendBase::QThreadSafeSensorBackendBase(QSensor *sensor, QObject *parent)
+    : QSensorBackend(sensor, parent)
+{
+}
+
+QThreadSafeSensorBackendBase::~QThreadSafeSensorBackendBase()
+{
+}
+
+void QThreadSafeSensorBackendBase::wakeUp()
+{
+    // Only the first sample after a drain posts an event
+    if (!m_wakeUpPending.exchange(true, std::memory_order_acq_rel))
+        QCoreApplication::postEvent(this, new QEvent(drainEventType()));
+}
+
+void QThreadSafeSensorBackendBase::sampleDropped()
+{
+    m_droppedSamples.fetch_add(1, std::memory_order_relaxed);
+    // The sensor's statistics count it as well
+    QSensorStatisticsCounters::add(QSensorPrivate::get(sensor())->statistics.dropped, 1);
+}
+
+bool QThreadSafeSensorBackendBase::event(QEvent *event)
+{
+    if (event->type() == drainEventType()) {
+        // Clear the flag first: samples pushed while draining either get
+        // picked up by this drain or schedule the next one
+        m_wakeUpPending.store(false, std::memory_order_release);
+        drainSamples();
+        return true;
+    }
+    return QSensorBackend::event(event);
+}
+
+/*!
+    \class QThreadSafeSensorBackend
+    \internal
+
+    Backend base class for sensors whose data arrives on a thread other than
+    the backend's own. The producer calls pushSample() with a trivially
+    copyable sample; samples are stored in a fixed-capacity single-producer,
+    single-consumer ring buffer and converted into readings by
+    processSample() in the backend's thread, followed by one call to
+    samplesProcessed() for all of them. Several queued samples are
+    delivered as one batch, see QSensorBackend::beginReadingBatch().
+    A wake-up only handles the samples that were queued when it started,
+    samples pushed meanwhile are handled by the next one.
+
+    If the consumer falls behind and the ring is full, new samples are
+    dropped and counted in droppedSamples() and QSensor::statistics().
+*/
+
+QT_END_NAMESPACE
+
+#include "moc_qthreadsafesensorbackend_p.cpp"
@@ -0,0 +1,114 @@
+// Copyright (C) 2022 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef QTHREADSAFESENSORBACKEND_P_H
+#define QTHREADSAFESENSORBACKEND_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtSensors/qsensorbackend.h>
+#include "qspscringbuffer_p.h"
+
+#include <atomic>
+
+QT_BEGIN_NAMESPACE
+
+class Q_SENSORS_EXPORT QThreadSafeSensorBackendBase : public QSensorBackend
+{
+    Q_OBJECT
+public:
+    ~QThreadSafeSensorBackendBase() override;
+
+    quint64 droppedSamples() const { return m_droppedSamples.load(std::memory_order_relaxed); }
+    void resetDroppedSamples() { m_droppedSamples.store(0, std::memory_order_relaxed); }
+
+protected:
+    explicit QThreadSafeSensorBackendBase(QSensor *sensor, QObject *parent = nullptr);
+
+    // producer side, callable from any thread
+    void wakeUp();
+    void sampleDropped();
+
+    // consumer side, runs in the thread of the backend
+    virtual void drainSamples() = 0;
+    bool event(QEvent *event) override;
+
+private:
+    std::atomic<bool> m_wakeUpPending = false;
+    std::atomic<quint64> m_droppedSamples = 0;
+};
+
+// Backend building block for data that arrives on a foreign thread. The
+// producer pushes plain samples into a lock-free ring, and the backend's own
+// thread is woken up once to convert everything that is queued into readings.
+template <typename Sample>
+class QThreadSafeSensorBackend : public QThreadSafeSensorBackendBase
+{
+public:
+    enum { DefaultCapacity = 256 };
+
+    explicit QThreadSafeSensorBackend(QSensor *sensor, QObject *parent = nullptr,
+                                      qsizetype capacity = DefaultCapacity)
+        : QThreadSafeSensorBackendBase(sensor, parent)
+        , m_samples(capacity)
+    {
+    }
+
+    // Must always be called from the same producer thread.
+    // Returns false if the ring overflowed and the sample was dropped.
+    bool pushSample(const Sample &sample)
+    {
+        if (!m_samples.push(sample)) {
+            sampleDropped();
+            return false;
+        }
+        wakeUp();
+        return true;
+    }
+
+    qsizetype sampleCapacity() const { return m_samples.capacity(); }
+
+protected:
+    // Called in the backend's thread for every queued sample, in order
+    virtual void processSample(const Sample &sample) = 0;
+    // Called once after the samples queued at a wake-up were processed,
+    // for backends that compute one reading from several samples
+    virtual void samplesProcessed() {}
+
+private:
+    void drainSamples() override
+    {
+        // What is queued up to now is delivered as one block. Samples the
+        // producer pushes meanwhile wait for the next wake-up, so that a
+        // fast producer cannot keep this thread draining forever.
+        const qsizetype count = m_samples.size();
+        if (count == 0)
+            return;
+        const bool batch = count > 1;
+        if (batch)
+            beginReadingBatch();
+        Sample sample;
+        for (qsizetype i = 0; i < count && m_samples.pop(&sample); ++i)
+            processSample(sample);
+        samplesProcessed();
+        if (batch)
+            endReadingBatch();
+        if (!m_samples.isEmpty())
+            wakeUp();
+    }
+
+    QSpscRingBuffer<Sample> m_samples;
+};
+
+QT_END_NAMESPACE
+
+#endif
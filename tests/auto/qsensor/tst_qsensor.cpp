@@ -6,16 +6,36 @@
 #include <QtCore/QObject>
 #include <QTest>
 #include <QtCore/QDebug>
+#include <QtCore/QBuffer>
+#include <QtCore/QDeadlineTimer>
+#include <QtCore/QDir>
 #include <QtCore/QFile>
 #include <QSignalSpy>
+#include <QtCore/QPointer>
+#include <QtCore/QRegularExpression>
+#include <QtCore/QScopeGuard>
+#include <QtCore/QTemporaryDir>
+#include <QtCore/QThread>
 #include <QtSensors/QSensorManager>
+#include <QtSensors/qsensorplugin.h>
 
 #include "qsensor.h"
 #include "test_sensor.h"
+#include "test_sensor_p.h"
 #include "test_sensor2.h"
 #include "test_sensorimpl.h"
 #include "../common/test_backends.h"
 
+#include <QtSensors/private/qsensorreadinglayout_p.h>
+#include <QtSensors/private/qsensorrecorder_p.h>
+#include <QtSensors/private/qsensorregistrycache_p.h>
+#include <QtSensors/private/qsensorsynchronizer_p.h>
+#include <QtSensors/private/qsensortimestamptranslator_p.h>
+#include <QtSensors/private/qsharedsensorbackend_p.h>
+#include <QtSensors/private/qthreadsafesensorbackend_p.h>
+
+#include <atomic>
+
 QT_BEGIN_NAMESPACE
 
 bool operator==(const qoutputrange &orl1, const qoutputrange &orl2)
@@ -47,6 +67,15 @@ class ModFilter : public TestSensorFilter
     }
 };
 
+class DropFirstBatchFilter : public QSensorBatchFilter
+{
+    bool filter(QList<QSensorReading *> &readings) override
+    {
+        readings.removeFirst();
+        return true;
+    }
+};
+
 class MyFactory : public QSensorBackendFactory
 {
     QSensorBackend *createBackend(QSensor * /*sensor*/) override
@@ -55,6 +84,109 @@ class MyFactory : public QSensorBackendFactory
     }
 };
 
+struct ThreadedTestSample
+{
+    quint64 timestamp;
+    int test;
+};
+
+class ThreadedTestBackend : public QThreadSafeSensorBackend<ThreadedTestSample>
+{
+public:
+    ThreadedTestBackend(QSensor *sensor)
+        : QThreadSafeSensorBackend<ThreadedTestSample>(sensor, nullptr, 4)
+    {
+        setReading<TestSensorReading>(&m_reading);
+    }
+
+    void start() override {}
+    void stop() override {}
+
+protected:
+    void processSample(const ThreadedTestSample &sample) override
+    {
+        m_reading.setTimestamp(sample.timestamp);
+        m_reading.setTest(sample.test);
+        newReadingAvailable();
+        // Acts as a producer that keeps up with the backend
+        if (refills > 0) {
+            --refills;
+            pushSample({sample.timestamp + 1, sample.test + 1});
+        }
+    }
+    void samplesProcessed() override { ++drains; }
+
+public:
+    int drains = 0;
+    int refills = 0;
+
+private:
+    TestSensorReading m_reading;
+};
+
+class ThreadedTestFactory : public QSensorBackendFactory
+{
+public:
+    QSensorBackend *createBackend(QSensor *sensor) override
+    {
+        lastBackend = new ThreadedTestBackend(sensor);
+        return lastBackend;
+    }
+
+    ThreadedTestBackend *lastBackend = nullptr;
+};
+
+// An accelerometer that cannot be started
+class FailingAccelerometerBackend : public QSensorBackend
+{
+public:
+    FailingAccelerometerBackend(QSensor *sensor)
+        : QSensorBackend(sensor)
+    {
+        setReading<QAccelerometerReading>(&m_reading);
+    }
+
+    void start() override { sensorStopped(); }
+    void stop() override {}
+
+private:
+    QAccelerometerReading m_reading;
+};
+
+class FailingAccelerometerFactory : public QSensorBackendFactory
+{
+public:
+    QSensorBackend *createBackend(QSensor *sensor) override
+    {
+        return new FailingAccelerometerBackend(sensor);
+    }
+};
+
+Q_SENSORS_EXPORT void qt_sensors_declare_plugin(QObject *plugin,
+                                                const QList<QPair<QByteArray, QByteArray>> &backends);
+
+// Declares more backends than it registers
+class DeclaredTestPlugin : public QObject, public QSensorPluginInterface, public QSensorBackendFactory
+{
+    Q_OBJECT
+    Q_INTERFACES(QSensorPluginInterface)
+public:
+    void registerSensors() override
+    {
+        ++loads;
+        QSensorManager::registerBackend(QAccelerometer::sensorType, "declared.accelerometer", this);
+    }
+
+    QSensorBackend *createBackend(QSensor *sensor) override
+    {
+        ++created;
+        return new QAccelerometer_impl(sensor);
+    }
+
+    int loads = 0;
+    int created = 0;
+};
+
 /*
     Unit test for QSensor class.
 */
@@ -441,6 +573,564 @@ private slots:
         delete filter1;
     }
 
+    void testZeroCopyReadings()
+    {
+        TestSensor sensor;
+        sensor.setProperty("doThis", "setOne");
+        QSignalSpy spy(&sensor, SIGNAL(readingChanged()));
+        QVERIFY(!sensor.zeroCopyReadings());
+        sensor.connectToBackend();
+        TestSensorReading *cached = sensor.reading();
+
+        // Without filters the backend reading is published as-is
+        sensor.setZeroCopyReadings(true);
+        sensor.start();
+        QCOMPARE(spy.count(), 1);
+        TestSensorReading *direct = sensor.reading();
+        QVERIFY(direct != cached);
+        QCOMPARE(direct->test(), 1);
+        sensor.stop();
+
+        // Adding a filter falls back to the cached, filtered reading
+        TestSensorFilter *filter = new ModFilter;
+        sensor.addFilter(filter);
+        QCOMPARE(sensor.reading(), cached);
+        QCOMPARE(sensor.reading()->test(), 1);
+        sensor.start();
+        QCOMPARE(spy.count(), 2);
+        QCOMPARE(sensor.reading()->test(), 3);
+        QCOMPARE(direct->test(), 1);
+        sensor.stop();
+
+        // Without the filter the cache stays published until the next reading
+        delete filter;
+        QCOMPARE(sensor.reading(), cached);
+        QCOMPARE(sensor.reading()->test(), 3);
+        sensor.start();
+        QCOMPARE(sensor.reading(), direct);
+        QCOMPARE(sensor.reading()->test(), 1);
+        sensor.stop();
+
+        // Switching back keeps the last published values
+        sensor.setZeroCopyReadings(false);
+        QCOMPARE(sensor.reading(), cached);
+        QCOMPARE(sensor.reading()->test(), 1);
+    }
+
+    void testZeroCopyFallback()
+    {
+        class RejectAll : public QAccelerometerFilter
+        {
+            bool filter(QAccelerometerReading *) override { return false; }
+        };
+
+        register_test_backends();
+        QAccelerometer accelerometer;
+        accelerometer.setIdentifier("QAccelerometer");
+        accelerometer.setZeroCopyReadings(true);
+        QVERIFY(accelerometer.start());
+        QAccelerometerReading *direct = accelerometer.reading();
+        QCOMPARE(direct->x(), 1.0);
+
+        // A rejected reading does not become visible when the filter is removed
+        RejectAll filter;
+        accelerometer.addFilter(&filter);
+        set_test_backend_reading(&accelerometer, {{"x", 2.0}});
+        QCOMPARE(accelerometer.reading()->x(), 1.0);
+        accelerometer.removeFilter(&filter);
+        QVERIFY(accelerometer.reading() != direct);
+        QCOMPARE(accelerometer.reading()->x(), 1.0);
+        set_test_backend_reading(&accelerometer, {{"x", 3.0}});
+        QCOMPARE(accelerometer.reading(), direct);
+        QCOMPARE(accelerometer.reading()->x(), 3.0);
+        accelerometer.stop();
+
+        // Nor does a raw reading when stop() ends the gravity separation
+        accelerometer.setAccelerationMode(QAccelerometer::User);
+        QVERIFY(accelerometer.start());
+        QCOMPARE(accelerometer.reading()->x(), 0.0);
+        set_test_backend_reading(&accelerometer, {{"timestamp", 10000}, {"x", 5.0}});
+        const qreal userX = accelerometer.reading()->x();
+        QVERIFY(userX > 0.0 && userX < 4.0);
+        accelerometer.stop();
+        QCOMPARE(accelerometer.reading()->x(), userX);
+
+        // The next reading without separation is published directly again
+        accelerometer.setAccelerationMode(QAccelerometer::Combined);
+        QVERIFY(accelerometer.start());
+        QCOMPARE(accelerometer.reading(), accelerometer.backend()->reading());
+        QCOMPARE(accelerometer.reading()->x(), 1.0);
+        accelerometer.stop();
+        unregister_test_backends();
+    }
+
+    void testBatchedReadings()
+    {
+        register_test_backends();
+        QAccelerometer accelerometer;
+        accelerometer.setIdentifier("QAccelerometer");
+        accelerometer.setBufferSize(3);
+        QSignalSpy readingSpy(&accelerometer, SIGNAL(readingChanged()));
+        QList<qreal> delivered;
+        connect(&accelerometer, &QSensor::readingsAvailable, this,
+                [&delivered](const QList<QSensorReading *> &readings) {
+            for (QSensorReading *reading : readings)
+                delivered << static_cast<QAccelerometerReading *>(reading)->x();
+        });
+
+        // The test backend delivers x = 1 when started
+        QVERIFY(accelerometer.start());
+        set_test_backend_reading(&accelerometer, {{"x", 2.0}});
+        QVERIFY(delivered.isEmpty());
+        QCOMPARE(readingSpy.count(), 0);
+        set_test_backend_reading(&accelerometer, {{"x", 3.0}});
+        QCOMPARE(delivered, QList<qreal>() << 1.0 << 2.0 << 3.0);
+        QCOMPARE(readingSpy.count(), 1);
+        QCOMPARE(accelerometer.reading()->x(), 3.0);
+
+        // A partial buffer is dropped on stop
+        set_test_backend_reading(&accelerometer, {{"x", 4.0}});
+        accelerometer.stop();
+        delivered.clear();
+
+        // Batch filters see and may shrink the whole block
+        DropFirstBatchFilter filter;
+        accelerometer.addBatchFilter(&filter);
+        QCOMPARE(accelerometer.batchFilters(), QList<QSensorBatchFilter *>() << &filter);
+        QVERIFY(accelerometer.start());
+        set_test_backend_reading(&accelerometer, {{"x", 5.0}});
+        set_test_backend_reading(&accelerometer, {{"x", 6.0}});
+        QCOMPARE(delivered, QList<qreal>() << 5.0 << 6.0);
+        QCOMPARE(readingSpy.count(), 2);
+        accelerometer.stop();
+        accelerometer.removeBatchFilter(&filter);
+        QVERIFY(accelerometer.batchFilters().isEmpty());
+        unregister_test_backends();
+    }
+
+    void testThreadSafeBackend()
+    {
+        ThreadedTestFactory factory;
+        QSensorManager::registerBackend(TestSensor::sensorType, "test sensor threaded", &factory);
+        TestSensor sensor;
+        sensor.setIdentifier("test sensor threaded");
+        QVERIFY(sensor.connectToBackend());
+        ThreadedTestBackend *backend = factory.lastBackend;
+        QVERIFY(backend);
+        QCOMPARE(backend->sampleCapacity(), qsizetype(4));
+
+        QList<int> delivered;
+        connect(&sensor, &QSensor::readingsAvailable, this,
+                [&delivered](const QList<QSensorReading *> &readings) {
+            for (QSensorReading *reading : readings)
+                delivered << static_cast<TestSensorReading *>(reading)->test();
+        });
+        QVERIFY(sensor.start());
+
+        // The producer overruns the ring before the backend thread gets to drain it
+        QThread *producer = QThread::create([backend] {
+            for (int i = 1; i <= 10; ++i)
+                backend->pushSample({quint64(i), i});
+        });
+        producer->start();
+        QVERIFY(producer->wait());
+        delete producer;
+        QCOMPARE(backend->droppedSamples(), quint64(6));
+
+        // Queued samples arrive in order as a single block
+        QTRY_COMPARE(delivered, QList<int>() << 1 << 2 << 3 << 4);
+        QCOMPARE(sensor.reading()->test(), 4);
+        QCOMPARE(backend->drains, 1);
+        backend->resetDroppedSamples();
+        QCOMPARE(backend->droppedSamples(), quint64(0));
+
+        // Samples pushed while draining wait for the next wake-up
+        QList<int> changed;
+        connect(&sensor, &QSensor::readingChanged, this,
+                [&changed, &sensor] { changed << sensor.reading()->test(); });
+        backend->refills = 2;
+        backend->pushSample({5, 5});
+        QTRY_COMPARE(changed, QList<int>() << 5 << 6 << 7);
+        QCOMPARE(backend->drains, 4);
+        QCOMPARE(delivered.size(), 4);
+
+        sensor.stop();
+        QSensorManager::unregisterBackend(TestSensor::sensorType, "test sensor threaded");
+    }
+
+    void testThreadedBackend()
+    {
+        TestSensor sensor;
+        QCOMPARE(sensor.threadedBackend(), false);
+        sensor.setThreadedBackend(true);
+        QVERIFY(sensor.connectToBackend());
+        QTest::ignoreMessage(QtWarningMsg, "ERROR: Cannot call QSensor::setThreadedBackend while connected to a backend!");
+        sensor.setThreadedBackend(false);
+        QVERIFY(sensor.threadedBackend());
+
+        // Errors reported while starting are visible when start() returns
+        sensor.setProperty("doThis", "error");
+        QVERIFY(sensor.start());
+        QCOMPARE(sensor.error(), 1);
+        sensor.stop();
+
+        // Readings reach the sensor's thread through its event loop
+        QSignalSpy readingSpy(&sensor, SIGNAL(readingChanged()));
+        sensor.setProperty("doThis", "setOne");
+        QVERIFY(sensor.start());
+        QTRY_COMPARE(readingSpy.count(), 1);
+        QCOMPARE(sensor.reading()->timestamp(), quint64(1));
+        QCOMPARE(sensor.reading()->test(), 1);
+        sensor.stop();
+    }
+
+    void testDeliveryPolicy()
+    {
+        TestSensor sensor;
+        sensor.setThreadedBackend(true);
+        QCOMPARE(sensor.deliveryPolicy(), QSensor::DeliverAll);
+        QCOMPARE(sensor.deliveryQueueSize(), 64);
+        QTest::ignoreMessage(QtWarningMsg, "setDeliveryQueueSize: invalid size 0");
+        sensor.setDeliveryQueueSize(0);
+        QCOMPARE(sensor.deliveryQueueSize(), 64);
+
+        QSignalSpy policySpy(&sensor, SIGNAL(deliveryPolicyChanged(QSensor::DeliveryPolicy)));
+        sensor.setDeliveryPolicy(QSensor::DeliverLatest);
+        QCOMPARE(policySpy.count(), 1);
+        QSignalSpy readingSpy(&sensor, SIGNAL(readingChanged()));
+        QList<qsizetype> batches;
+        connect(&sensor, &QSensor::readingsAvailable, this,
+                [&batches](const QList<QSensorReading *> &readings) { batches << readings.size(); });
+        QVERIFY(sensor.start());
+        QTRY_COMPARE(readingSpy.count(), 1);
+
+        // No events are processed meanwhile, so the readings pile up
+        for (int i = 0; i < 5; ++i)
+            sensor.backend()->newReadingAvailable();
+        QTRY_COMPARE(readingSpy.count(), 2);
+        QVERIFY(batches.isEmpty());
+        QCOMPARE(sensor.statistics().readingsCoalesced, quint64(4));
+
+        // The oldest readings make room for new ones
+        sensor.setDeliveryPolicy(QSensor::DropOldest);
+        sensor.setDeliveryQueueSize(2);
+        for (int i = 0; i < 5; ++i)
+            sensor.backend()->newReadingAvailable();
+        QTRY_COMPARE(readingSpy.count(), 3);
+        QCOMPARE(batches, QList<qsizetype>({ 2 }));
+        QCOMPARE(sensor.statistics().readingsDropped, quint64(3));
+
+        // Every reading is delivered
+        sensor.setDeliveryPolicy(QSensor::DeliverAll);
+        for (int i = 0; i < 5; ++i)
+            sensor.backend()->newReadingAvailable();
+        QTRY_COMPARE(readingSpy.count(), 4);
+        QCOMPARE(batches, QList<qsizetype>({ 2, 5 }));
+        QCOMPARE(sensor.statistics().readingsDelivered, quint64(1 + 1 + 2 + 5));
+        sensor.stop();
+    }
+
+    void testBlockBackend()
+    {
+        QPointer<QThread> blockingThread;
+        {
+            TestSensor blocking;
+            blocking.setThreadedBackend(true);
+            blocking.setDeliveryPolicy(QSensor::BlockBackend);
+            blocking.setDeliveryQueueSize(1);
+            TestSensor other;
+            other.setThreadedBackend(true);
+            QVERIFY(blocking.start());
+            QVERIFY(other.start());
+
+            // The blocking backend waits in a thread of its own
+            blockingThread = blocking.backend()->thread();
+            QVERIFY(blockingThread != QThread::currentThread());
+            QVERIFY(blockingThread != other.backend()->thread());
+            QTRY_COMPARE(blocking.statistics().readingsDelivered, quint64(1));
+
+            // No events are processed meanwhile, so the backend waits for room
+            // after its first reading
+            std::atomic<int> reported(0);
+            QSensorBackend *backend = blocking.backend();
+            QMetaObject::invokeMethod(backend, [backend, &reported] {
+                for (int i = 0; i < 3; ++i) {
+                    backend->newReadingAvailable();
+                    ++reported;
+                }
+            }, Qt::QueuedConnection);
+            QDeadlineTimer deadline(5000);
+            while (reported.load() < 1 && !deadline.hasExpired())
+                QThread::msleep(1);
+            QThread::msleep(50);
+            QCOMPARE(reported.load(), 1);
+
+            // Calls into the other sensor's backend are not held up
+            other.stop();
+            QVERIFY(other.start());
+            QCOMPARE(reported.load(), 1);
+
+            // Delivering the readings lets the backend go on, none is lost
+            QTRY_COMPARE(reported.load(), 3);
+            QTRY_COMPARE(blocking.statistics().readingsDelivered, quint64(4));
+            QCOMPARE(blocking.statistics().readingsDropped, quint64(0));
+
+            // A call into the waiting backend itself does not deadlock either
+            QMetaObject::invokeMethod(backend, [backend, &reported] {
+                for (int i = 0; i < 3; ++i) {
+                    backend->newReadingAvailable();
+                    ++reported;
+                }
+            }, Qt::QueuedConnection);
+            deadline = QDeadlineTimer(5000);
+            while (reported.load() < 4 && !deadline.hasExpired())
+                QThread::msleep(1);
+            blocking.stop();
+            QCOMPARE(reported.load(), 6);
+            other.stop();
+        }
+        // and the thread ends with the sensor
+        QVERIFY(blockingThread.isNull());
+    }
+
+    void testSharedBackend()
+    {
+        QPointer<QSensor> hostSensor;
+        {
+            TestSensor first;
+            first.setSharedBackend(true);
+            TestSensor second;
+            second.setSharedBackend(true);
+            QVERIFY(first.connectToBackend());
+            QVERIFY(second.connectToBackend());
+            auto *firstBackend = qobject_cast<QSharedSensorBackend *>(first.backend());
+            auto *secondBackend = qobject_cast<QSharedSensorBackend *>(second.backend());
+            QVERIFY(firstBackend);
+            QVERIFY(secondBackend);
+            QCOMPARE(firstBackend->hostSensor(), secondBackend->hostSensor());
+            hostSensor = firstBackend->hostSensor();
+
+            // Only the sensors that opted in share the backend
+            TestSensor own;
+            QVERIFY(own.connectToBackend());
+            QVERIFY(!qobject_cast<QSharedSensorBackend *>(own.backend()));
+            QTest::ignoreMessage(QtWarningMsg, "ERROR: Cannot call QSensor::setSharedBackend while connected to a backend!");
+            first.setSharedBackend(false);
+            QVERIFY(first.sharedBackend());
+            QCOMPARE(first.identifier(), QByteArray(testsensorimpl::id));
+            QCOMPARE(second.description(), QString("sensor description"));
+            QCOMPARE(second.outputRanges().size(), 2);
+
+            // The backend delivers test = 2 when started
+            QSignalSpy firstSpy(&first, SIGNAL(readingChanged()));
+            QSignalSpy secondSpy(&second, SIGNAL(readingChanged()));
+            QVERIFY(first.start());
+            QCOMPARE(firstSpy.count(), 1);
+            QCOMPARE(first.reading()->test(), 2);
+            QVERIFY(second.start());
+            QVERIFY(hostSensor->isActive());
+
+            // One reading of the backend reaches every active sensor
+            hostSensor->backend()->newReadingAvailable();
+            QCOMPARE(firstSpy.count(), 2);
+            QCOMPARE(secondSpy.count(), 1);
+            QCOMPARE(second.reading()->test(), 2);
+
+            // Each sensor has filters of its own
+            MyFilter filter;
+            second.addFilter(&filter);
+            hostSensor->backend()->newReadingAvailable();
+            QCOMPARE(firstSpy.count(), 3);
+            QCOMPARE(secondSpy.count(), 1);
+            second.removeFilter(&filter);
+
+            // The backend runs until the last sensor stops
+            first.stop();
+            QVERIFY(hostSensor->isActive());
+            hostSensor->backend()->newReadingAvailable();
+            QCOMPARE(firstSpy.count(), 3);
+            QCOMPARE(secondSpy.count(), 2);
+            second.stop();
+            QVERIFY(!hostSensor->isActive());
+        }
+        QVERIFY(hostSensor.isNull());
+    }
+
+    void testSharedBackendDecimation()
+    {
+        register_test_backends();
+        auto guard = qScopeGuard([] { unregister_test_backends(); });
+        QAccelerometer fast;
+        fast.setIdentifier("QAccelerometer");
+        fast.setSharedBackend(true);
+        fast.setDataRate(100);
+        QAccelerometer slow;
+        slow.setIdentifier("QAccelerometer");
+        slow.setSharedBackend(true);
+        slow.setDataRate(25);
+        QSignalSpy fastSpy(&fast, SIGNAL(readingChanged()));
+        QSignalSpy slowSpy(&slow, SIGNAL(readingChanged()));
+        QVERIFY(fast.start());
+        QVERIFY(slow.start());
+        QSensor *hostSensor = qobject_cast<QSharedSensorBackend *>(slow.backend())->hostSensor();
+        QCOMPARE(hostSensor->dataRate(), 100);
+        fastSpy.clear();
+
+        // The slow sensor gets its first reading right away and then the
+        // average of the readings of every 40 ms
+        for (int i = 1; i <= 8; ++i)
+            set_test_backend_reading(hostSensor, {{"timestamp", 10000 * i}, {"x", qreal(i)}});
+        QCOMPARE(fastSpy.count(), 8);
+        QCOMPARE(fast.reading()->x(), 8.0);
+        QCOMPARE(slowSpy.count(), 2);
+        QCOMPARE(slow.reading()->x(), 3.5);
+
+        // Readings are timed by their timestamps, not counted
+        set_test_backend_reading(hostSensor, {{"timestamp", 85000}, {"x", 9.0}});
+        QCOMPARE(slowSpy.count(), 2);
+        set_test_backend_reading(hostSensor, {{"timestamp", 90000}, {"x", 10.0}});
+        QCOMPARE(slowSpy.count(), 3);
+        QCOMPARE(slow.reading()->x(), 8.0);
+
+        // After a gap the next reading is delivered right away
+        set_test_backend_reading(hostSensor, {{"timestamp", 400000}, {"x", 11.0}});
+        QCOMPARE(slowSpy.count(), 4);
+        QCOMPARE(slow.reading()->x(), 11.0);
+        set_test_backend_reading(hostSensor, {{"timestamp", 410000}, {"x", 12.0}});
+        QCOMPARE(slowSpy.count(), 4);
+
+        // The backend slows down once the fast sensor is gone
+        fast.stop();
+        QCOMPARE(hostSensor->dataRate(), 25);
+        QVERIFY(hostSensor->isActive());
+        slowSpy.clear();
+        set_test_backend_reading(hostSensor, {{"x", 9.0}});
+        QCOMPARE(slowSpy.count(), 1);
+        QCOMPARE(slow.reading()->x(), 9.0);
+    }
+
+    void testSharedBackendOptInDecimation()
+    {
+        register_test_backends();
+        auto guard = qScopeGuard([] { unregister_test_backends(); });
+        QAccelerometer slow;
+        slow.setIdentifier("QAccelerometer");
+        slow.setSharedBackend(true);
+        slow.setDataRate(10);
+        QAccelerometer fast;
+        fast.setIdentifier("QAccelerometer");
+        fast.setSharedBackend(true);
+        fast.setDataRate(200);
+
+        // The backend restarts at the higher rate when the fast sensor
+        // joins, the slow sensor gets the reading of the restart
+        QVERIFY(slow.start());
+        QSensor *hostSensor = qobject_cast<QSharedSensorBackend *>(slow.backend())->hostSensor();
+        QCOMPARE(hostSensor->dataRate(), 10);
+        QVERIFY(fast.start());
+        QCOMPARE(qobject_cast<QSharedSensorBackend *>(fast.backend())->hostSensor(), hostSensor);
+        QCOMPARE(hostSensor->dataRate(), 200);
+        QSignalSpy fastSpy(&fast, SIGNAL(readingChanged()));
+        QSignalSpy slowSpy(&slow, SIGNAL(readingChanged()));
+
+        // One second at 200 Hz: the fast sensor gets every reading, the slow
+        // one every 100 ms the average of the 20 readings since its last one
+        for (int i = 1; i <= 200; ++i)
+            set_test_backend_reading(hostSensor, {{"timestamp", 5000 * i}, {"x", qreal(i)}});
+        QCOMPARE(fastSpy.count(), 200);
+        QCOMPARE(fast.reading()->x(), 200.0);
+        QCOMPARE(slowSpy.count(), 9);
+        QCOMPARE(slow.reading()->timestamp(), quint64(905000));
+        QCOMPARE(slow.reading()->x(), 171.5);
+        QCOMPARE(slow.reading()->y(), 1.0);
+
+        // Alone, the slow sensor slows the backend down and gets every reading
+        fast.stop();
+        QCOMPARE(hostSensor->dataRate(), 10);
+        slowSpy.clear();
+        set_test_backend_reading(hostSensor, {{"timestamp", 1100000}, {"x", 1.0}});
+        set_test_backend_reading(hostSensor, {{"timestamp", 1200000}, {"x", 2.0}});
+        QCOMPARE(slowSpy.count(), 2);
+        QCOMPARE(slow.reading()->x(), 2.0);
+        slow.stop();
+    }
+
+    void testSharedBackendSkipDuplicates()
+    {
+        register_test_backends();
+        auto guard = qScopeGuard([] { unregister_test_backends(); });
+        QAccelerometer skipping;
+        skipping.setIdentifier("QAccelerometer");
+        skipping.setSharedBackend(true);
+        skipping.setSkipDuplicates(true);
+        QAccelerometer all;
+        all.setIdentifier("QAccelerometer");
+        all.setSharedBackend(true);
+        QVERIFY(skipping.start());
+        QVERIFY(all.start());
+        QVERIFY(skipping.isFeatureSupported(QSensor::SkipDuplicates));
+        QSensor *hostSensor = qobject_cast<QSharedSensorBackend *>(all.backend())->hostSensor();
+
+        // The hidden sensor delivers every reading, each sensor skips by its own setting
+        QVERIFY(!hostSensor->skipDuplicates());
+        QSignalSpy skippingSpy(&skipping, SIGNAL(readingChanged()));
+        QSignalSpy allSpy(&all, SIGNAL(readingChanged()));
+        set_test_backend_reading(hostSensor, {{"timestamp", 2}, {"x", 1.0}});
+        QCOMPARE(skippingSpy.count(), 0);
+        QCOMPARE(allSpy.count(), 1);
+        set_test_backend_reading(hostSensor, {{"timestamp", 3}, {"x", 2.0}});
+        QCOMPARE(skippingSpy.count(), 1);
+        QCOMPARE(allSpy.count(), 2);
+        set_test_backend_reading(hostSensor, {{"timestamp", 4}, {"x", 2.0}});
+        QCOMPARE(skippingSpy.count(), 1);
+        QCOMPARE(allSpy.count(), 3);
+    }
+
+    void testSharedBackendAccelerationMode()
+    {
+        register_test_backends();
+        auto guard = qScopeGuard([] { unregister_test_backends(); });
+        QAccelerometer combined;
+        combined.setIdentifier("QAccelerometer");
+        combined.setSharedBackend(true);
+        QAccelerometer user;
+        user.setIdentifier("QAccelerometer");
+        user.setSharedBackend(true);
+        QVERIFY(combined.start());
+        QVERIFY(user.start());
+        auto *hostSensor = qobject_cast<QAccelerometer *>(
+                qobject_cast<QSharedSensorBackend *>(user.backend())->hostSensor());
+        QVERIFY(hostSensor);
+
+        // The mode of a running sensor changes without a new backend, and
+        // the hidden sensor keeps reporting the combined acceleration
+        user.setAccelerationMode(QAccelerometer::User);
+        QVERIFY(user.isFeatureSupported(QSensor::AccelerationMode));
+        QCOMPARE(qobject_cast<QSharedSensorBackend *>(user.backend())->hostSensor(), hostSensor);
+        QCOMPARE(hostSensor->accelerationMode(), QAccelerometer::Combined);
+
+        // The gravity estimate starts at the first reading
+        set_test_backend_reading(hostSensor, {{"timestamp", 10000}, {"z", 9.8}});
+        QCOMPARE(combined.reading()->z(), 9.8);
+        QCOMPARE(user.reading()->z(), 0.0);
+        set_test_backend_reading(hostSensor, {{"timestamp", 20000}, {"z", 11.0}});
+        QCOMPARE(combined.reading()->z(), 11.0);
+        QVERIFY(user.reading()->z() > 1.0 && user.reading()->z() < 1.2);
+
+        // A sensor that starts in another mode shares the backend too
+        QAccelerometer gravity;
+        gravity.setIdentifier("QAccelerometer");
+        gravity.setSharedBackend(true);
+        gravity.setAccelerationMode(QAccelerometer::Gravity);
+        QVERIFY(gravity.start());
+        QCOMPARE(qobject_cast<QSharedSensorBackend *>(gravity.backend())->hostSensor(), hostSensor);
+        set_test_backend_reading(hostSensor, {{"timestamp", 30000}, {"z", 11.0}});
+        QCOMPARE(combined.reading()->z(), 11.0);
+        QCOMPARE(gravity.reading()->z(), 11.0);
+        set_test_backend_reading(hostSensor, {{"timestamp", 40000}, {"z", 12.0}});
+        QVERIFY(gravity.reading()->z() > 11.0 && gravity.reading()->z() < 11.1);
+    }
+
     void testStart2()
     {
         TestSensor sensor;
@@ -698,6 +1388,50 @@ private slots:
         QSensorManager::unregisterBackend("random", "random.2");
     }
 
+    void testDeclaredPlugin()
+    {
+        // The manager remembers the plugins it initialized
+        static DeclaredTestPlugin plugin;
+        TestSensor watcher;
+        qt_sensors_declare_plugin(&plugin, {
+            { QAccelerometer::sensorType, "declared.accelerometer" },
+            { QGyroscope::sensorType, "declared.gyroscope" }
+        });
+        QVERIFY(watcher.sensorsChangedEmitted > 0);
+
+        // Stand-ins answer for the plugin until one of its backends is created
+        QVERIFY(QSensor::sensorsForType(QAccelerometer::sensorType).contains("declared.accelerometer"));
+        QVERIFY(QSensor::sensorsForType(QGyroscope::sensorType).contains("declared.gyroscope"));
+        QVERIFY(QSensorManager::isBackendRegistered(QGyroscope::sensorType, "declared.gyroscope"));
+        QCOMPARE(plugin.loads, 0);
+
+        QAccelerometer accelerometer;
+        accelerometer.setIdentifier("declared.accelerometer");
+        watcher.sensorsChangedEmitted = 0;
+        QVERIFY(accelerometer.connectToBackend());
+        QCOMPARE(plugin.loads, 1);
+        QCOMPARE(plugin.created, 1);
+        QVERIFY(accelerometer.start());
+        QCOMPARE(accelerometer.reading()->x(), 1.0);
+
+        // The backend the plugin declared but did not register is dropped
+        QVERIFY(watcher.sensorsChangedEmitted > 0);
+        QVERIFY(!QSensorManager::isBackendRegistered(QGyroscope::sensorType, "declared.gyroscope"));
+        QGyroscope gyroscope;
+        gyroscope.setIdentifier("declared.gyroscope");
+        QVERIFY(!gyroscope.connectToBackend());
+
+        // The plugin's own factory replaced the stand-in, it is loaded once
+        QAccelerometer second;
+        second.setIdentifier("declared.accelerometer");
+        QVERIFY(second.connectToBackend());
+        QCOMPARE(plugin.loads, 1);
+        QCOMPARE(plugin.created, 2);
+
+        accelerometer.stop();
+        QSensorManager::unregisterBackend(QAccelerometer::sensorType, "declared.accelerometer");
+    }
+
     void testSensorsChangedSignal()
     {
         TestSensor sensor;
@@ -877,6 +1611,663 @@ private slots:
         sensor.stop();
     }
 
+    void testReadingLayout()
+    {
+        QAccelerometerReading reading;
+        reading.setTimestamp(42);
+        reading.setX(1.5);
+        reading.setY(-2.0);
+        reading.setZ(9.81);
+        const QSensorReadingLayout *layout = QSensorReadingLayout::forReading(&reading);
+        QVERIFY(layout);
+        QCOMPARE(layout->fieldCount(), reading.valueCount());
+        QCOMPARE(layout->indexOf("z"), 2);
+        QCOMPARE(layout->indexOf("w"), -1);
+
+        // Samples are plain data and can be stored back to back
+        QList<quint64> storage(2 * layout->sampleSize() / sizeof(quint64));
+        char *first = reinterpret_cast<char *>(storage.data());
+        char *second = first + layout->sampleSize();
+        layout->read(&reading, first);
+        reading.setTimestamp(43);
+        reading.setX(0);
+        layout->read(&reading, second);
+        QCOMPARE(QSensorReadingLayout::timestamp(first), quint64(42));
+        QCOMPARE(QSensorReadingLayout::timestamp(second), quint64(43));
+        QCOMPARE(layout->value(first, 0), 1.5);
+        for (int i = 0; i < layout->fieldCount(); ++i)
+            QCOMPARE(layout->value(second, i), reading.value(i).toReal());
+
+        QAccelerometerReading copy;
+        layout->write(&copy, first);
+        QCOMPARE(copy.timestamp(), quint64(42));
+        QCOMPARE(copy.x(), 1.5);
+        QCOMPARE(copy.y(), -2.0);
+        QCOMPARE(copy.z(), 9.81);
+
+        // Every reading type of the module is described in property order
+        const QList<const QMetaObject *> readingTypes = {
+            &QAccelerometerReading::staticMetaObject, &QAmbientLightReading::staticMetaObject,
+            &QAmbientTemperatureReading::staticMetaObject, &QCompassReading::staticMetaObject,
+            &QGyroscopeReading::staticMetaObject, &QHumidityReading::staticMetaObject,
+            &QIRProximityReading::staticMetaObject, &QLidReading::staticMetaObject,
+            &QLightReading::staticMetaObject, &QMagnetometerReading::staticMetaObject,
+            &QOrientationReading::staticMetaObject, &QPressureReading::staticMetaObject,
+            &QProximityReading::staticMetaObject, &QRotationReading::staticMetaObject,
+            &QTapReading::staticMetaObject, &QTiltReading::staticMetaObject
+        };
+        for (const QMetaObject *metaObject : readingTypes) {
+            layout = QSensorReadingLayout::forMetaObject(metaObject);
+            QVERIFY2(layout, metaObject->className());
+            QCOMPARE(layout->fieldCount(), metaObject->propertyCount() - metaObject->propertyOffset());
+            for (int i = 0; i < layout->fieldCount(); ++i)
+                QCOMPARE(layout->field(i).name, metaObject->property(metaObject->propertyOffset() + i).name());
+        }
+    }
+
+    void testRegisterReadingLayout()
+    {
+        const QSensorReadingLayout *builtin =
+                QSensorReadingLayout::forMetaObject(&QAccelerometerReading::staticMetaObject);
+        QVERIFY(builtin);
+        QVERIFY(!QSensorReadingLayout::forMetaObject(&TestSensorReading::staticMetaObject));
+
+        QSensorReadingLayout *registered =
+                QSensorReadingLayout::create<TestSensorReading, TestSensorReadingPrivate>({
+                    QSensorReadingLayout::field("test", &TestSensorReadingPrivate::test)
+                });
+        QVERIFY(QSensorReadingLayout::registerLayout(registered));
+        QCOMPARE(QSensorReadingLayout::forMetaObject(&TestSensorReading::staticMetaObject), registered);
+        QCOMPARE(QSensorReadingLayout::forClassName("TestSensorReading"), registered);
+
+        // Layouts handed out stay valid, a type cannot be registered again
+        QTest::ignoreMessage(QtWarningMsg, QRegularExpression("is registered already"));
+        QVERIFY(!QSensorReadingLayout::registerLayout(
+                QSensorReadingLayout::create<TestSensorReading, TestSensorReadingPrivate>({})));
+        QCOMPARE(QSensorReadingLayout::forMetaObject(&TestSensorReading::staticMetaObject), registered);
+        QCOMPARE(registered->fieldCount(), 1);
+
+        QTest::ignoreMessage(QtWarningMsg, QRegularExpression("is registered already"));
+        QVERIFY(!QSensorReadingLayout::registerLayout(
+                new QSensorReadingLayout(&QAccelerometerReading::staticMetaObject,
+                                         int(sizeof(quint64)), {}, nullptr, nullptr)));
+        QCOMPARE(QSensorReadingLayout::forMetaObject(&QAccelerometerReading::staticMetaObject), builtin);
+    }
+
+    void testSensorRecorder()
+    {
+        QBuffer buffer;
+        buffer.open(QIODevice::WriteOnly);
+        {
+            // A small chunk size spreads the records over several chunks
+            QSensorRecorder recorder(&buffer, 256);
+            QVERIFY(recorder.isValid());
+            const int accel = recorder.addStream(&QAccelerometerReading::staticMetaObject, "accel");
+            const int tap = recorder.addStream(&QTapReading::staticMetaObject);
+            QCOMPARE(accel, 0);
+            QCOMPARE(tap, 1);
+            QAccelerometerReading accelReading;
+            QTapReading tapReading;
+            for (int i = 0; i < 100; ++i) {
+                accelReading.setTimestamp(1000 + 10 * i);
+                accelReading.setX(i * 0.5);
+                accelReading.setZ(-9.81);
+                recorder.record(accel, &accelReading);
+                if (i % 10 == 0) {
+                    tapReading.setTimestamp(1005 + 10 * i);
+                    tapReading.setTapDirection(QTapReading::Z_Both);
+                    tapReading.setDoubleTap(true);
+                    recorder.record(tap, &tapReading);
+                }
+            }
+        }
+        const QByteArray recording = buffer.data();
+
+        QSensorRecordingReader reader(recording);
+        QVERIFY(reader.isValid());
+        QCOMPARE(reader.streams().size(), qsizetype(2));
+        QCOMPARE(reader.streams().at(0).readingType, QByteArray("QAccelerometerReading"));
+        QCOMPARE(reader.streams().at(0).identifier, QByteArray("accel"));
+        int accelCount = 0;
+        int tapCount = 0;
+        QAccelerometerReading accelReading;
+        QTapReading tapReading;
+        while (reader.next()) {
+            if (reader.stream() == 0) {
+                QVERIFY(reader.readReading(&accelReading));
+                QCOMPARE(accelReading.timestamp(), quint64(1000 + 10 * accelCount));
+                QCOMPARE(accelReading.x(), accelCount * 0.5);
+                QCOMPARE(accelReading.z(), -9.81);
+                ++accelCount;
+            } else {
+                QVERIFY(reader.readReading(&tapReading));
+                QCOMPARE(tapReading.timestamp(), quint64(1005 + 100 * tapCount));
+                QCOMPARE(tapReading.tapDirection(), QTapReading::Z_Both);
+                QVERIFY(tapReading.isDoubleTap());
+                ++tapCount;
+            }
+        }
+        QCOMPARE(accelCount, 100);
+        QCOMPARE(tapCount, 10);
+
+        // A truncated recording is readable up to its last complete chunk
+        QSensorRecordingReader truncated(recording.left(recording.size() - 1));
+        QVERIFY(truncated.isValid());
+        int truncatedCount = 0;
+        while (truncated.next())
+            ++truncatedCount;
+        QVERIFY(truncatedCount > 0);
+        QVERIFY(truncatedCount < 110);
+
+        // Round trip through the sensorclerk text format
+        QBuffer text;
+        text.open(QIODevice::WriteOnly);
+        QVERIFY(QSensorRecorder::toText(recording, &text));
+        QVERIFY(text.data().startsWith("accelerometer: 1000,0,0,-9.81\n"));
+        QVERIFY(text.data().contains("tap: 1005,1\n"));
+        text.close();
+        text.open(QIODevice::ReadOnly);
+        QBuffer converted;
+        converted.open(QIODevice::WriteOnly);
+        QVERIFY(QSensorRecorder::fromText(&text, &converted));
+        QSensorRecordingReader convertedReader(converted.data());
+        QVERIFY(convertedReader.next());
+        QVERIFY(convertedReader.readReading(&accelReading));
+        QCOMPARE(accelReading.timestamp(), quint64(1000));
+        QCOMPARE(accelReading.z(), -9.81);
+    }
+
+    void testSensorSynchronizer()
+    {
+        register_test_backends();
+        QAccelerometer accelerometer;
+        accelerometer.setIdentifier("QAccelerometer");
+        QGyroscope gyroscope;
+        gyroscope.setIdentifier("QGyroscope");
+        QSensorSynchronizer synchronizer;
+        QCOMPARE(synchronizer.addSensor(&accelerometer), 0);
+        QCOMPARE(synchronizer.addSensor(&gyroscope), 1);
+        synchronizer.setPeriod(10000);
+        synchronizer.setMaxLatency(20000);
+        QVERIFY(accelerometer.start());
+        QVERIFY(gyroscope.start());
+        synchronizer.reset();
+
+        QList<quint64> frames;
+        QList<qreal> accelX;
+        QList<qreal> gyroX;
+        connect(&synchronizer, &QSensorSynchronizer::frameAvailable, this,
+                [&](quint64 timestamp) {
+            frames << timestamp;
+            accelX << static_cast<QAccelerometerReading *>(synchronizer.frameReading(0))->x();
+            gyroX << static_cast<QGyroscopeReading *>(synchronizer.frameReading(1))->x();
+            QCOMPARE(synchronizer.frameReading(0)->timestamp(), timestamp);
+        });
+
+        // Frames wait for readings of both sensors after their time
+        set_test_backend_reading(&accelerometer, {{"timestamp", 1000}, {"x", 0.0}});
+        set_test_backend_reading(&gyroscope, {{"timestamp", 5000}, {"x", 100.0}});
+        set_test_backend_reading(&gyroscope, {{"timestamp", 15000}, {"x", 200.0}});
+        QVERIFY(frames.isEmpty());
+        set_test_backend_reading(&accelerometer, {{"timestamp", 21000}, {"x", 20.0}});
+        QCOMPARE(frames, QList<quint64>() << 10000);
+        set_test_backend_reading(&gyroscope, {{"timestamp", 25000}, {"x", 300.0}});
+        QCOMPARE(frames, QList<quint64>() << 10000 << 20000);
+        QCOMPARE(accelX, QList<qreal>() << 9.0 << 19.0);
+        QCOMPARE(gyroX, QList<qreal>() << 150.0 << 250.0);
+
+        // A stalled sensor holds its last value once the latency is exceeded
+        set_test_backend_reading(&accelerometer, {{"timestamp", 41000}, {"x", 40.0}});
+        QCOMPARE(frames.size(), 2);
+        set_test_backend_reading(&accelerometer, {{"timestamp", 51000}, {"x", 50.0}});
+        QCOMPARE(frames.size(), 3);
+        QCOMPARE(frames.last(), quint64(30000));
+        QCOMPARE(accelX.last(), 29.0);
+        QCOMPARE(gyroX.last(), 300.0);
+
+        // Nearest neighbour instead of linear interpolation
+        synchronizer.reset();
+        synchronizer.setInterpolation(QSensorSynchronizer::Nearest);
+        set_test_backend_reading(&accelerometer, {{"timestamp", 60000}, {"x", 1.0}});
+        set_test_backend_reading(&gyroscope, {{"timestamp", 60000}, {"x", 2.0}});
+        QCOMPARE(frames.last(), quint64(60000));
+        set_test_backend_reading(&accelerometer, {{"timestamp", 66000}, {"x", 3.0}});
+        set_test_backend_reading(&gyroscope, {{"timestamp", 73000}, {"x", 4.0}});
+        QCOMPARE(frames.last(), quint64(60000));
+        set_test_backend_reading(&accelerometer, {{"timestamp", 74000}, {"x", 5.0}});
+        QCOMPARE(frames.last(), quint64(70000));
+        QCOMPARE(accelX.last(), 3.0);
+        QCOMPARE(gyroX.last(), 4.0);
+
+        accelerometer.stop();
+        gyroscope.stop();
+        unregister_test_backends();
+    }
+
+    void testSensorSynchronizerOverflow()
+    {
+        register_test_backends();
+        QAccelerometer accelerometer;
+        accelerometer.setIdentifier("QAccelerometer");
+        QGyroscope gyroscope;
+        gyroscope.setIdentifier("QGyroscope");
+        QSensorSynchronizer synchronizer;
+        // Too small a ring for the latency the gyroscope is allowed
+        QCOMPARE(synchronizer.addSensor(&accelerometer, 4), 0);
+        QCOMPARE(synchronizer.addSensor(&gyroscope), 1);
+        synchronizer.setPeriod(10000);
+        synchronizer.setMaxLatency(100000);
+        QVERIFY(accelerometer.start());
+        QVERIFY(gyroscope.start());
+        synchronizer.reset();
+
+        QList<quint64> frames;
+        QList<qreal> accelX;
+        QList<qreal> gyroX;
+        connect(&synchronizer, &QSensorSynchronizer::frameAvailable, this,
+                [&](quint64 timestamp) {
+            frames << timestamp;
+            accelX << static_cast<QAccelerometerReading *>(synchronizer.frameReading(0))->x();
+            gyroX << static_cast<QGyroscopeReading *>(synchronizer.frameReading(1))->x();
+        });
+
+        set_test_backend_reading(&accelerometer, {{"timestamp", 0}, {"x", 0.0}});
+        set_test_backend_reading(&gyroscope, {{"timestamp", 0}, {"x", 100.0}});
+        QCOMPARE(frames, QList<quint64>() << 0);
+        set_test_backend_reading(&accelerometer, {{"timestamp", 5000}, {"x", 5.0}});
+        set_test_backend_reading(&accelerometer, {{"timestamp", 15000}, {"x", 15.0}});
+        set_test_backend_reading(&accelerometer, {{"timestamp", 16000}, {"x", 16.0}});
+        // The reading at 0 is not needed for the frame at 10000
+        set_test_backend_reading(&accelerometer, {{"timestamp", 17000}, {"x", 17.0}});
+        QCOMPARE(frames.size(), 1);
+
+        // The frame the oldest reading is needed for is built before it
+        // would be overwritten, long before the latency is exceeded
+        QTest::ignoreMessage(QtWarningMsg, QRegularExpression("overflow its capacity of 4"));
+        set_test_backend_reading(&accelerometer, {{"timestamp", 18000}, {"x", 18.0}});
+        QCOMPARE(frames, QList<quint64>() << 0 << 10000);
+        QCOMPARE(accelX.last(), 10.0);
+        QCOMPARE(gyroX.last(), 100.0);
+
+        // Readings no frame needs any more make room silently
+        for (int t = 19000; t <= 23000; t += 1000)
+            set_test_backend_reading(&accelerometer, {{"timestamp", t}, {"x", t / 1000.0}});
+        QCOMPARE(frames.size(), 2);
+        set_test_backend_reading(&gyroscope, {{"timestamp", 20000}, {"x", 200.0}});
+        QCOMPARE(frames, QList<quint64>() << 0 << 10000 << 20000);
+        QCOMPARE(accelX.last(), 20.0);
+        QCOMPARE(gyroX.last(), 200.0);
+
+        accelerometer.stop();
+        gyroscope.stop();
+        unregister_test_backends();
+    }
+
+    void testRegistryCache()
+    {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+        const QString pluginDir = dir.path() + "/sensors";
+        QVERIFY(QDir().mkpath(pluginDir));
+        const QString pluginFile = pluginDir + "/libmyplugin.so";
+        QFile plugin(pluginFile);
+        QVERIFY(plugin.open(QIODevice::WriteOnly));
+        plugin.write("plugin");
+        plugin.close();
+        const QStringList directories{ pluginDir };
+
+        QSensorRegistryCache cache(dir.path() + "/cache/registry.cbor");
+        QSensorPluginRecord record;
+        record.fileName = pluginFile;
+        record.modified = QSensorRegistryCache::modificationTime(pluginFile);
+        record.size = 6;
+        record.backends.append(qMakePair(QByteArray("QAccelerometer"), QByteArray("my.accelerometer")));
+        cache.plugins.append(record);
+        QVERIFY(cache.write(directories));
+
+        QSensorRegistryCache reader(cache.fileName());
+        QVERIFY(reader.read(directories));
+        QCOMPARE(reader.plugins.size(), qsizetype(1));
+        QCOMPARE(reader.plugins.at(0).fileName, pluginFile);
+        QCOMPARE(reader.plugins.at(0).backends, record.backends);
+
+        // Each set of plugin directories has a cache of its own
+        QVERIFY(!reader.read(QStringList{ dir.path() }));
+        QVERIFY(QSensorRegistryCache::defaultFileName(directories)
+                != QSensorRegistryCache::defaultFileName(QStringList{ dir.path() }));
+
+        // A changed plugin invalidates the cache
+        QVERIFY(plugin.open(QIODevice::Append));
+        plugin.write("2");
+        plugin.close();
+        QVERIFY(!reader.read(directories));
+        QVERIFY(reader.plugins.isEmpty());
+    }
+
+    void testAccelerationModeEmulation()
+    {
+        register_test_backends();
+        QAccelerometer accelerometer;
+        accelerometer.setIdentifier("QAccelerometer");
+        QVERIFY(!accelerometer.isFeatureSupported(QSensor::AccelerationMode));
+        QVERIFY(accelerometer.connectToBackend());
+        QVERIFY(accelerometer.isFeatureSupported(QSensor::AccelerationMode));
+
+        // The test backend delivers x = y = z = 1 when started, the gravity
+        // estimate starts there
+        accelerometer.setAccelerationMode(QAccelerometer::User);
+        QVERIFY(accelerometer.start());
+        QCOMPARE(accelerometer.reading()->z(), 0.0);
+
+        // A sudden push along z is user acceleration at first and fades into
+        // gravity while it lasts
+        int timestamp = 1;
+        qreal first = 0;
+        for (int i = 0; i < 1000; ++i) {
+            timestamp += 10000;
+            set_test_backend_reading(&accelerometer, {{"timestamp", timestamp}, {"z", 11.0}});
+            if (i == 0)
+                first = accelerometer.reading()->z();
+        }
+        QVERIFY(first > 9.0 && first < 10.0);
+        QVERIFY(qAbs(accelerometer.reading()->z()) < 0.01);
+        QCOMPARE(accelerometer.reading()->x(), 0.0);
+
+        // Gravity mode reports the estimate
+        accelerometer.setAccelerationMode(QAccelerometer::Gravity);
+        timestamp += 10000;
+        set_test_backend_reading(&accelerometer, {{"timestamp", timestamp}, {"z", 11.0}});
+        QVERIFY(qAbs(accelerometer.reading()->z() - 11.0) < 0.01);
+        QCOMPARE(accelerometer.reading()->x(), 1.0);
+
+        // Combined mode passes the readings through
+        accelerometer.setAccelerationMode(QAccelerometer::Combined);
+        set_test_backend_reading(&accelerometer, {{"z", 5.0}});
+        QCOMPARE(accelerometer.reading()->z(), 5.0);
+        accelerometer.stop();
+        unregister_test_backends();
+    }
+
+    void testAccelerationModeEmulationStops()
+    {
+        register_test_backends();
+        QAccelerometer accelerometer;
+        accelerometer.setIdentifier("QAccelerometer");
+        accelerometer.setAccelerationMode(QAccelerometer::Gravity);
+
+        // The hidden gyroscope runs while the accelerometer does
+        QVERIFY(accelerometer.start());
+        QGyroscope *gyroscope = accelerometer.findChild<QGyroscope *>();
+        QVERIFY(gyroscope);
+        QVERIFY(gyroscope->isActive());
+
+        // and stops when the backend reports busy
+        set_test_backend_busy(&accelerometer, true);
+        QVERIFY(!accelerometer.isActive());
+        QVERIFY(!gyroscope->isActive());
+        set_test_backend_busy(&accelerometer, false);
+        QVERIFY(accelerometer.start());
+        QVERIFY(gyroscope->isActive());
+        accelerometer.stop();
+        QVERIFY(!gyroscope->isActive());
+
+        // A backend that fails to start never starts it
+        FailingAccelerometerFactory factory;
+        QSensorManager::registerBackend(QAccelerometer::sensorType, "failing.accelerometer", &factory);
+        QAccelerometer failing;
+        failing.setIdentifier("failing.accelerometer");
+        failing.setAccelerationMode(QAccelerometer::Gravity);
+        QVERIFY(!failing.start());
+        QVERIFY(!failing.isActive());
+        gyroscope = failing.findChild<QGyroscope *>();
+        QVERIFY(!gyroscope || !gyroscope->isActive());
+        QSensorManager::unregisterBackend(QAccelerometer::sensorType, "failing.accelerometer");
+        unregister_test_backends();
+    }
+
+    void testSkipDuplicatesInCore()
+    {
+        register_test_backends();
+        QAccelerometer accelerometer;
+        accelerometer.setIdentifier("QAccelerometer");
+        QVERIFY(accelerometer.connectToBackend());
+        QVERIFY(accelerometer.isFeatureSupported(QSensor::SkipDuplicates));
+        QCOMPARE(accelerometer.skipDuplicatesThreshold(), 0.0);
+
+        // Without output ranges only equal readings are duplicates
+        accelerometer.setSkipDuplicates(true);
+        QVERIFY(accelerometer.start());
+        QSignalSpy spy(&accelerometer, SIGNAL(readingChanged()));
+        set_test_backend_reading(&accelerometer, {{"timestamp", 2}, {"x", 1.0}});
+        QCOMPARE(spy.size(), 0);
+        QCOMPARE(accelerometer.reading()->timestamp(), quint64(1));
+        set_test_backend_reading(&accelerometer, {{"timestamp", 3}, {"x", 1.05}});
+        QCOMPARE(spy.size(), 1);
+        QCOMPARE(accelerometer.reading()->x(), 1.05);
+        accelerometer.stop();
+
+        // Differences below the threshold are skipped
+        QSignalSpy thresholdSpy(&accelerometer, SIGNAL(skipDuplicatesThresholdChanged(qreal)));
+        accelerometer.setSkipDuplicatesThreshold(0.1);
+        QCOMPARE(thresholdSpy.size(), 1);
+        QVERIFY(accelerometer.start());
+        spy.clear();
+        set_test_backend_reading(&accelerometer, {{"timestamp", 4}, {"x", 1.05}});
+        QCOMPARE(spy.size(), 0);
+        set_test_backend_reading(&accelerometer, {{"timestamp", 5}, {"x", 1.2}});
+        QCOMPARE(spy.size(), 1);
+        QCOMPARE(accelerometer.reading()->x(), 1.2);
+        accelerometer.stop();
+
+        // Every reading is delivered with skipping disabled
+        accelerometer.setSkipDuplicates(false);
+        QVERIFY(accelerometer.start());
+        spy.clear();
+        set_test_backend_reading(&accelerometer, {{"timestamp", 6}, {"x", 1.0}});
+        QCOMPARE(spy.size(), 1);
+        accelerometer.stop();
+        unregister_test_backends();
+    }
+
+    void testSkipDuplicatesPerField()
+    {
+        register_test_backends();
+        QCompass compass;
+        compass.setIdentifier("QCompass");
+        compass.setSkipDuplicates(true);
+        // An accuracy of 1 degree
+        compass.setSkipDuplicatesThreshold(1.0);
+        QVERIFY(compass.start());
+        QSignalSpy spy(&compass, SIGNAL(readingChanged()));
+
+        // The azimuth wraps around, 0.2 is close to 359.5
+        set_test_backend_reading(&compass, {{"azimuth", 359.5}});
+        QCOMPARE(spy.size(), 1);
+        set_test_backend_reading(&compass, {{"azimuth", 0.2}});
+        QCOMPARE(spy.size(), 1);
+
+        // The calibration level is not in degrees, every change counts
+        set_test_backend_reading(&compass, {{"calibrationLevel", 0.3}});
+        QCOMPARE(spy.size(), 2);
+        set_test_backend_reading(&compass, {{"calibrationLevel", 0.9}});
+        QCOMPARE(spy.size(), 3);
+        QCOMPARE(compass.reading()->calibrationLevel(), 0.9);
+        set_test_backend_reading(&compass, {{"calibrationLevel", 0.9}});
+        QCOMPARE(spy.size(), 3);
+        compass.stop();
+        unregister_test_backends();
+    }
+
+    void testLatestSnapshot()
+    {
+        register_test_backends();
+        QAccelerometer accelerometer;
+        accelerometer.setIdentifier("QAccelerometer");
+        QAccelerometerReading snapshot;
+
+        // Nothing was published before the sensor started, the first reading
+        // is available without asking for snapshots beforehand
+        QVERIFY(!accelerometer.latestSnapshot(&snapshot));
+        QVERIFY(accelerometer.start());
+        QVERIFY(accelerometer.latestSnapshot(&snapshot));
+        QCOMPARE(snapshot.timestamp(), quint64(1));
+        QCOMPARE(snapshot.x(), 1.0);
+        set_test_backend_reading(&accelerometer, {{"timestamp", 2}, {"x", 2.0}});
+        QVERIFY(accelerometer.latestSnapshot(&snapshot));
+        QCOMPARE(snapshot.x(), 2.0);
+        accelerometer.stop();
+
+        QVERIFY(accelerometer.start());
+        QVERIFY(accelerometer.latestSnapshot(&snapshot));
+        QCOMPARE(snapshot.timestamp(), quint64(1));
+        QCOMPARE(snapshot.x(), 1.0);
+        QGyroscopeReading wrongType;
+        QVERIFY(!accelerometer.latestSnapshot(&wrongType));
+
+        // Another thread never sees a partially written reading
+        std::atomic<bool> done(false);
+        std::atomic<int> torn(0);
+        QThread *poller = QThread::create([&] {
+            QAccelerometerReading latest;
+            while (!done.load()) {
+                if (accelerometer.latestSnapshot(&latest)
+                        && (latest.x() != latest.y() || qreal(latest.timestamp()) != latest.x())) {
+                    ++torn;
+                }
+            }
+        });
+        poller->start();
+        for (int i = 2; i < 20000; ++i)
+            set_test_backend_reading(&accelerometer, {{"timestamp", i}, {"x", qreal(i)}, {"y", qreal(i)}});
+        done.store(true);
+        poller->wait();
+        delete poller;
+        QCOMPARE(torn.load(), 0);
+        QVERIFY(accelerometer.latestSnapshot(&snapshot));
+        QCOMPARE(snapshot.x(), 19999.0);
+        accelerometer.stop();
+        unregister_test_backends();
+    }
+
+    void testTimestampTranslator()
+    {
+        // A backend clock 5 s ahead that runs 100 ppm fast, readings every
+        // millisecond arriving 100 to 600 microseconds late
+        QSensorTimestampTranslator translator;
+        qint64 maxError = 0;
+        for (qint64 i = 0; i < 20000; ++i) {
+            const qint64 time = 1000000 + i * 1000;
+            const quint64 timestamp = quint64(5000000000 + time + time / 10000);
+            const quint64 arrival = quint64(time + 100 + (i * 37) % 500);
+            const quint64 translated = translator.translate(timestamp, arrival);
+            QVERIFY(translated <= arrival);
+            if (i >= 5000)
+                maxError = qMax(maxError, qAbs(qint64(translated) - time));
+        }
+        QVERIFY(maxError < 200);
+        QVERIFY(qAbs(translator.drift() + 0.0001) < 0.00001);
+
+        // A jump of the backend clock starts over
+        const quint64 translated = translator.translate(100, 30000000);
+        QCOMPARE(translated, quint64(30000000));
+    }
+
+    void testStatistics()
+    {
+        class RejectNegative : public QAccelerometerFilter
+        {
+            bool filter(QAccelerometerReading *reading) override { return reading->x() >= 0; }
+        };
+
+        register_test_backends();
+        QAccelerometer accelerometer;
+        accelerometer.setIdentifier("QAccelerometer");
+        accelerometer.setSkipDuplicates(true);
+        RejectNegative filter;
+        accelerometer.addFilter(&filter);
+        QVERIFY(accelerometer.start());
+        set_test_backend_reading(&accelerometer, {{"x", 1.0}});  // duplicate
+        set_test_backend_reading(&accelerometer, {{"x", -1.0}}); // filtered
+        set_test_backend_reading(&accelerometer, {{"x", 2.0}});
+        accelerometer.stop();
+
+        // Readings are always counted, intervals and times only while
+        // statisticsTiming is set
+        QVERIFY(!accelerometer.statisticsTiming());
+        QSensorStatistics statistics = accelerometer.statistics();
+        QCOMPARE(statistics.readingsReceived, quint64(4));
+        QCOMPARE(statistics.readingsSkipped, quint64(1));
+        QCOMPARE(statistics.readingsFiltered, quint64(1));
+        QCOMPARE(statistics.readingsDelivered, quint64(2));
+        QCOMPARE(statistics.readingsDropped, quint64(0));
+        const auto countIntervals = [](const QSensorStatistics &statistics) {
+            quint64 intervals = 0;
+            for (quint64 count : statistics.intervalHistogram)
+                intervals += count;
+            return intervals;
+        };
+        QCOMPARE(countIntervals(statistics), quint64(0));
+        QCOMPARE(statistics.meanInterval, 0.0);
+        QCOMPARE(statistics.filterTime, quint64(0));
+        QCOMPARE(statistics.handlerTime, quint64(0));
+        QCOMPARE(countIntervals(accelerometer.statistics()), quint64(0));
+
+        QSignalSpy timingSpy(&accelerometer, SIGNAL(statisticsTimingChanged(bool)));
+        accelerometer.setStatisticsTiming(true);
+        accelerometer.setStatisticsTiming(true);
+        QCOMPARE(timingSpy.size(), 1);
+        QVERIFY(accelerometer.start());
+        set_test_backend_reading(&accelerometer, {{"x", 3.0}});
+        set_test_backend_reading(&accelerometer, {{"x", 4.0}});
+        accelerometer.stop();
+        statistics = accelerometer.statistics();
+        QCOMPARE(statistics.readingsReceived, quint64(7));
+        QCOMPARE(statistics.readingsDelivered, quint64(5));
+        QCOMPARE(countIntervals(statistics), quint64(2));
+        QVERIFY(statistics.meanInterval >= 0);
+
+        // Stopping is not an interval
+        QVERIFY(accelerometer.start());
+        accelerometer.stop();
+        QCOMPARE(accelerometer.statistics().readingsReceived, quint64(8));
+        QCOMPARE(accelerometer.statistics().readingsDelivered, quint64(6));
+        QCOMPARE(countIntervals(accelerometer.statistics()), quint64(2));
+
+        accelerometer.resetStatistics();
+        statistics = accelerometer.statistics();
+        QCOMPARE(statistics.readingsReceived, quint64(0));
+        QCOMPARE(statistics.readingsDelivered, quint64(0));
+        QCOMPARE(statistics.rate, 0.0);
+        accelerometer.removeFilter(&filter);
+        unregister_test_backends();
+    }
+
+    void testTranslateTimestamps()
+    {
+        register_test_backends();
+        QAccelerometer accelerometer;
+        accelerometer.setIdentifier("QAccelerometer");
+        QSignalSpy spy(&accelerometer, SIGNAL(translateTimestampsChanged(bool)));
+        accelerometer.setTranslateTimestamps(true);
+        QCOMPARE(spy.size(), 1);
+        QVERIFY(accelerometer.translateTimestamps());
+
+        const quint64 before = QSensorTimestampTranslator::now();
+        QVERIFY(accelerometer.start());
+        set_test_backend_reading(&accelerometer, {{"timestamp", 1000}});
+        const quint64 after = QSensorTimestampTranslator::now();
+        QVERIFY(accelerometer.reading()->timestamp() >= before);
+        QVERIFY(accelerometer.reading()->timestamp() <= after);
+        accelerometer.stop();
+
+        accelerometer.setTranslateTimestamps(false);
+        QVERIFY(accelerometer.start());
+        set_test_backend_reading(&accelerometer, {{"timestamp", 1000}});
+        QCOMPARE(accelerometer.reading()->timestamp(), quint64(1000));
+        accelerometer.stop();
+        unregister_test_backends();
+    }
+
     void testBusyChanged()
     {
         // Start an exclusive sensor
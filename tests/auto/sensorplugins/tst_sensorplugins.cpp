@@ -0,0 +1,462 @@
+// Copyright (C) 2022 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+//TESTED_COMPONENT=src/plugins/sensors
+
+#include <QtCore/QObject>
+#include <QTest>
+#include <QtCore/QBuffer>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QPluginLoader>
+#include <QtCore/QScopeGuard>
+#include <QtCore/QTemporaryFile>
+#include <QtCore/qcbormap.h>
+#include <QtSensors/QAccelerometer>
+#include <QtSensors/QCompass>
+#include <QtSensors/QMagnetometer>
+#include <QtSensors/QSensorManager>
+#include <QtSensors/QTapSensor>
+#include <QtSensors/qsensorplugin.h>
+#include <QtSensors/private/qsensorregistrycache_p.h>
+#include <QtCore/qmath.h>
+
+#include "genericaccelerationkernels.h"
+#include "genericcompass.h"
+#include "genericfusionrotationsensor.h"
+#include "replaysensor.h"
+
+#include <cmath>
+
+Q_IMPORT_PLUGIN(replaySensorPlugin)
+
+QT_BEGIN_NAMESPACE
+
+// Creates replay backends of an in-memory recording
+class ReplayFactory : public QSensorBackendFactory
+{
+public:
+    QSensorBackend *createBackend(QSensor *sensor) override
+    {
+        return new ReplaySensor(sensor, recording.constData(), recording.size(), stream,
+                                speed, loop);
+    }
+
+    QByteArray recording;
+    int stream = 0;
+    qreal speed = 1;
+    bool loop = false;
+};
+
+// A backend whose readings the test sets
+template <typename Reading>
+class PushBackend : public QSensorBackend
+{
+public:
+    explicit PushBackend(QSensor *sensor)
+        : QSensorBackend(sensor)
+    {
+        setReading<Reading>(&reading);
+    }
+
+    void start() override {}
+    void stop() override {}
+    void push() { newReadingAvailable(); }
+
+    Reading reading;
+};
+
+// The generic compass, reading an accelerometer and a magnetometer of the test
+class CompassFactory : public QSensorBackendFactory
+{
+public:
+    QSensorBackend *createBackend(QSensor *sensor) override
+    {
+        if (sensor->type() == QAccelerometer::sensorType)
+            return accelerometer = new PushBackend<QAccelerometerReading>(sensor);
+        if (sensor->type() == QMagnetometer::sensorType)
+            return magnetometer = new PushBackend<QMagnetometerReading>(sensor);
+        return new GenericCompass(sensor);
+    }
+
+    PushBackend<QAccelerometerReading> *accelerometer = nullptr;
+    PushBackend<QMagnetometerReading> *magnetometer = nullptr;
+};
+
+// Accelerometer readings with x = 0, 1, 2, ... every interval microseconds,
+// with a tap in between in a second stream
+static QByteArray makeRecording(int count, quint64 interval)
+{
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+    {
+        QSensorRecorder recorder(&buffer);
+        const int accel = recorder.addStream(&QAccelerometerReading::staticMetaObject);
+        const int tap = recorder.addStream(&QTapReading::staticMetaObject);
+        QAccelerometerReading accelReading;
+        QTapReading tapReading;
+        for (int i = 0; i < count; ++i) {
+            accelReading.setTimestamp(1000 + interval * i);
+            accelReading.setX(i);
+            recorder.record(accel, &accelReading);
+            tapReading.setTimestamp(1000 + interval * i + interval / 2);
+            tapReading.setTapDirection(QTapReading::X_Both);
+            recorder.record(tap, &tapReading);
+        }
+    }
+    return buffer.data();
+}
+
+// Equal within tolerance, and zeros with the same sign
+static bool sameAngle(qreal actual, qreal expected, qreal tolerance)
+{
+    if (expected == 0)
+        return actual == 0 && std::signbit(actual) == std::signbit(expected);
+    return qAbs(actual - expected) <= tolerance;
+}
+
+#define COMPARE_ANGLE(actual, expected, tolerance, i) \
+    QVERIFY2(sameAngle(actual, expected, tolerance), \
+             qPrintable(QStringLiteral("%1 is %2, expected %3 for (%4, %5, %6)") \
+                        .arg(QLatin1String(#actual)).arg(actual, 0, 'g', 17) \
+                        .arg(expected, 0, 'g', 17).arg(x[i]).arg(y[i]).arg(z[i])))
+
+class tst_SensorPlugins : public QObject
+{
+    Q_OBJECT
+
+public:
+    tst_SensorPlugins()
+    {
+        qputenv("QT_SENSORS_LOAD_PLUGINS", "0"); // Only the backends of the test
+    }
+
+private:
+    // Starts the replay and collects the x values and timestamps delivered
+    void replay(QAccelerometer *sensor)
+    {
+        m_values.clear();
+        m_timestamps.clear();
+        m_batches.clear();
+        QSensorManager::registerBackend(QAccelerometer::sensorType, "replay.test", &m_replay);
+        sensor->setIdentifier("replay.test");
+        connect(sensor, &QSensor::readingsAvailable, this,
+                [this](const QList<QSensorReading *> &readings) {
+            m_batches << int(readings.size());
+            for (QSensorReading *reading : readings) {
+                m_values << static_cast<QAccelerometerReading *>(reading)->x();
+                m_timestamps << reading->timestamp();
+            }
+        });
+        QVERIFY(sensor->start());
+    }
+
+    ReplayFactory m_replay;
+    QList<qreal> m_values;
+    QList<quint64> m_timestamps;
+    QList<int> m_batches;
+
+private slots:
+    void cleanup()
+    {
+        if (QSensorManager::isBackendRegistered(QAccelerometer::sensorType, "replay.test"))
+            QSensorManager::unregisterBackend(QAccelerometer::sensorType, "replay.test");
+    }
+
+    void testAccelerationKernels()
+    {
+        // Every combination of signed zeros, axis aligned and face down
+        // readings; an odd count leaves a reading for the scalar code
+        const qreal values[] = { 0.0, -0.0, 1, -1, 9.81, -9.81, 0.3, -4.2, 1e-3 };
+        QList<qreal> x, y, z;
+        for (qreal vx : values) {
+            for (qreal vy : values) {
+                for (qreal vz : values) {
+                    x << vx;
+                    y << vy;
+                    z << vz;
+                }
+            }
+        }
+        const qsizetype count = x.size();
+        QCOMPARE(count % 2, 1);
+        QList<qreal> pitch(count), roll(count), scalarPitch(count), scalarRoll(count);
+
+        // The tilt sensor, in radians
+        genericTiltAngles(x.constData(), y.constData(), z.constData(), count,
+                          pitch.data(), roll.data());
+        genericTiltAnglesScalar(x.constData(), y.constData(), z.constData(), count,
+                                scalarPitch.data(), scalarRoll.data());
+        for (qsizetype i = 0; i < count; ++i) {
+            COMPARE_ANGLE(pitch[i], scalarPitch[i], 1e-12, i);
+            COMPARE_ANGLE(roll[i], scalarRoll[i], 1e-12, i);
+            COMPARE_ANGLE(pitch[i], qAtan2(-x[i], qSqrt(y[i] * y[i] + z[i] * z[i])), 1e-9, i);
+            COMPARE_ANGLE(roll[i], qAtan2(y[i], z[i]), 1e-9, i);
+        }
+
+        // The rotation sensor, in degrees
+        genericRotationAngles(x.constData(), y.constData(), z.constData(), count,
+                              pitch.data(), roll.data());
+        genericRotationAnglesScalar(x.constData(), y.constData(), z.constData(), count,
+                                    scalarPitch.data(), scalarRoll.data());
+        for (qsizetype i = 0; i < count; ++i) {
+            const qreal expectedPitch =
+                    qRadiansToDegrees(qAtan2(y[i], qSqrt(x[i] * x[i] + z[i] * z[i])));
+            qreal expectedRoll = -qRadiansToDegrees(qAtan2(x[i], qSqrt(y[i] * y[i] + z[i] * z[i])));
+            if (z[i] < 0 && x[i] * x[i] + y[i] * y[i] > 0)
+                expectedRoll = (expectedRoll > 0 ? 180.0 : -180.0) - expectedRoll;
+            COMPARE_ANGLE(pitch[i], scalarPitch[i], 1e-10, i);
+            COMPARE_ANGLE(roll[i], scalarRoll[i], 1e-10, i);
+            COMPARE_ANGLE(pitch[i], expectedPitch, 1e-7, i);
+            COMPARE_ANGLE(roll[i], expectedRoll, 1e-7, i);
+        }
+    }
+
+    void testFusionFilter()
+    {
+        const qreal g = 9.81;
+        qreal x, y, z;
+
+        // Flat with the top pointing to magnetic north, which points down
+        // in the northern hemisphere
+        GenericFusionFilter filter;
+        const qreal flat[3] = { 0, 0, g };
+        const qreal north[3] = { 0, 20, -40 };
+        filter.reset(flat, north);
+        filter.eulerAngles(&x, &y, &z);
+        QVERIFY(qAbs(x) < 1e-9);
+        QVERIFY(qAbs(y) < 1e-9);
+        QVERIFY(qAbs(z) < 1e-9);
+        // It stays there as long as nothing moves
+        const qreal still[3] = { 0, 0, 0 };
+        for (int i = 0; i < 100; ++i)
+            filter.update(still, flat, north, 0.01);
+        filter.eulerAngles(&x, &y, &z);
+        QVERIFY(qAbs(x) < 1e-6);
+        QVERIFY(qAbs(y) < 1e-6);
+        QVERIFY(qAbs(z) < 1e-6);
+
+        // With the top to the east, it is turned clockwise
+        const qreal east[3] = { -20, 0, -40 };
+        filter.reset(flat, east);
+        filter.eulerAngles(&x, &y, &z);
+        QVERIFY(qAbs(z + 90) < 1e-9);
+
+        // Gravity as QRotationReading describes it for x = 20 and y = -35
+        const qreal tiltX = qDegreesToRadians(qreal(20));
+        const qreal tiltY = qDegreesToRadians(qreal(-35));
+        const qreal tilted[3] = { -qCos(tiltX) * qSin(tiltY) * g, qSin(tiltX) * g,
+                                  qCos(tiltX) * qCos(tiltY) * g };
+        filter.reset(tilted, nullptr);
+        filter.eulerAngles(&x, &y, &z);
+        QVERIFY(qAbs(x - 20) < 1e-9);
+        QVERIFY(qAbs(y + 35) < 1e-9);
+        for (int i = 0; i < 100; ++i)
+            filter.update(still, tilted, nullptr, 0.01);
+        filter.eulerAngles(&x, &y, &z);
+        QVERIFY(qAbs(x - 20) < 1e-3);
+        QVERIFY(qAbs(y + 35) < 1e-3);
+
+        // Turning counter-clockwise at a constant rate adds up in z. Without
+        // a magnetic field the top of the device is taken as north at first.
+        filter.reset(flat, nullptr);
+        const qreal turn[3] = { 0, 0, 0.5 };
+        for (int i = 0; i < 100; ++i)
+            filter.update(turn, flat, nullptr, 0.01);
+        filter.eulerAngles(&x, &y, &z);
+        QVERIFY(qAbs(x) < 1e-6);
+        QVERIFY(qAbs(y) < 1e-6);
+        QVERIFY2(qAbs(z - qRadiansToDegrees(qreal(0.5))) < 0.01, qPrintable(QString::number(z)));
+
+        // z is in (-180, 180] although the filter's yaw is 90 degrees off it
+        const qreal turnMore[3] = { 0, 0, qDegreesToRadians(qreal(200)) - qreal(0.5) };
+        for (int i = 0; i < 100; ++i)
+            filter.update(turnMore, flat, nullptr, 0.01);
+        filter.eulerAngles(&x, &y, &z);
+        QVERIFY2(qAbs(z + 160) < 0.05, qPrintable(QString::number(z)));
+    }
+
+    void testGenericCompass_data()
+    {
+        QTest::addColumn<qreal>("heading");
+        QTest::addColumn<qreal>("pitch");
+        QTest::addColumn<qreal>("roll");
+
+        QTest::newRow("flat") << qreal(30) << qreal(0) << qreal(0);
+        QTest::newRow("top up") << qreal(30) << qreal(40) << qreal(0);
+        QTest::newRow("rolled") << qreal(30) << qreal(0) << qreal(-50);
+        QTest::newRow("pitched and rolled") << qreal(250) << qreal(25) << qreal(35);
+        QTest::newRow("north") << qreal(0) << qreal(60) << qreal(20);
+        QTest::newRow("face down") << qreal(120) << qreal(-30) << qreal(170);
+        QTest::newRow("top straight up") << qreal(75) << qreal(90) << qreal(0);
+        QTest::newRow("steep") << qreal(200) << qreal(-60) << qreal(-80);
+    }
+
+    void testGenericCompass()
+    {
+        QFETCH(qreal, heading);
+        QFETCH(qreal, pitch);
+        QFETCH(qreal, roll);
+
+        CompassFactory factory;
+        QSensorManager::registerBackend(QAccelerometer::sensorType, "compass.accelerometer", &factory);
+        QSensorManager::registerBackend(QMagnetometer::sensorType, "compass.magnetometer", &factory);
+        QSensorManager::registerBackend(QCompass::sensorType, GenericCompass::id, &factory);
+        auto guard = qScopeGuard([] {
+            QSensorManager::unregisterBackend(QAccelerometer::sensorType, "compass.accelerometer");
+            QSensorManager::unregisterBackend(QMagnetometer::sensorType, "compass.magnetometer");
+            QSensorManager::unregisterBackend(QCompass::sensorType, GenericCompass::id);
+        });
+
+        QCompass compass;
+        compass.setIdentifier(GenericCompass::id);
+        QVERIFY(compass.start());
+        QVERIFY(factory.accelerometer);
+        QVERIFY(factory.magnetometer);
+
+        // Gravity and a magnetic field pointing north and down, as the device
+        // measures them: turned clockwise by the heading, then rotated about
+        // its X axis by the pitch and about its Y axis by the roll
+        const auto toDevice = [&](qreal v[3]) {
+            const qreal h = qDegreesToRadians(heading);
+            const qreal p = -qDegreesToRadians(pitch);
+            const qreal r = -qDegreesToRadians(roll);
+            qreal x = qCos(h) * v[0] - qSin(h) * v[1];
+            qreal y = qSin(h) * v[0] + qCos(h) * v[1];
+            qreal z = v[2];
+            const qreal y2 = qCos(p) * y - qSin(p) * z;
+            z = qSin(p) * y + qCos(p) * z;
+            y = y2;
+            v[0] = qCos(r) * x + qSin(r) * z;
+            v[1] = y;
+            v[2] = -qSin(r) * x + qCos(r) * z;
+        };
+        qreal up[3] = { 0, 0, 9.81 };
+        qreal field[3] = { 0, 20, -40 };
+        toDevice(up);
+        toDevice(field);
+
+        factory.accelerometer->reading.setX(up[0]);
+        factory.accelerometer->reading.setY(up[1]);
+        factory.accelerometer->reading.setZ(up[2]);
+        factory.accelerometer->push();
+        factory.magnetometer->reading.setTimestamp(42);
+        factory.magnetometer->reading.setX(field[0]);
+        factory.magnetometer->reading.setY(field[1]);
+        factory.magnetometer->reading.setZ(field[2]);
+        factory.magnetometer->reading.setCalibrationLevel(0.5);
+        factory.magnetometer->push();
+
+        QCOMPARE(compass.reading()->timestamp(), quint64(42));
+        QCOMPARE(compass.reading()->calibrationLevel(), 0.5);
+        const qreal azimuth = compass.reading()->azimuth();
+        QVERIFY2(azimuth >= 0 && azimuth < 360, qPrintable(QString::number(azimuth)));
+        const qreal error = std::fmod(azimuth - heading + 540, qreal(360)) - 180;
+        QVERIFY2(qAbs(error) < 1e-6, qPrintable(QString::number(azimuth)));
+        compass.stop();
+    }
+
+    void testReplayInRealTime()
+    {
+        // Five readings over 8 ms
+        m_replay.recording = makeRecording(5, 2000);
+        m_replay.speed = 1;
+        m_replay.loop = false;
+
+        QAccelerometer sensor;
+        QElapsedTimer elapsed;
+        elapsed.start();
+        replay(&sensor);
+        QTRY_COMPARE(m_values.size(), 5);
+        QVERIFY(elapsed.nsecsElapsed() >= 8000000);
+        QCOMPARE(m_values, QList<qreal>({ 0, 1, 2, 3, 4 }));
+        QCOMPARE(m_timestamps, QList<quint64>({ 1000, 3000, 5000, 7000, 9000 }));
+        QCOMPARE(sensor.reading()->x(), 4.0);
+
+        // Nothing follows the end of the recording
+        QTest::qWait(10);
+        QCOMPARE(m_values.size(), 5);
+    }
+
+    void testReplayBurst()
+    {
+        // As fast as possible, in blocks of 256 readings per event loop pass
+        m_replay.recording = makeRecording(600, 1000000);
+        m_replay.speed = 0;
+        m_replay.loop = false;
+
+        QAccelerometer sensor;
+        replay(&sensor);
+        QTRY_COMPARE(m_values.size(), 600);
+        QCOMPARE(m_batches, QList<int>({ 256, 256, 88 }));
+        for (int i = 0; i < m_values.size(); ++i) {
+            QCOMPARE(m_values.at(i), qreal(i));
+            QCOMPARE(m_timestamps.at(i), quint64(1000 + 1000000 * quint64(i)));
+        }
+    }
+
+    void testReplayLoop()
+    {
+        m_replay.recording = makeRecording(3, 1000);
+        m_replay.speed = 0;
+        m_replay.loop = true;
+
+        QAccelerometer sensor;
+        replay(&sensor);
+        QTRY_VERIFY(m_values.size() >= 10);
+        sensor.stop();
+        for (int i = 0; i < m_values.size(); ++i) {
+            QCOMPARE(m_values.at(i), qreal(i % 3));
+            QCOMPARE(m_timestamps.at(i), quint64(1000 + 1000 * (i % 3)));
+        }
+
+        // Starting again starts at the beginning of the recording
+        const qsizetype count = m_values.size();
+        QVERIFY(sensor.start());
+        QTRY_VERIFY(m_values.size() > count);
+        QCOMPARE(m_values.at(count), 0.0);
+    }
+
+    void testReplayPluginRegistration()
+    {
+        const QList<QStaticPlugin> staticPlugins = QPluginLoader::staticPlugins();
+        const QStaticPlugin *replayPlugin = nullptr;
+        for (const QStaticPlugin &plugin : staticPlugins) {
+            if (plugin.metaData().value("className").toString() == "replaySensorPlugin")
+                replayPlugin = &plugin;
+        }
+        QVERIFY(replayPlugin);
+
+        // The plugin declares no backends, so the registry cache records
+        // none for it and loads it in every run
+        const QCborMap metaData = QCborMap::fromJsonObject(
+                replayPlugin->metaData().value("MetaData").toObject());
+        QVERIFY(QSensorRegistryCache::declaredBackends(metaData).isEmpty());
+
+        // What it registers depends on the environment of the run. It was
+        // loaded at startup without a recording.
+        QVERIFY(!QSensorManager::isBackendRegistered(QAccelerometer::sensorType, "replay.0"));
+        QTemporaryFile recording;
+        QVERIFY(recording.open());
+        recording.write(makeRecording(3, 1000));
+        recording.flush();
+        qputenv("QT_SENSORS_REPLAY_FILE", QFile::encodeName(recording.fileName()));
+        auto guard = qScopeGuard([] {
+            qunsetenv("QT_SENSORS_REPLAY_FILE");
+            if (QSensorManager::isBackendRegistered(QAccelerometer::sensorType, "replay.0"))
+                QSensorManager::unregisterBackend(QAccelerometer::sensorType, "replay.0");
+            if (QSensorManager::isBackendRegistered(QTapSensor::sensorType, "replay.1"))
+                QSensorManager::unregisterBackend(QTapSensor::sensorType, "replay.1");
+        });
+        auto *plugin = qobject_cast<QSensorPluginInterface *>(replayPlugin->instance());
+        QVERIFY(plugin);
+        plugin->registerSensors();
+        QVERIFY(QSensorManager::isBackendRegistered(QAccelerometer::sensorType, "replay.0"));
+        QVERIFY(QSensorManager::isBackendRegistered(QTapSensor::sensorType, "replay.1"));
+    }
+};
+
+QT_END_NAMESPACE
+
+QTEST_MAIN(tst_SensorPlugins)
+
+#include "tst_sensorplugins.moc"
@@ -0,0 +1,88 @@
+// Copyright (C) 2022 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include "bench_backend.h"
+#include <qsensormanager.h>
+#include <QtCore/qmath.h>
+
+char const * const BenchAccelerometerBackend::id("bench.accelerometer");
+
+namespace {
+
+struct Sample
+{
+    qreal x;
+    qreal y;
+    qreal z;
+};
+
+// Precomputed so that generating a reading costs no more than a real backend
+struct SampleTable
+{
+    SampleTable()
+    {
+        for (int i = 0; i < BenchAccelerometerBackend::SampleCount; ++i) {
+            const qreal pitch = qSin(2 * M_PI * i / BenchAccelerometerBackend::SampleCount);
+            const qreal roll = qCos(4 * M_PI * i / BenchAccelerometerBackend::SampleCount) / 2;
+            samples[i].x = 9.80665 * qSin(roll);
+            samples[i].y = 9.80665 * qSin(pitch) * qCos(roll);
+            samples[i].z = 9.80665 * qCos(pitch) * qCos(roll);
+        }
+    }
+    Sample samples[BenchAccelerometerBackend::SampleCount];
+};
+
+Q_GLOBAL_STATIC(SampleTable, sampleTable)
+
+class BenchBackendFactory : public QSensorBackendFactory
+{
+public:
+    QSensorBackend *createBackend(QSensor *sensor) override
+    {
+        return new BenchAccelerometerBackend(sensor);
+    }
+};
+
+BenchBackendFactory benchFactory;
+
+} // namespace
+
+BenchAccelerometerBackend::BenchAccelerometerBackend(QSensor *sensor)
+    : QSensorBackend(sensor)
+    , m_index(0)
+    , m_timestamp(0)
+{
+    setReading<QAccelerometerReading>(&m_reading);
+    addDataRate(1, 10000);
+}
+
+void BenchAccelerometerBackend::generate(int count)
+{
+    for (int i = 0; i < count; ++i) {
+        sample(m_index, &m_reading);
+        m_index = (m_index + 1) % SampleCount;
+        m_timestamp += 1000; // 1 kHz
+        m_reading.setTimestamp(m_timestamp);
+        newReadingAvailable();
+    }
+}
+
+void BenchAccelerometerBackend::sample(int index, QAccelerometerReading *reading)
+{
+    const Sample &s = sampleTable()->samples[index % SampleCount];
+    reading->setX(s.x);
+    reading->setY(s.y);
+    reading->setZ(s.z);
+}
+
+void register_bench_backends()
+{
+    QSensorManager::registerBackend(QAccelerometer::sensorType,
+                                    BenchAccelerometerBackend::id, &benchFactory);
+    QSensorManager::setDefaultBackend(QAccelerometer::sensorType, BenchAccelerometerBackend::id);
+}
+
+void unregister_bench_backends()
+{
+    QSensorManager::unregisterBackend(QAccelerometer::sensorType, BenchAccelerometerBackend::id);
+}
@@ -0,0 +1,40 @@
+// Copyright (C) 2022 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#ifndef BENCH_BACKEND_H
+#define BENCH_BACKEND_H
+
+#include <qsensorbackend.h>
+#include <qaccelerometer.h>
+
+// Synthetic accelerometer that publishes readings on demand, as fast as the
+// pipeline accepts them. The values trace a slow tilt of the device so that
+// transforms working on them see realistic input.
+class BenchAccelerometerBackend : public QSensorBackend
+{
+public:
+    static char const * const id;
+    enum { SampleCount = 1024 };
+
+    explicit BenchAccelerometerBackend(QSensor *sensor);
+
+    void start() override {}
+    void stop() override {}
+
+    // Publishes count readings through newReadingAvailable()
+    void generate(int count);
+
+    // Sets the values of the synthetic sample at index, wrapping around SampleCount
+    static void sample(int index, QAccelerometerReading *reading);
+
+private:
+    QAccelerometerReading m_reading;
+    int m_index;
+    quint64 m_timestamp;
+};
+
+// Registers the backend and makes it the default accelerometer
+void register_bench_backends();
+void unregister_bench_backends();
+
+#endif
@@ -0,0 +1,73 @@
+// Copyright (C) 2022 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include <QtTest/QtTest>
+#include <QtCore/qproperty.h>
+#include <QtSensorsQuick/private/qmlaccelerometer_p.h>
+
+#include "bench_backend.h"
+
+QT_USE_NAMESPACE
+
+// Readings pushed per iteration, see tst_bench_qsensor
+static const int ReadingsPerIteration = 1000;
+
+class tst_bench_qmlsensor : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void updateReading_data();
+    void updateReading();
+};
+
+void tst_bench_qmlsensor::initTestCase()
+{
+    qputenv("QT_SENSORS_LOAD_PLUGINS", "0"); // Do not load plugins
+    register_bench_backends();
+}
+
+void tst_bench_qmlsensor::cleanupTestCase()
+{
+    unregister_bench_backends();
+}
+
+void tst_bench_qmlsensor::updateReading_data()
+{
+    QTest::addColumn<bool>("bound");
+
+    QTest::newRow("unobserved") << false;
+    QTest::newRow("x bound") << true;
+}
+
+// Cost of propagating a reading from the backend to the QML reading's
+// bindable properties, which is what a QML binding on a reading pays.
+void tst_bench_qmlsensor::updateReading()
+{
+    QFETCH(bool, bound);
+
+    QmlAccelerometer sensor;
+    sensor.setIdentifier(BenchAccelerometerBackend::id);
+    sensor.componentComplete();
+    QVERIFY(sensor.start());
+
+    auto *reading = static_cast<QmlAccelerometerReading *>(sensor.reading());
+    QVERIFY(reading);
+    QProperty<qreal> observer;
+    if (bound)
+        observer.setBinding([reading]() { return reading->x(); });
+
+    auto *backend = static_cast<BenchAccelerometerBackend *>(sensor.sensor()->backend());
+    QBENCHMARK {
+        backend->generate(ReadingsPerIteration);
+    }
+
+    sensor.stop();
+}
+
+QTEST_MAIN(tst_bench_qmlsensor)
+
+#include "tst_bench_qmlsensor.moc"
@@ -0,0 +1,308 @@
+// Copyright (C) 2022 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include <QtTest/QtTest>
+#include <QtSensors/qaccelerometer.h>
+#include <QtSensors/qrotationsensor.h>
+#include <QtSensors/qtiltsensor.h>
+#include <QtSensors/qsensormanager.h>
+#include <QtSensors/private/qaccelerometer_p.h>
+#include <QtSensors/private/qsensorreadinglayout_p.h>
+
+#include "bench_backend.h"
+#include "genericaccelerationkernels.h"
+#include "generictiltsensor.h"
+#ifdef QTSENSORS_GENERICROTATIONSENSOR
+#include "genericrotationsensor.h"
+#endif
+
+QT_USE_NAMESPACE
+
+// Every benchmark pushes this many readings per iteration so that the
+// reported cost divided by it is the cost of one reading.
+static const int ReadingsPerIteration = 1000;
+
+class PassFilter : public QAccelerometerFilter
+{
+public:
+    bool filter(QAccelerometerReading *reading) override
+    {
+        sum += reading->x();
+        return true;
+    }
+    qreal sum = 0;
+};
+
+class RejectFilter : public QAccelerometerFilter
+{
+public:
+    bool filter(QAccelerometerReading *) override { return false; }
+};
+
+template <typename Backend>
+class BenchBackendFactory : public QSensorBackendFactory
+{
+public:
+    QSensorBackend *createBackend(QSensor *sensor) override { return new Backend(sensor); }
+};
+
+class tst_bench_qsensor : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void newReadingAvailable_data();
+    void newReadingAvailable();
+
+    void readingValue_data();
+    void readingValue();
+
+    void genericTiltFilter();
+#ifdef QTSENSORS_GENERICROTATIONSENSOR
+    void genericRotationFilter();
+#endif
+
+    void accelerationKernels_data();
+    void accelerationKernels();
+
+private:
+    BenchBackendFactory<GenericTiltSensor> tiltFactory;
+#ifdef QTSENSORS_GENERICROTATIONSENSOR
+    BenchBackendFactory<genericrotationsensor> rotationFactory;
+#endif
+};
+
+void tst_bench_qsensor::initTestCase()
+{
+    qputenv("QT_SENSORS_LOAD_PLUGINS", "0"); // Do not load plugins
+    register_bench_backends();
+    QSensorManager::registerBackend(QTiltSensor::sensorType, GenericTiltSensor::id, &tiltFactory);
+#ifdef QTSENSORS_GENERICROTATIONSENSOR
+    QSensorManager::registerBackend(QRotationSensor::sensorType, genericrotationsensor::id,
+                                    &rotationFactory);
+#endif
+}
+
+void tst_bench_qsensor::cleanupTestCase()
+{
+#ifdef QTSENSORS_GENERICROTATIONSENSOR
+    QSensorManager::unregisterBackend(QRotationSensor::sensorType, genericrotationsensor::id);
+#endif
+    QSensorManager::unregisterBackend(QTiltSensor::sensorType, GenericTiltSensor::id);
+    unregister_bench_backends();
+}
+
+void tst_bench_qsensor::newReadingAvailable_data()
+{
+    QTest::addColumn<int>("passFilters");
+    QTest::addColumn<bool>("rejectFilter");
+    QTest::addColumn<bool>("connected");
+    QTest::addColumn<int>("bufferSize");
+
+    QTest::newRow("no filters") << 0 << false << false << 1;
+    QTest::newRow("no filters, connected") << 0 << false << true << 1;
+    QTest::newRow("1 filter") << 1 << false << false << 1;
+    QTest::newRow("8 filters") << 8 << false << false << 1;
+    QTest::newRow("rejecting filter") << 0 << true << false << 1;
+    QTest::newRow("no filters, batched") << 0 << false << true << 32;
+    QTest::newRow("1 filter, batched") << 1 << false << true << 32;
+}
+
+void tst_bench_qsensor::newReadingAvailable()
+{
+    QFETCH(int, passFilters);
+    QFETCH(bool, rejectFilter);
+    QFETCH(bool, connected);
+    QFETCH(int, bufferSize);
+
+    QAccelerometer sensor;
+    sensor.setIdentifier(BenchAccelerometerBackend::id);
+    sensor.setBufferSize(bufferSize);
+    QVERIFY(sensor.connectToBackend());
+
+    QList<PassFilter *> filters;
+    for (int i = 0; i < passFilters; ++i) {
+        filters.append(new PassFilter);
+        sensor.addFilter(filters.last());
+    }
+    RejectFilter reject;
+    if (rejectFilter)
+        sensor.addFilter(&reject);
+
+    qreal sum = 0;
+    if (connected) {
+        connect(&sensor, &QSensor::readingChanged, this,
+                [&sensor, &sum]() { sum += sensor.reading()->x(); });
+    }
+
+    QVERIFY(sensor.start());
+    auto *backend = static_cast<BenchAccelerometerBackend *>(sensor.backend());
+
+    QBENCHMARK {
+        backend->generate(ReadingsPerIteration);
+    }
+
+    sensor.stop();
+    qDeleteAll(filters);
+}
+
+enum ValueAccess {
+    TypedAccess,
+    PropertyAccess,
+    LayoutAccess
+};
+
+void tst_bench_qsensor::readingValue_data()
+{
+    QTest::addColumn<int>("access");
+
+    QTest::newRow("typed getters") << int(TypedAccess);
+    QTest::newRow("QSensorReading::value()") << int(PropertyAccess);
+    QTest::newRow("QSensorReadingLayout") << int(LayoutAccess);
+}
+
+void tst_bench_qsensor::readingValue()
+{
+    QFETCH(int, access);
+
+    QAccelerometerReading reading;
+    BenchAccelerometerBackend::sample(42, &reading);
+    const QSensorReadingLayout *layout = QSensorReadingLayout::forReading(&reading);
+    QVERIFY(layout);
+    QSensorReadingSample<QAccelerometerReadingPrivate> sample;
+
+    qreal sum = 0;
+    switch (access) {
+    case TypedAccess:
+        QBENCHMARK {
+            for (int i = 0; i < ReadingsPerIteration; ++i)
+                sum += reading.x() + reading.y() + reading.z();
+        }
+        break;
+    case PropertyAccess:
+        QBENCHMARK {
+            for (int i = 0; i < ReadingsPerIteration; ++i) {
+                for (int j = 0; j < reading.valueCount(); ++j)
+                    sum += reading.value(j).toReal();
+            }
+        }
+        break;
+    case LayoutAccess:
+        QBENCHMARK {
+            for (int i = 0; i < ReadingsPerIteration; ++i) {
+                layout->read(&reading, &sample);
+                for (int j = 0; j < layout->fieldCount(); ++j)
+                    sum += layout->value(&sample, j);
+            }
+        }
+        break;
+    }
+    QVERIFY(sum != 0);
+}
+
+void tst_bench_qsensor::genericTiltFilter()
+{
+    QTiltSensor sensor;
+    sensor.setIdentifier(GenericTiltSensor::id);
+    QVERIFY(sensor.start());
+    auto *backend = static_cast<GenericTiltSensor *>(sensor.backend());
+
+    QAccelerometerReading readings[BenchAccelerometerBackend::SampleCount];
+    for (int i = 0; i < BenchAccelerometerBackend::SampleCount; ++i)
+        BenchAccelerometerBackend::sample(i, &readings[i]);
+
+    QBENCHMARK {
+        for (int i = 0; i < ReadingsPerIteration; ++i)
+            backend->filter(&readings[i % BenchAccelerometerBackend::SampleCount]);
+    }
+
+    sensor.stop();
+}
+
+#ifdef QTSENSORS_GENERICROTATIONSENSOR
+void tst_bench_qsensor::genericRotationFilter()
+{
+    QRotationSensor sensor;
+    sensor.setIdentifier(genericrotationsensor::id);
+    QVERIFY(sensor.start());
+    auto *backend = static_cast<genericrotationsensor *>(sensor.backend());
+
+    QAccelerometerReading readings[BenchAccelerometerBackend::SampleCount];
+    for (int i = 0; i < BenchAccelerometerBackend::SampleCount; ++i)
+        BenchAccelerometerBackend::sample(i, &readings[i]);
+
+    QBENCHMARK {
+        for (int i = 0; i < ReadingsPerIteration; ++i)
+            backend->filter(&readings[i % BenchAccelerometerBackend::SampleCount]);
+    }
+
+    sensor.stop();
+}
+#endif
+
+enum Kernel { RotationScalar, Rotation, TiltScalar, Tilt, Orientation };
+
+void tst_bench_qsensor::accelerationKernels_data()
+{
+    QTest::addColumn<int>("kernel");
+    QTest::newRow("rotation scalar") << int(RotationScalar);
+    QTest::newRow("rotation") << int(Rotation);
+    QTest::newRow("tilt scalar") << int(TiltScalar);
+    QTest::newRow("tilt") << int(Tilt);
+    QTest::newRow("orientation") << int(Orientation);
+}
+
+// The kernels the generic backends use for batches, one block of
+// SampleCount readings per iteration
+void tst_bench_qsensor::accelerationKernels()
+{
+    QFETCH(int, kernel);
+
+    const int count = BenchAccelerometerBackend::SampleCount;
+    QList<qreal> x(count), y(count), z(count), pitch(count), roll(count);
+    QList<QOrientationReading::Orientation> orientations(count);
+    QAccelerometerReading reading;
+    for (int i = 0; i < count; ++i) {
+        BenchAccelerometerBackend::sample(i, &reading);
+        x[i] = reading.x();
+        y[i] = reading.y();
+        z[i] = reading.z();
+    }
+
+    qint64 samples = 0;
+    QElapsedTimer timer;
+    timer.start();
+    QBENCHMARK {
+        switch (kernel) {
+        case RotationScalar:
+            genericRotationAnglesScalar(x.constData(), y.constData(), z.constData(), count,
+                                        pitch.data(), roll.data());
+            break;
+        case Rotation:
+            genericRotationAngles(x.constData(), y.constData(), z.constData(), count,
+                                  pitch.data(), roll.data());
+            break;
+        case TiltScalar:
+            genericTiltAnglesScalar(x.constData(), y.constData(), z.constData(), count,
+                                    pitch.data(), roll.data());
+            break;
+        case Tilt:
+            genericTiltAngles(x.constData(), y.constData(), z.constData(), count,
+                              pitch.data(), roll.data());
+            break;
+        case Orientation:
+            genericOrientations(x.constData(), y.constData(), z.constData(), count,
+                                orientations.data());
+            break;
+        }
+        samples += count;
+    }
+    qInfo("%.0f samples/second", samples * 1e9 / qMax<qint64>(timer.nsecsElapsed(), 1));
+}
+
+QTEST_MAIN(tst_bench_qsensor)
+
+#include "tst_bench_qsensor.moc"
@@ -5,8 +5,8 @@
 #include <QtCore/QFile>
 #include <QFileInfo>
 
-#include <QTextStream>
 #include <QtSensors>
+#include <QtSensors/private/qsensorrecorder_p.h>
 #include <QDir>
 #include <QtSensors/QAccelerometer>
 #include <QtSensors/QIRProximitySensor>
@@ -23,102 +23,55 @@ Collector::Collector(QObject *parent)
       proximity(0),
       irProx(0),
       tapSensor(0),
-      dataFile(QDir::tempPath()+"/sensordump_0.dat")
+      dataFile(QDir::tempPath()+"/sensordump_0.qsr")
     , isActive(0),
       fileCounter(0)
 {
     accel = new QAccelerometer(this);
     accel->connectToBackend();
     accel->setDataRate(100);
-    connect(accel,SIGNAL(readingChanged()),this,SLOT(accelChanged()));
 
     orientation = new QOrientationSensor(this);
     orientation->connectToBackend();
     orientation->setDataRate(100);
-    connect(orientation,SIGNAL(readingChanged()),this,SLOT(orientationChanged()));
 
     proximity = new QProximitySensor(this);
     proximity->connectToBackend();
-    connect(proximity,SIGNAL(readingChanged()),this,SLOT(proximityChanged()));
 
     irProx = new QIRProximitySensor(this);
     irProx->connectToBackend();
     irProx->setDataRate(50);
-    connect(irProx,SIGNAL(readingChanged()),this,SLOT(irProximityChanged()));
 
     tapSensor = new QTapSensor(this);
     tapSensor->connectToBackend();
-    connect(tapSensor,SIGNAL(readingChanged()),this,SLOT(tapChanged()));
 }
 
 Collector::~Collector()
 {
 }
 
-void Collector::accelChanged()
-{
-    const qreal x = accel->reading()->x();
-    const qreal y = accel->reading()->y();
-    const qreal z = accel->reading()->z();
-    const quint64 ts = accel->reading()->timestamp();
-
-    QTextStream out(&dataFile);
-    out << QString("accelerometer: %1,%2,%3,%4").arg(ts).arg(x).arg(y).arg(z) << "\n";
-}
-
-void Collector::orientationChanged()
-{
-    const QOrientationReading *orientationReading = orientation->reading();
-    QOrientationReading::Orientation o = orientationReading->orientation();
-    const quint64 ts = orientationReading->timestamp();
-
-    QTextStream out(&dataFile);
-    out << QString("orientation: %1,%2").arg(ts).arg(o) << "\n";
-}
-
-void Collector::proximityChanged()
-{
-    const QProximityReading *proximityReading = proximity->reading();
-    const quint64 ts = proximityReading->timestamp();
-    const bool prox = proximityReading->close();
-
-    QTextStream out(&dataFile);
-    out << QString("proximity: %1,%2").arg(ts).arg(prox) << "\n";
-}
-
-void Collector::irProximityChanged()
-{
-    const QIRProximityReading *irProximityReading = irProx->reading();
-    const quint64 ts = irProximityReading->timestamp();
-    const qreal ref = irProximityReading->reflectance();
-
-    QTextStream out(&dataFile);
-    out << QString("irProximity: %1,%2").arg(ts).arg(ref) << "\n";
-}
-
-void Collector::tapChanged()
-{
-    const QTapReading *tapReading = tapSensor->reading();
-    const quint64 ts = tapReading->timestamp();
-    const bool dTap = tapReading->isDoubleTap();
-
-    QTextStream out(&dataFile);
-    out << QString("tap: %1,%2").arg(ts).arg(dTap) << "\n";
-}
-
 void Collector::startCollecting()
 {
     if (dataFile.exists()) {
         fileCounter++;
         for (int i = 0; i < fileCounter; i++) {
-            if (!QFileInfo(QString(QDir::tempPath()+"/sensordump_%1.dat").arg(fileCounter)).exists())
-                dataFile.setFileName(QString(QDir::tempPath()+"/sensordump_%1.dat").arg(fileCounter));
+            if (!QFileInfo(QString(QDir::tempPath()+"/sensordump_%1.qsr").arg(fileCounter)).exists())
+                dataFile.setFileName(QString(QDir::tempPath()+"/sensordump_%1.qsr").arg(fileCounter));
             break;
             fileCounter++;
         }
     }
     if (!dataFile.exists()) {
-        if (dataFile.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        if (dataFile.open(QIODevice::WriteOnly)) {
+            // Readings are buffered and written in binary chunks, see
+            // QSensorRecorder::toText() for getting the old text dump
+            recorder.reset(new QSensorRecorder(&dataFile));
+            recorder->attach(accel);
+            recorder->attach(orientation);
+            recorder->attach(proximity);
+            recorder->attach(irProx);
+            recorder->attach(tapSensor);
+
             accel->start();
             orientation->start();
             proximity->start();
@@ -144,6 +97,7 @@ void Collector::stopCollecting()
         tapSensor->stop();
         isActive = !isActive;
     }
+    recorder.reset();
     if (dataFile.isOpen())
         dataFile.close();
 }
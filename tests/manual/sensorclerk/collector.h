@@ -7,12 +7,14 @@
 #include <QtCore/QObject>
 #include <QtCore/QString>
 #include <QFile>
+#include <QScopedPointer>
 
 class QAccelerometer;
 class QOrientationSensor;
 class QProximitySensor;
 class QIRProximitySensor;
 class QTapSensor;
+class QSensorRecorder;
 
 class Collector : public QObject
 {
@@ -26,13 +28,6 @@ public slots:
     void startCollecting();
     void stopCollecting();
 
-private Q_SLOTS:
-    void accelChanged();
-    void orientationChanged();
-    void proximityChanged();
-    void irProximityChanged();
-    void tapChanged();
-
 private:
 
     QAccelerometer *accel;
@@ -41,6 +36,7 @@ private:
     QIRProximitySensor *irProx;
     QTapSensor *tapSensor;
     QFile dataFile;
+    QScopedPointer<QSensorRecorder> recorder;
 
     bool isActive;
     int fileCounter;